@@ -0,0 +1,245 @@
+#include "MicroBench.h"
+
+#include "Slate/Common/FastSTD.h"
+#include "Slate/Common/Handles.h"
+#include "Slate/ResourcePool.h"
+#include "Slate/Resources/IResource.h"
+
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace Slate {
+	// the fast containers keep their storage inline, so the big ones live on the heap
+	static constexpr size_t kMaxElements = kMicroBenchMaxSize;
+
+	struct BenchObject
+	{
+		uint64_t payload[2] = {};
+	};
+	using BenchObjectHandle = ObjectHandle<struct BenchObjectTag>;
+
+	// resources normally load a file, this one only needs the path to exist
+	struct BenchResource : public IResource {
+		uint64_t payload = 0;
+	private:
+		Result _loadResourceImpl(const std::filesystem::path& path) override { return Result::SUCCESS; }
+	};
+	static const std::filesystem::path& BenchResourcePath() {
+		static const std::filesystem::path path = [] {
+			std::filesystem::path temp = std::filesystem::temp_directory_path() / "slate_microbench_resource";
+			std::ofstream(temp) << "slate";
+			return temp;
+		}();
+		return path;
+	}
+
+	// ---- FastVector ----
+	static void BM_FastVector_PushBack(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		auto vector = std::make_unique<FastVector<uint32_t, kMaxElements>>();
+		for (auto _ : state) {
+			vector->clear();
+			for (size_t i = 0; i < count; i++) {
+				vector->push_back((uint32_t)i);
+			}
+			benchmark::DoNotOptimize(vector->data());
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	static void BM_StdVector_PushBack(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		std::vector<uint32_t> vector;
+		vector.reserve(count);
+		for (auto _ : state) {
+			vector.clear();
+			for (size_t i = 0; i < count; i++) {
+				vector.push_back((uint32_t)i);
+			}
+			benchmark::DoNotOptimize(vector.data());
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	static void BM_FastVector_Lookup(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		auto vector = std::make_unique<FastVector<uint32_t, kMaxElements>>();
+		for (size_t i = 0; i < count; i++) {
+			vector->push_back((uint32_t)i);
+		}
+		const std::vector<uint32_t> order = MakeShuffledIndices(count);
+		for (auto _ : state) {
+			uint64_t sum = 0;
+			for (uint32_t index : order) {
+				sum += (*vector)[index];
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// swap with the back, what the engine uses when order does not matter
+	static void BM_FastVector_Remove(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		auto vector = std::make_unique<FastVector<uint32_t, kMaxElements>>();
+		MicroBenchRng rng(kMicroBenchSeed);
+		for (auto _ : state) {
+			state.PauseTiming();
+			vector->clear();
+			for (size_t i = 0; i < count; i++) {
+				vector->push_back((uint32_t)i);
+			}
+			state.ResumeTiming();
+			while (!vector->empty()) {
+				vector->remove(rng() % vector->size());
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// order preserving, shifts everything behind the erased element
+	static void BM_FastVector_EraseFront(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		auto vector = std::make_unique<FastVector<uint32_t, kMaxElements>>();
+		for (auto _ : state) {
+			state.PauseTiming();
+			vector->clear();
+			for (size_t i = 0; i < count; i++) {
+				vector->push_back((uint32_t)i);
+			}
+			state.ResumeTiming();
+			// a fixed number of erases, erasing all of them is quadratic and never finishes at the large sizes
+			for (size_t i = 0; i < kMicroBenchNumErases && !vector->empty(); i++) {
+				vector->erase((size_t)0);
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)std::min(count, kMicroBenchNumErases));
+	}
+
+	// ---- FastQueue ----
+	static void BM_FastQueue_PushPop(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		auto queue = std::make_unique<FastQueue<uint32_t, kMaxElements>>();
+		for (auto _ : state) {
+			for (size_t i = 0; i < count; i++) {
+				queue->push((uint32_t)i);
+			}
+			uint64_t sum = 0;
+			while (!queue->empty()) {
+				sum += queue->front();
+				queue->pop();
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count * 2);
+	}
+	// steady state, a half full ring that wraps around
+	static void BM_FastQueue_Churn(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		auto queue = std::make_unique<FastQueue<uint32_t, kMaxElements>>();
+		for (size_t i = 0; i < count / 2; i++) {
+			queue->push((uint32_t)i);
+		}
+		for (auto _ : state) {
+			for (size_t i = 0; i < count; i++) {
+				queue->pop();
+				queue->push((uint32_t)i);
+			}
+			benchmark::DoNotOptimize(queue->back());
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+
+	// ---- pools ----
+	// create count objects, look all of them up in random order, then destroy them in random order
+	template<typename Pool, typename Create>
+	static void PoolCreate(benchmark::State& state, Create&& create) {
+		const auto count = (size_t)state.range(0);
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto pool = std::make_unique<Pool>();
+			state.ResumeTiming();
+			for (size_t i = 0; i < count; i++) {
+				benchmark::DoNotOptimize(create(*pool));
+			}
+			state.PauseTiming();
+			pool.reset();
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	template<typename Pool, typename Create>
+	static void PoolLookup(benchmark::State& state, Create&& create) {
+		const auto count = (size_t)state.range(0);
+		auto pool = std::make_unique<Pool>();
+		std::vector<decltype(create(*pool))> handles;
+		handles.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			handles.push_back(create(*pool));
+		}
+		std::vector<decltype(create(*pool))> shuffled;
+		shuffled.reserve(count);
+		for (uint32_t index : MakeShuffledIndices(count)) {
+			shuffled.push_back(handles[index]);
+		}
+		for (auto _ : state) {
+			for (const auto& handle : shuffled) {
+				benchmark::DoNotOptimize(pool->get(handle));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// destroy a tenth of the live objects and create them again, the free list gets reused out of order
+	template<typename Pool, typename Create>
+	static void PoolChurn(benchmark::State& state, Create&& create) {
+		const auto count = (size_t)state.range(0);
+		const size_t numChurned = std::max<size_t>(count / 10, 1);
+		auto pool = std::make_unique<Pool>();
+		std::vector<decltype(create(*pool))> handles;
+		handles.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			handles.push_back(create(*pool));
+		}
+		MicroBenchRng rng(kMicroBenchSeed);
+		for (auto _ : state) {
+			for (size_t i = 0; i < numChurned; i++) {
+				const size_t slot = rng() % count;
+				pool->destroy(handles[slot]);
+				handles[slot] = create(*pool);
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)numChurned);
+	}
+
+	using BenchFastHandlePool = FastHandlePool<BenchObject, kMaxElements>;
+	using BenchHandlePool = HandlePool<BenchObjectHandle, BenchObject>;
+	using BenchResourcePool = ResourcePool<BenchResource>;
+	static auto CreateFastHandle(BenchFastHandlePool& pool) { return pool.create(BenchObject{}); }
+	static auto CreateHandle(BenchHandlePool& pool) { return pool.create(BenchObject{}); }
+	// every create checks the file on disk, that is part of what this measures
+	static auto CreateResource(BenchResourcePool& pool) { return pool.create(BenchResourcePath()); }
+
+	static void BM_FastHandlePool_Create(benchmark::State& state) { PoolCreate<BenchFastHandlePool>(state, CreateFastHandle); }
+	static void BM_FastHandlePool_Lookup(benchmark::State& state) { PoolLookup<BenchFastHandlePool>(state, CreateFastHandle); }
+	static void BM_FastHandlePool_Churn(benchmark::State& state) { PoolChurn<BenchFastHandlePool>(state, CreateFastHandle); }
+	static void BM_HandlePool_Create(benchmark::State& state) { PoolCreate<BenchHandlePool>(state, CreateHandle); }
+	static void BM_HandlePool_Lookup(benchmark::State& state) { PoolLookup<BenchHandlePool>(state, CreateHandle); }
+	static void BM_HandlePool_Churn(benchmark::State& state) { PoolChurn<BenchHandlePool>(state, CreateHandle); }
+	static void BM_ResourcePool_Create(benchmark::State& state) { PoolCreate<BenchResourcePool>(state, CreateResource); }
+	static void BM_ResourcePool_Lookup(benchmark::State& state) { PoolLookup<BenchResourcePool>(state, CreateResource); }
+	static void BM_ResourcePool_Churn(benchmark::State& state) { PoolChurn<BenchResourcePool>(state, CreateResource); }
+
+	SLATE_MICROBENCH(BM_FastVector_PushBack);
+	SLATE_MICROBENCH(BM_StdVector_PushBack);
+	SLATE_MICROBENCH(BM_FastVector_Lookup);
+	SLATE_MICROBENCH(BM_FastVector_Remove);
+	SLATE_MICROBENCH(BM_FastVector_EraseFront);
+	SLATE_MICROBENCH(BM_FastQueue_PushPop);
+	SLATE_MICROBENCH(BM_FastQueue_Churn);
+	SLATE_MICROBENCH(BM_FastHandlePool_Create);
+	SLATE_MICROBENCH(BM_FastHandlePool_Lookup);
+	SLATE_MICROBENCH(BM_FastHandlePool_Churn);
+	SLATE_MICROBENCH(BM_HandlePool_Create);
+	SLATE_MICROBENCH(BM_HandlePool_Lookup);
+	SLATE_MICROBENCH(BM_HandlePool_Churn);
+	SLATE_MICROBENCH(BM_ResourcePool_Create);
+	SLATE_MICROBENCH(BM_ResourcePool_Lookup);
+	SLATE_MICROBENCH(BM_ResourcePool_Churn);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace Slate {
+	static constexpr size_t kMicroBenchMinSize = 1000;
+	static constexpr size_t kMicroBenchMaxSize = 1000000;
+	// order preserving erases per iteration, see BM_FastVector_EraseFront
+	static constexpr size_t kMicroBenchNumErases = 1000;
+	static constexpr uint32_t kMicroBenchSeed = 1337;
+	using MicroBenchRng = std::mt19937;
+
+	// the same permutation every run, lookups should not walk memory in insertion order
+	inline std::vector<uint32_t> MakeShuffledIndices(size_t count) {
+		std::vector<uint32_t> indices(count);
+		std::iota(indices.begin(), indices.end(), 0u);
+		std::shuffle(indices.begin(), indices.end(), MicroBenchRng(kMicroBenchSeed));
+		return indices;
+	}
+}
+
+// 1k, 10k, 100k and 1M, filter the big ones out with --benchmark_filter when iterating
+#define SLATE_MICROBENCH(func) \
+	BENCHMARK(func)->RangeMultiplier(10)->Range(kMicroBenchMinSize, kMicroBenchMaxSize)->Unit(benchmark::kMicrosecond)
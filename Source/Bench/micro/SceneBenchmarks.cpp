@@ -0,0 +1,194 @@
+#include "MicroBench.h"
+
+#include "Slate/ECS/Entity.h"
+#include "Slate/ECS/Scene.h"
+#include "Slate/SceneTemplates.h"
+
+#include <memory>
+
+namespace Slate {
+	// children per entity in the benchmark hierarchies, well under MAX_CHILD_COUNT
+	static constexpr uint32_t kHierarchyBranching = 8;
+
+	// every entity gets a transform and every other one a primitive, roughly what a level looks like
+	static std::vector<entt::entity> PopulateScene(Scene& scene, size_t count) {
+		std::vector<entt::entity> handles;
+		handles.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			GameEntity entity = scene.createEntity("Entity");
+			entity.addComponent<TransformComponent>();
+			if (i % 2 == 0) {
+				entity.addComponent<GeometryPrimitiveComponent>().mesh_type = MeshPrimitiveType::Cube;
+			}
+			handles.push_back(entity.getHandle());
+		}
+		return handles;
+	}
+	// entity i is parented to entity (i - 1) / kHierarchyBranching, one tree that is log8(count) deep
+	static void BuildHierarchy(Scene& scene, const std::vector<entt::entity>& handles) {
+		for (size_t i = 1; i < handles.size(); i++) {
+			scene.resolveEntity(handles[(i - 1) / kHierarchyBranching]).addChild(scene.resolveEntity(handles[i]));
+		}
+	}
+	static size_t WalkHierarchy(GameEntity entity) {
+		size_t visited = 1;
+		for (GameEntity child : entity.getChildren()) {
+			visited += WalkHierarchy(child);
+		}
+		return visited;
+	}
+
+	static void BM_Scene_CreateEntity(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto scene = std::make_unique<Scene>();
+			state.ResumeTiming();
+			benchmark::DoNotOptimize(PopulateScene(*scene, count));
+			state.PauseTiming();
+			scene.reset();
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	static void BM_Scene_DestroyEntity(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		const std::vector<uint32_t> order = MakeShuffledIndices(count);
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto scene = std::make_unique<Scene>();
+			const std::vector<entt::entity> handles = PopulateScene(*scene, count);
+			state.ResumeTiming();
+			for (uint32_t index : order) {
+				scene->DestroyEntity(handles[index]);
+			}
+			state.PauseTiming();
+			scene.reset();
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// copies every component and generates a unique name for each copy
+	static void BM_Scene_DuplicateEntity(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		for (auto _ : state) {
+			state.PauseTiming();
+			auto scene = std::make_unique<Scene>();
+			GameEntity source = scene->createEntity("Source");
+			source.addComponent<TransformComponent>();
+			source.addComponent<GeometryPrimitiveComponent>().mesh_type = MeshPrimitiveType::Sphere;
+			source.addComponent<PointLightComponent>();
+			state.ResumeTiming();
+			for (size_t i = 0; i < count; i++) {
+				benchmark::DoNotOptimize(scene->DuplicateEntity(source).getHandle());
+			}
+			state.PauseTiming();
+			scene.reset();
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// a tenth of the entities die and are replaced every iteration, entt recycles their ids
+	static void BM_Scene_EntityChurn(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		const size_t numChurned = std::max<size_t>(count / 10, 1);
+		Scene scene;
+		std::vector<entt::entity> handles = PopulateScene(scene, count);
+		MicroBenchRng rng(kMicroBenchSeed);
+		for (auto _ : state) {
+			for (size_t i = 0; i < numChurned; i++) {
+				const size_t slot = rng() % count;
+				scene.DestroyEntity(handles[slot]);
+				GameEntity entity = scene.createEntity("Entity");
+				entity.addComponent<TransformComponent>();
+				handles[slot] = entity.getHandle();
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)numChurned);
+	}
+	static void BM_Scene_AddRemoveComponent(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		Scene scene;
+		const std::vector<entt::entity> handles = PopulateScene(scene, count);
+		for (auto _ : state) {
+			for (entt::entity handle : handles) {
+				scene.resolveEntity(handle).addComponent<PointLightComponent>();
+			}
+			for (entt::entity handle : handles) {
+				scene.resolveEntity(handle).removeComponent<PointLightComponent>();
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count * 2);
+	}
+	// top down from the roots through getChildren
+	static void BM_Scene_HierarchyWalk(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		Scene scene;
+		BuildHierarchy(scene, PopulateScene(scene, count));
+		for (auto _ : state) {
+			size_t visited = 0;
+			for (GameEntity root : scene.GetRootEntities()) {
+				visited += WalkHierarchy(root);
+			}
+			benchmark::DoNotOptimize(visited);
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// bottom up, every entity finds its root
+	static void BM_Scene_HierarchyGetRoot(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		Scene scene;
+		const std::vector<entt::entity> handles = PopulateScene(scene, count);
+		BuildHierarchy(scene, handles);
+		for (auto _ : state) {
+			for (entt::entity handle : handles) {
+				benchmark::DoNotOptimize(scene.resolveEntity(handle).getRoot().getHandle());
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// what the renderers do every frame, half of the entities match
+	static void BM_Scene_QuerySingle(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		Scene scene;
+		PopulateScene(scene, count);
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(scene.GetAllEntitiesWithEXT<GeometryPrimitiveComponent>());
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// a quarter of the entities have both
+	static void BM_Scene_QueryMultiple(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		Scene scene;
+		const std::vector<entt::entity> handles = PopulateScene(scene, count);
+		for (size_t i = 0; i < handles.size(); i += 2) {
+			if (i % 4 == 0) scene.resolveEntity(handles[i]).addComponent<PointLightComponent>();
+		}
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(scene.GetAllEntitiesWithEXT<GeometryPrimitiveComponent, PointLightComponent>());
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+	// systems update, the render system looks up the root entities every tick
+	static void BM_Scene_Tick(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		Scene scene;
+		PopulateScene(scene, count);
+		for (auto _ : state) {
+			scene.Tick(1.0 / 60.0);
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+	}
+
+	SLATE_MICROBENCH(BM_Scene_CreateEntity);
+	SLATE_MICROBENCH(BM_Scene_DestroyEntity);
+	SLATE_MICROBENCH(BM_Scene_DuplicateEntity);
+	SLATE_MICROBENCH(BM_Scene_EntityChurn);
+	SLATE_MICROBENCH(BM_Scene_AddRemoveComponent);
+	SLATE_MICROBENCH(BM_Scene_HierarchyWalk);
+	SLATE_MICROBENCH(BM_Scene_HierarchyGetRoot);
+	SLATE_MICROBENCH(BM_Scene_QuerySingle);
+	SLATE_MICROBENCH(BM_Scene_QueryMultiple);
+	SLATE_MICROBENCH(BM_Scene_Tick);
+}
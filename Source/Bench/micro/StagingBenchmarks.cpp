@@ -0,0 +1,190 @@
+#include "MicroBench.h"
+
+#include <array>
+#include <deque>
+#include <vector>
+
+namespace Slate {
+	// the bookkeeping of VulkanStagingDevice without vulkan, a fake queue stands in for the submits and their fences
+	// every fence poll is counted, on a real device each one is a driver call and that is most of what the old scan cost
+	static constexpr uint32_t kStagingBufferSize = 4u * 2048u * 2048u; // VulkanStagingDevice::_minBufferSize
+	static constexpr uint32_t kStagingAlignment = 16;
+	static constexpr uint32_t kMinUploadSize = 16;
+	static constexpr uint32_t kMaxUploadSize = 1024;
+	static constexpr uint32_t kFramesInFlight = 2;
+
+	static uint32_t AlignStagingSize(uint32_t size) {
+		return (size + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+	}
+
+	// submits finish kFramesInFlight frames after the one they went out in, 0 is the empty handle
+	class FakeCopyQueue {
+	public:
+		uint64_t submit() { return ++_numSubmitted; }
+		bool isReady(uint64_t handle) {
+			_numReadyChecks++;
+			return handle <= _numCompleted;
+		}
+		void wait(uint64_t handle) {
+			if (handle > _numCompleted) {
+				_numCompleted = handle;
+				_numStalls++;
+			}
+		}
+		void endFrame() {
+			_frameEnds[_frame % kFramesInFlight] = _numSubmitted;
+			_frame++;
+			_numCompleted = std::max(_numCompleted, _frameEnds[_frame % kFramesInFlight]);
+		}
+		inline uint64_t getNumReadyChecks() const { return _numReadyChecks; }
+		inline uint64_t getNumStalls() const { return _numStalls; }
+	private:
+		std::array<uint64_t, kFramesInFlight> _frameEnds = {};
+		uint64_t _frame = 0;
+		uint64_t _numSubmitted = 0;
+		uint64_t _numCompleted = 0;
+		uint64_t _numReadyChecks = 0;
+		uint64_t _numStalls = 0;
+	};
+	struct StagingRegion {
+		uint32_t offset = 0;
+		uint32_t size = 0;
+		uint64_t handle = 0;
+	};
+
+	// the region vector from before the ring, scanned front to back with a fence poll per region
+	class VectorStagingAllocator {
+	public:
+		explicit VectorStagingAllocator(FakeCopyQueue& queue) : _queue(queue) {}
+
+		StagingRegion allocate(uint32_t size) {
+			const uint32_t alignedSize = AlignStagingSize(size);
+			auto bestNextIt = _regions.begin();
+			for (auto it = _regions.begin(); it != _regions.end(); ++it) {
+				if (!_queue.isReady(it->handle)) continue;
+				if (it->size >= alignedSize) {
+					const StagingRegion result = {it->offset, alignedSize, 0};
+					const uint32_t unusedSize = it->size - alignedSize;
+					const uint32_t unusedOffset = it->offset + alignedSize;
+					_regions.erase(it);
+					if (unusedSize > 0) {
+						_regions.insert(_regions.begin(), {unusedOffset, unusedSize, 0});
+					}
+					return result;
+				}
+				if (it->size > bestNextIt->size) {
+					bestNextIt = it;
+				}
+			}
+			if (bestNextIt != _regions.end() && _queue.isReady(bestNextIt->handle)) {
+				const StagingRegion result = {bestNextIt->offset, bestNextIt->size, 0};
+				_regions.erase(bestNextIt);
+				return result;
+			}
+			// nothing free, wait for the whole buffer
+			for (const StagingRegion& region : _regions) {
+				_queue.wait(region.handle);
+			}
+			_regions.clear();
+			const uint32_t usedSize = std::min(alignedSize, kStagingBufferSize);
+			if (usedSize < kStagingBufferSize) {
+				_regions.push_back({usedSize, kStagingBufferSize - usedSize, 0});
+			}
+			return {0, usedSize, 0};
+		}
+		// the whole region goes back with the handle, even the part that was not copied
+		void release(const StagingRegion& region, uint32_t usedSize, uint64_t handle) {
+			_regions.push_back({region.offset, region.size, handle});
+		}
+	private:
+		FakeCopyQueue& _queue;
+		std::vector<StagingRegion> _regions = { {0, kStagingBufferSize, 0} };
+	};
+
+	// VulkanStagingDevice::_allocateRegion and friends, regions retire from the tail in submission order
+	class RingStagingAllocator {
+	public:
+		explicit RingStagingAllocator(FakeCopyQueue& queue) : _queue(queue) {}
+
+		StagingRegion allocate(uint32_t size) {
+			const uint32_t alignedSize = std::min(AlignStagingSize(size), kStagingBufferSize);
+			while (true) {
+				while (!_inFlight.empty() && _queue.isReady(_inFlight.front().handle)) {
+					_inFlight.pop_front();
+				}
+				if (_inFlight.empty()) {
+					_head = 0;
+					return _take(alignedSize);
+				}
+				const uint32_t tail = _inFlight.front().offset;
+				const uint32_t endSpace = _head > tail ? kStagingBufferSize - _head : (_head < tail ? tail - _head : 0);
+				const uint32_t wrapSpace = _head > tail ? tail : 0;
+				if (endSpace >= alignedSize) {
+					return _take(alignedSize);
+				}
+				if (wrapSpace >= alignedSize || wrapSpace > endSpace) {
+					_inFlight.back().size += kStagingBufferSize - _head;
+					_head = 0;
+					return _take(std::min(alignedSize, wrapSpace));
+				}
+				if (endSpace > 0) {
+					return _take(endSpace);
+				}
+				_queue.wait(_inFlight.front().handle);
+			}
+		}
+		void release(const StagingRegion& region, uint32_t usedSize, uint64_t handle) {
+			usedSize = std::min(AlignStagingSize(usedSize), region.size);
+			_head = region.offset + usedSize;
+			if (usedSize > 0) {
+				_inFlight.push_back({region.offset, usedSize, handle});
+			}
+		}
+	private:
+		StagingRegion _take(uint32_t size) {
+			const StagingRegion region = {_head, size, 0};
+			_head += size;
+			return region;
+		}
+	private:
+		FakeCopyQueue& _queue;
+		std::deque<StagingRegion> _inFlight;
+		uint32_t _head = 0;
+	};
+
+	// one iteration is a frame of bufferSubData calls, every chunk is its own submit like in bufferSubData
+	// the allocator lives across iterations, the old one only shows its fragmentation once it has been used for a while
+	template<typename Allocator>
+	static void StagingUploads(benchmark::State& state) {
+		const auto count = (size_t)state.range(0);
+		MicroBenchRng rng(kMicroBenchSeed);
+		std::uniform_int_distribution<uint32_t> uploadSize(kMinUploadSize, kMaxUploadSize);
+		std::vector<uint32_t> sizes(count);
+		for (uint32_t& size : sizes) {
+			size = uploadSize(rng);
+		}
+		FakeCopyQueue queue;
+		Allocator allocator(queue);
+		for (auto _ : state) {
+			for (uint32_t size : sizes) {
+				while (size) {
+					const StagingRegion region = allocator.allocate(size);
+					const uint32_t chunkSize = std::min(size, region.size);
+					benchmark::DoNotOptimize(region.offset);
+					allocator.release(region, chunkSize, queue.submit());
+					size -= chunkSize;
+				}
+			}
+			queue.endFrame();
+		}
+		state.SetItemsProcessed(state.iterations() * (int64_t)count);
+		state.counters["fence_polls"] = benchmark::Counter((double)queue.getNumReadyChecks(), benchmark::Counter::kAvgIterations);
+		state.counters["stalls"] = benchmark::Counter((double)queue.getNumStalls(), benchmark::Counter::kAvgIterations);
+	}
+	static void BM_Staging_VectorUploads(benchmark::State& state) { StagingUploads<VectorStagingAllocator>(state); }
+	static void BM_Staging_RingUploads(benchmark::State& state) { StagingUploads<RingStagingAllocator>(state); }
+
+	// uploads per frame, a few thousand is what a busy frame of small buffer updates looks like
+	BENCHMARK(BM_Staging_VectorUploads)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMicrosecond);
+	BENCHMARK(BM_Staging_RingUploads)->RangeMultiplier(4)->Range(256, 4096)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,423 @@
+#include "BenchApp.h"
+
+#include "Slate/Common/Logger.h"
+#include "Slate/ECS/Entity.h"
+#include "Slate/Filesystem.h"
+#include "Slate/Loaders/GLTFLoader.h"
+#include "Slate/MeshGenerators.h"
+#include "Slate/Primitives.h"
+#include "Slate/SceneTemplates.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Slate {
+	using BenchClock = std::chrono::steady_clock;
+	static double MillisecondsSince(BenchClock::time_point start) {
+		return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+	}
+	static glm::mat4 TransformToModelMatrix(const TransformComponent& component) {
+		glm::mat4 model = glm::translate(glm::mat4(1), component.global.position);
+		model = model * glm::mat4_cast(component.global.rotation);
+		return glm::scale(model, component.global.scale);
+	}
+
+	void BenchApp::onInitialize() {
+		const VulkanInstanceInfo vk_info = {
+				.app_name = "Slate Bench",
+				.app_version = {0, 0, 1},
+				.engine_name = "Slate Engine",
+				.engine_version = {0, 0, 1},
+				.gpu_profiling = true,
+				.headless_extent = _settings.extent,
+		};
+		_gx.create(vk_info, nullptr);
+		GLTFLoader::_gx = &_gx;
+		Filesystem::SetRelativePath(_settings.assetFolder.string());
+
+		_environment = {
+				{"device", _gx.getDeviceName()},
+				{"extent", {_settings.extent.width, _settings.extent.height}},
+				{"frames", _settings.measuredFrames},
+				{"warmup_frames", _settings.warmupFrames},
+				{"seed", _settings.seed},
+				{"gpu_timings", _gx.isGPUProfilingSupported()},
+#ifdef SLATE_DEBUG
+				{"build", "debug"},
+#else
+				{"build", "release"},
+#endif
+		};
+
+		_primitives[MeshPrimitiveType::Cube] = _gx.createMesh(Primitives::cubeVertices, Primitives::cubeIndices);
+		std::vector<Vertex> vertices = {};
+		std::vector<uint32_t> indices = {};
+		GenerateSphere(vertices, indices, 1.0f, 15, 15);
+		_primitives[MeshPrimitiveType::Sphere] = _gx.createMesh(vertices, indices);
+
+		_colorImage = _gx.createTexture({
+				.dimension = _settings.extent,
+				.usage = TextureUsageBits::TextureUsageBits_Sampled | TextureUsageBits::TextureUsageBits_Attachment,
+				.format = VK_FORMAT_R8G8B8A8_UNORM,
+				.debugName = "Bench Color Image"
+		});
+		_entityImage = _gx.createTexture({
+				.dimension = _settings.extent,
+				.usage = TextureUsageBits::TextureUsageBits_Attachment,
+				.format = VK_FORMAT_R32_UINT,
+				.debugName = "Bench Entity Image"
+		});
+		_depthImage = _gx.createTexture({
+				.dimension = _settings.extent,
+				.usage = TextureUsageBits::TextureUsageBits_Attachment,
+				.format = VK_FORMAT_D32_SFLOAT,
+				.debugName = "Bench Depth Image"
+		});
+
+		_solidShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/solid_shading.slang"));
+		_solidShader.assignHandle(_gx.createShader({
+				.spirvBlob = _solidShader.requestCode(),
+				.pushConstantSize = _solidShader.getPushSize()
+		}));
+		_solidPipeline = _gx.createPipeline({
+				.topology = TopologyMode::TRIANGLE,
+				.polygon = PolygonMode::FILL,
+				.blend = BlendingMode::OFF,
+				.cull = CullMode::BACK,
+				.multisample = SampleCount::X1,
+				.formats = {
+						.colorFormats = {
+								_gx.getTextureFormat(_colorImage),
+								_gx.getTextureFormat(_entityImage)
+						},
+						.depthFormat = _gx.getTextureFormat(_depthImage)
+				},
+				.shaderhandle = _solidShader.getHandle()
+		});
+		// nothing is allowed to compile while frames are being timed
+		_gx.warmPipelines();
+
+		_beginScenario();
+	}
+	void BenchApp::onShutdown() {
+		_gx.deviceWaitIdle();
+		_destroyTextures();
+		delete _scene;
+		_scene = nullptr;
+	}
+
+	void BenchApp::_beginScenario() {
+		const BenchScenario& scenario = _settings.scenarios[_scenarioIndex];
+		_gx.deviceWaitIdle();
+		_destroyTextures();
+		delete _scene;
+		_scene = new Scene;
+		// same seed for every scenario, the same arguments always build the same scenes
+		_rng.seed(_settings.seed);
+
+		switch (scenario.type) {
+			case BenchSceneType::Primitives: _buildPrimitives(scenario.count); break;
+			case BenchSceneType::GLTF: _buildGLTFInstances(scenario.count); break;
+			case BenchSceneType::Lights: _buildLights(scenario.count); break;
+			case BenchSceneType::Textures: _buildTextures(scenario.count); break;
+		}
+
+		BenchResult& result = _results.emplace_back();
+		result.scenario = scenario;
+		result.numEntities = (uint32_t)_scene->GetAllEntities().size();
+		result.frameMs.reserve(_settings.measuredFrames);
+		result.updateMs.reserve(_settings.measuredFrames);
+		result.recordMs.reserve(_settings.measuredFrames);
+		result.submitMs.reserve(_settings.measuredFrames);
+
+		_phase = _settings.warmupFrames > 0 ? Phase::Warmup : Phase::Measure;
+		_phaseFrame = 0;
+		_firstMeasuredFrame = _frameNum + _settings.warmupFrames;
+		LOG_USER(LogType::Info, "Running '{}' with {} entities", scenario.name, result.numEntities);
+	}
+	void BenchApp::_endScenario() {
+		_collectGPUTimings();
+		_scenarioIndex++;
+		if (_scenarioIndex >= _settings.scenarios.size()) {
+			callStop();
+			return;
+		}
+		_beginScenario();
+	}
+
+	glm::vec3 BenchApp::_gridPosition(uint32_t index, uint32_t count) const {
+		static constexpr float kSpacing = 3.f;
+		const auto side = (uint32_t)std::ceil(std::sqrt((float)count));
+		const float offset = (float)(side - 1) * kSpacing * 0.5f;
+		return {(float)(index % side) * kSpacing - offset, 0.f, (float)(index / side) * kSpacing - offset};
+	}
+	void BenchApp::_buildPrimitives(uint32_t count) {
+		std::uniform_real_distribution<float> angle(0.f, glm::two_pi<float>());
+		for (uint32_t i = 0; i < count; i++) {
+			GameEntity entity = _scene->createEntity("Primitive");
+			TransformComponent& transform = entity.addComponent<TransformComponent>();
+			transform.global.position = _gridPosition(i, count);
+			transform.global.rotation = glm::angleAxis(angle(_rng), glm::vec3(0, 1, 0));
+			entity.addComponent<GeometryPrimitiveComponent>().mesh_type = (i % 2 == 0) ? MeshPrimitiveType::Cube : MeshPrimitiveType::Sphere;
+		}
+		_sceneRadius = glm::length(_gridPosition(0, count)) + 2.f;
+	}
+	void BenchApp::_buildGLTFInstances(uint32_t count) {
+		if (!_gltfHandle.valid()) {
+			_gltfHandle = _meshPool.create(Filesystem::GetRelativePath(_settings.gltfModel));
+		}
+		std::uniform_real_distribution<float> angle(0.f, glm::two_pi<float>());
+		for (uint32_t i = 0; i < count; i++) {
+			GameEntity entity = _scene->createEntity("Model");
+			TransformComponent& transform = entity.addComponent<TransformComponent>();
+			transform.global.position = _gridPosition(i, count);
+			transform.global.rotation = glm::angleAxis(angle(_rng), glm::vec3(0, 1, 0));
+			entity.addComponent<GeometryGLTFComponent>().handle = _gltfHandle;
+		}
+		_sceneRadius = glm::length(_gridPosition(0, count)) + 2.f;
+	}
+	void BenchApp::_buildLights(uint32_t count) {
+		_buildPrimitives(kNumLightsFieldPrimitives);
+		std::uniform_real_distribution<float> unit(0.f, 1.f);
+		const float radius = _sceneRadius;
+		for (uint32_t i = 0; i < count; i++) {
+			const glm::vec3 position = {(unit(_rng) * 2.f - 1.f) * radius, 1.f + unit(_rng) * 4.f, (unit(_rng) * 2.f - 1.f) * radius};
+			const glm::vec3 color = {unit(_rng), unit(_rng), unit(_rng)};
+			GameEntity entity = _scene->createEntity("Light");
+			entity.addComponent<TransformComponent>().global.position = position;
+			if (i % 2 == 0) {
+				entity.addComponent<PointLightComponent>().point.Color = color;
+			} else {
+				entity.addComponent<SpotLightComponent>().spot.Color = color;
+			}
+		}
+	}
+
+	void BenchApp::_buildTextures(uint32_t count) {
+		_buildPrimitives(kNumLightsFieldPrimitives);
+		_residentTextures.reserve(count);
+		for (uint32_t i = 0; i < count; i++) {
+			_residentTextures.push_back(_gx.createTexture({
+					.dimension = {4, 4},
+					.usage = TextureUsageBits::TextureUsageBits_Sampled,
+					.format = VK_FORMAT_R8G8B8A8_UNORM,
+					.debugName = "Bench Resident Texture"
+			}));
+		}
+	}
+	// the bindless update of the next command buffer only has to write the recreated slots
+	void BenchApp::_churnTextures() {
+		if (_residentTextures.empty()) return;
+		std::uniform_int_distribution<size_t> pick(0, _residentTextures.size() - 1);
+		for (uint32_t i = 0; i < kNumChurnedTextures; i++) {
+			InternalTextureHandle& texture = _residentTextures[pick(_rng)];
+			_gx.destroy(texture);
+			texture = _gx.createTexture({
+					.dimension = {4, 4},
+					.usage = TextureUsageBits::TextureUsageBits_Sampled,
+					.format = VK_FORMAT_R8G8B8A8_UNORM,
+					.debugName = "Bench Resident Texture"
+			});
+		}
+	}
+	void BenchApp::_destroyTextures() {
+		for (InternalTextureHandle texture : _residentTextures) {
+			_gx.destroy(texture);
+		}
+		_residentTextures.clear();
+	}
+
+	GPU::PerFrameData BenchApp::_buildFrameData() {
+		// looks down at the whole grid from the same spot every frame
+		const glm::vec3 eye = glm::vec3(0.f, _sceneRadius * 0.9f + 4.f, _sceneRadius * 1.1f + 4.f);
+		const float aspect = (float)_settings.extent.width / (float)_settings.extent.height;
+		const GPU::CameraData cameraData = {
+				.projectionMatrix = glm::perspective(glm::radians(65.f), aspect, 0.1f, _sceneRadius * 4.f + 20.f),
+				.viewMatrix = glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0, 1, 0)),
+				.position = eye
+		};
+		const AmbientLightComponent env = _scene->GetEnvironment();
+		GPU::LightingData lightingData {
+				.ambient{
+						.Color = env.ambient.Color,
+						.Intensity = env.ambient.Intensity
+				}
+		};
+		lightingData.ClearDynamics();
+
+		// every light is gathered, only the first few fit in the per frame data
+		uint32_t i = 0;
+		for (const GameEntity& entity : _scene->GetAllEntitiesWithEXT<PointLightComponent>()) {
+			if (i >= GPU::MAX_POINT_LIGHTS) break;
+			const PointLightComponent& entity_light = entity.getComponent<PointLightComponent>();
+			lightingData.points[i] = entity_light.point;
+			lightingData.points[i].Position = entity.getComponent<TransformComponent>().global.position;
+			i++;
+		}
+		i = 0;
+		for (const GameEntity& entity : _scene->GetAllEntitiesWithEXT<SpotLightComponent>()) {
+			if (i >= GPU::MAX_SPOT_LIGHTS) break;
+			const TransformComponent& entity_transform = entity.getComponent<TransformComponent>();
+			lightingData.spots[i] = entity.getComponent<SpotLightComponent>().spot;
+			lightingData.spots[i].Position = entity_transform.global.position;
+			lightingData.spots[i].Direction = entity_transform.global.rotation * glm::vec3(0, -1, 0);
+			i++;
+		}
+		return {
+				.camera = cameraData,
+				.lighting = lightingData,
+				.time = (float)(_frameNum / 60.0),
+				.resolution = {(float)_settings.extent.width, (float)_settings.extent.height}
+		};
+	}
+	void BenchApp::_recordScene(CommandBuffer& cmd) {
+		const RenderPass pass = {
+				.color = {
+						RenderPass::ColorAttachmentDesc{
+								.texture = _colorImage,
+								.loadOp = LoadOperation::CLEAR,
+								.storeOp = StoreOperation::STORE,
+								.clear = RGBA{0.7, 0.7, 0.7, 1}
+						},
+						RenderPass::ColorAttachmentDesc{
+								.texture = _entityImage,
+								.loadOp = LoadOperation::CLEAR,
+								.storeOp = StoreOperation::NO_CARE,
+								.clear = RGBA{-1, 0, 0, 0}
+						}
+				},
+				.depth = {
+						.texture = _depthImage,
+						.loadOp = LoadOperation::CLEAR,
+						.storeOp = StoreOperation::NO_CARE,
+						.clear = 1.f
+				},
+				.debugName = "Scene"
+		};
+		cmd.cmdBeginRendering(pass);
+		cmd.cmdBindRenderPipeline(_solidPipeline);
+		cmd.cmdBindDepthState({
+				.compareOp = CompareOperation::CompareOp_Less,
+				.isDepthWriteEnabled = true,
+		});
+		for (const GameEntity& entity : _scene->GetAllEntitiesWithEXT<GeometryPrimitiveComponent>()) {
+			const MeshData& mesh = _primitives[entity.getComponent<GeometryPrimitiveComponent>().mesh_type];
+			cmd.cmdPushConstants(GPU::PushConstants_EditorSolidShading{
+					.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
+					.vertexBufferAddress = _gx.meshVertexAddress(mesh),
+					.id = (uint32_t)entity.getHandle(),
+			});
+			cmd.cmdDrawMesh(mesh);
+		}
+		for (const GameEntity& entity : _scene->GetAllEntitiesWithEXT<GeometryGLTFComponent>()) {
+			const MeshResource* source = _meshPool.get(entity.getComponent<GeometryGLTFComponent>().handle);
+			if (!source) continue;
+			const glm::mat4 model = TransformToModelMatrix(entity.getComponent<TransformComponent>());
+			for (const MeshData& mesh : source->getBuffers()) {
+				cmd.cmdPushConstants(GPU::PushConstants_EditorSolidShading{
+						.modelMatrix = model,
+						.vertexBufferAddress = _gx.meshVertexAddress(mesh),
+						.id = (uint32_t)entity.getHandle(),
+				});
+				cmd.cmdDrawMesh(mesh);
+			}
+		}
+		// lights show up as small spheres in their own color, like the editor's gizmos
+		const MeshData& lightMesh = _primitives[MeshPrimitiveType::Sphere];
+		const auto drawLight = [&](const GameEntity& entity, const glm::vec3& color) {
+			const glm::vec3 position = entity.getComponent<TransformComponent>().global.position;
+			cmd.cmdPushConstants(GPU::PushConstants_EditorSolidShading{
+					.modelMatrix = glm::scale(glm::translate(glm::mat4(1), position), glm::vec3(0.2f)),
+					.vertexBufferAddress = _gx.meshVertexAddress(lightMesh),
+					.color = color,
+					.id = (uint32_t)entity.getHandle(),
+			});
+			cmd.cmdDrawMesh(lightMesh);
+		};
+		for (const GameEntity& entity : _scene->GetAllEntitiesWithEXT<PointLightComponent>()) {
+			drawLight(entity, entity.getComponent<PointLightComponent>().point.Color);
+		}
+		for (const GameEntity& entity : _scene->GetAllEntitiesWithEXT<SpotLightComponent>()) {
+			drawLight(entity, entity.getComponent<SpotLightComponent>().spot.Color);
+		}
+		cmd.cmdEndRendering();
+	}
+
+	void BenchApp::onTick() {
+		const BenchClock::time_point frameStart = BenchClock::now();
+
+		const BenchClock::time_point updateStart = BenchClock::now();
+		_scene->Tick(1.0 / 60.0);
+		_churnTextures();
+		const GPU::PerFrameData perFrameData = _buildFrameData();
+		const double updateMs = MillisecondsSince(updateStart);
+
+		CommandBuffer& cmd = _gx.acquireCommand();
+		InternalTextureHandle swapTexHandle = _gx.acquireCurrentSwapchainTexture();
+		const BenchClock::time_point recordStart = BenchClock::now();
+		cmd.cmdUpdateBuffer(_gx._globalBufferHandle, perFrameData);
+		_recordScene(cmd);
+		cmd.cmdTransitionLayout(_colorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		cmd.cmdBlitToSwapchain(_colorImage);
+		cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		const double recordMs = MillisecondsSince(recordStart);
+
+		const BenchClock::time_point submitStart = BenchClock::now();
+		_gx.submitCommand(cmd, swapTexHandle);
+		const double submitMs = MillisecondsSince(submitStart);
+		const double frameMs = MillisecondsSince(frameStart);
+		_frameNum++;
+		const DescriptorUpdateStats& descriptorStats = _gx.getDescriptorUpdateStats();
+		const bool hasDescriptorUpdate = descriptorStats.numUpdates != _lastDescriptorUpdate;
+		_lastDescriptorUpdate = descriptorStats.numUpdates;
+
+		BenchResult& result = _results.back();
+		_collectGPUTimings();
+		switch (_phase) {
+			case Phase::Warmup:
+				if (++_phaseFrame >= _settings.warmupFrames) {
+					_phase = Phase::Measure;
+					_phaseFrame = 0;
+				}
+				break;
+			case Phase::Measure:
+				result.frameMs.push_back(frameMs);
+				result.updateMs.push_back(updateMs);
+				result.recordMs.push_back(recordMs);
+				result.submitMs.push_back(submitMs);
+				if (hasDescriptorUpdate) {
+					result.descriptorUpdateMs.push_back(descriptorStats.lastUpdateMs);
+				}
+				if (++_phaseFrame >= _settings.measuredFrames) {
+					const CommandStats& stats = _gx.getLastCommandStats();
+					result.drawCalls = stats.draws;
+					result.stateCommands = stats.getTotalIssued();
+					result.descriptorSlotsWritten = descriptorStats.numSlotsWritten;
+					result.memory = _gx.getDeviceMemoryStats();
+					_phase = Phase::Drain;
+					_phaseFrame = 0;
+				}
+				break;
+			case Phase::Drain:
+				// later frames are not measured, but rendering them lets the profiler resolve the ones that were
+				if (++_phaseFrame >= kNumDrainFrames || !_gx.isGPUProfiling()) {
+					_endScenario();
+				}
+				break;
+		}
+	}
+
+	void BenchApp::_collectGPUTimings() {
+		if (!_gx.isGPUProfiling()) return;
+		BenchResult& result = _results.back();
+		const uint64_t lastMeasuredFrame = _firstMeasuredFrame + _settings.measuredFrames;
+		for (const GPUFrameTimings& timings : _gx.getGPUTimingHistory()) {
+			if (_lastGPUFrameSeen != UINT64_MAX && timings.frameNum <= _lastGPUFrameSeen) continue;
+			_lastGPUFrameSeen = timings.frameNum;
+			if (timings.frameNum >= _firstMeasuredFrame && timings.frameNum < lastMeasuredFrame) {
+				result.gpuMs.push_back(timings.milliseconds);
+			}
+		}
+	}
+}
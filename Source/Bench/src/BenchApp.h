@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+
+#include "BenchReport.h"
+
+#include "Slate/Application.h"
+#include "Slate/ECS/Scene.h"
+#include "Slate/ResourcePool.h"
+#include "Slate/Resources/MeshResource.h"
+#include "Slate/Resources/ShaderResource.h"
+
+namespace Slate {
+	struct BenchSettings
+	{
+		std::vector<BenchScenario> scenarios;
+		uint32_t warmupFrames = 30;
+		uint32_t measuredFrames = 300;
+		VkExtent2D extent = {1280, 720};
+		uint32_t seed = 1337;
+		// relative to the asset folder, only loaded when a gltf scenario runs
+		std::filesystem::path gltfModel = "models/Suzanne/glTF/Suzanne.gltf";
+		std::filesystem::path assetFolder;
+	};
+
+	// renders every scenario back to back in one headless GX, each one gets a fresh scene
+	class BenchApp final : public Application {
+	public:
+		explicit BenchApp(BenchSettings settings) : _settings(std::move(settings)) {}
+
+		inline const std::vector<BenchResult>& getResults() const { return _results; }
+		// device, extent and frame counts, the report is only comparable against baselines that match
+		inline const nlohmann::json& getEnvironment() const { return _environment; }
+	protected:
+		void onInitialize() override;
+		void onTick() override;
+		void onRender() override {}
+		void onShutdown() override;
+	private:
+		enum class Phase : uint8_t {
+			Warmup,
+			Measure,
+			Drain // cpu side is done, waiting for the gpu timings of the measured frames to resolve
+		};
+		// frames that can be in flight before their timings resolve
+		static constexpr uint32_t kNumDrainFrames = 8;
+		static constexpr uint32_t kNumLightsFieldPrimitives = 256;
+		// textures destroyed and created again every frame of a textures scenario
+		static constexpr uint32_t kNumChurnedTextures = 16;
+
+		void _beginScenario();
+		void _endScenario();
+		void _buildPrimitives(uint32_t count);
+		void _buildGLTFInstances(uint32_t count);
+		void _buildLights(uint32_t count);
+		void _buildTextures(uint32_t count);
+		void _churnTextures();
+		void _destroyTextures();
+		glm::vec3 _gridPosition(uint32_t index, uint32_t count) const;
+		void _collectGPUTimings();
+
+		GPU::PerFrameData _buildFrameData();
+		void _recordScene(CommandBuffer& cmd);
+	private:
+		BenchSettings _settings;
+		nlohmann::json _environment;
+		std::vector<BenchResult> _results;
+
+		Scene* _scene = nullptr;
+		std::mt19937 _rng;
+		uint32_t _scenarioIndex = 0;
+		Phase _phase = Phase::Warmup;
+		uint32_t _phaseFrame = 0;
+		uint64_t _frameNum = 0;
+		// profiler frame numbers of the measured frames
+		uint64_t _firstMeasuredFrame = 0;
+		uint64_t _lastGPUFrameSeen = UINT64_MAX;
+		float _sceneRadius = 1.f;
+
+		std::unordered_map<MeshPrimitiveType, MeshData> _primitives;
+		ResourcePool<MeshResource> _meshPool;
+		MeshHandle _gltfHandle = {};
+		ShaderResource _solidShader;
+		InternalPipelineHandle _solidPipeline;
+
+		InternalTextureHandle _colorImage;
+		InternalTextureHandle _entityImage;
+		InternalTextureHandle _depthImage;
+
+		std::vector<InternalTextureHandle> _residentTextures;
+		uint32_t _lastDescriptorUpdate = 0;
+	};
+}
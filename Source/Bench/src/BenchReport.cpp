@@ -0,0 +1,171 @@
+#include "BenchReport.h"
+
+#include "Slate/Common/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+
+namespace Slate {
+	// timings closer than this to the baseline are never flagged, a few microseconds of jitter is not a regression
+	static constexpr double kTimingNoiseFloorMs = 0.05;
+
+	struct BenchMetric
+	{
+		const char* pointer;
+		bool isTiming;
+	};
+	// lower is better for every one of these
+	static constexpr BenchMetric kComparedMetrics[] = {
+			{"/cpu_frame_ms/median", true},
+			{"/cpu_frame_ms/p95", true},
+			{"/update_ms/median", true},
+			{"/record_ms/median", true},
+			{"/submit_ms/median", true},
+			{"/gpu_frame_ms/median", true},
+			{"/descriptor_update_ms/median", true},
+			{"/draw_calls", false},
+			{"/state_commands", false},
+			{"/device_memory/allocated_bytes", false},
+	};
+
+	static nlohmann::json Summarize(std::vector<double> samples) {
+		if (samples.empty()) return nullptr;
+		std::sort(samples.begin(), samples.end());
+		const auto percentile = [&](double p) {
+			const double rank = p * (double)(samples.size() - 1);
+			const size_t lower = (size_t)std::floor(rank);
+			const size_t upper = std::min(lower + 1, samples.size() - 1);
+			return samples[lower] + (samples[upper] - samples[lower]) * (rank - (double)lower);
+		};
+		const double mean = std::accumulate(samples.begin(), samples.end(), 0.0) / (double)samples.size();
+		double variance = 0.0;
+		for (double sample : samples) {
+			variance += (sample - mean) * (sample - mean);
+		}
+		variance /= (double)samples.size();
+		return {
+				{"mean", mean},
+				{"median", percentile(0.5)},
+				{"p95", percentile(0.95)},
+				{"min", samples.front()},
+				{"max", samples.back()},
+				{"stddev", std::sqrt(variance)},
+		};
+	}
+
+	const char* ToString(BenchSceneType type) {
+		switch (type) {
+			case BenchSceneType::Primitives: return "primitives";
+			case BenchSceneType::GLTF: return "gltf";
+			case BenchSceneType::Lights: return "lights";
+			case BenchSceneType::Textures: return "textures";
+		}
+		return "unknown";
+	}
+	bool ParseBenchScenario(const std::string& arg, BenchScenario& scenario) {
+		const size_t colon = arg.find(':');
+		if (colon == std::string::npos) return false;
+		const std::string type = arg.substr(0, colon);
+		if (type == "primitives") {
+			scenario.type = BenchSceneType::Primitives;
+		} else if (type == "gltf") {
+			scenario.type = BenchSceneType::GLTF;
+		} else if (type == "lights") {
+			scenario.type = BenchSceneType::Lights;
+		} else if (type == "textures") {
+			scenario.type = BenchSceneType::Textures;
+		} else {
+			return false;
+		}
+		char* end = nullptr;
+		const unsigned long count = std::strtoul(arg.c_str() + colon + 1, &end, 10);
+		if (end == arg.c_str() + colon + 1 || *end != '\0' || count == 0) return false;
+		scenario.count = (uint32_t)count;
+		scenario.name = type + "_" + std::to_string(count);
+		return true;
+	}
+
+	nlohmann::json WriteBenchReport(const std::vector<BenchResult>& results, const nlohmann::json& environment) {
+		nlohmann::json report = {
+				{"version", 1},
+				{"environment", environment},
+				{"scenarios", nlohmann::json::array()},
+		};
+		for (const BenchResult& result : results) {
+			report["scenarios"].push_back({
+					{"name", result.scenario.name},
+					{"type", ToString(result.scenario.type)},
+					{"count", result.scenario.count},
+					{"entities", result.numEntities},
+					{"frames", result.frameMs.size()},
+					{"cpu_frame_ms", Summarize(result.frameMs)},
+					{"update_ms", Summarize(result.updateMs)},
+					{"record_ms", Summarize(result.recordMs)},
+					{"submit_ms", Summarize(result.submitMs)},
+					{"gpu_frame_ms", Summarize(result.gpuMs)},
+					{"descriptor_update_ms", Summarize(result.descriptorUpdateMs)},
+					{"draw_calls", result.drawCalls},
+					{"state_commands", result.stateCommands},
+					{"descriptor_slots_written", result.descriptorSlotsWritten},
+					{"device_memory", {
+							{"allocated_bytes", result.memory.allocatedBytes},
+							{"block_bytes", result.memory.blockBytes},
+							{"usage_bytes", result.memory.usageBytes},
+							{"allocations", result.memory.numAllocations},
+					}},
+			});
+		}
+		return report;
+	}
+
+	std::vector<BenchRegression> CompareBenchReports(const nlohmann::json& current, const nlohmann::json& baseline, double threshold) {
+		std::vector<BenchRegression> regressions;
+		if (!baseline.contains("scenarios")) {
+			LOG_USER(LogType::Error, "Baseline has no scenarios to compare against");
+			return regressions;
+		}
+		const nlohmann::json& currentEnv = current["environment"];
+		const nlohmann::json baselineEnv = baseline.contains("environment") ? baseline["environment"] : nlohmann::json::object();
+		for (const char* key : {"device", "extent", "frames"}) {
+			const nlohmann::json then = baselineEnv.contains(key) ? baselineEnv[key] : nlohmann::json();
+			const nlohmann::json now = currentEnv.contains(key) ? currentEnv[key] : nlohmann::json();
+			if (then != now) {
+				LOG_USER(LogType::Warning, "Baseline was recorded with a different '{}' ({} vs {}), results may not be comparable", key, then.dump(), now.dump());
+			}
+		}
+
+		for (const nlohmann::json& scenario : current["scenarios"]) {
+			const std::string name = scenario["name"];
+			const auto match = std::find_if(baseline["scenarios"].begin(), baseline["scenarios"].end(), [&](const nlohmann::json& other) {
+				return other.value("name", "") == name;
+			});
+			if (match == baseline["scenarios"].end()) {
+				LOG_USER(LogType::Info, "Scenario '{}' is not in the baseline, skipped", name);
+				continue;
+			}
+			for (const BenchMetric& metric : kComparedMetrics) {
+				const nlohmann::json::json_pointer pointer(metric.pointer);
+				if (!scenario.contains(pointer) || !match->contains(pointer)) continue;
+				const nlohmann::json& now = scenario[pointer];
+				const nlohmann::json& then = (*match)[pointer];
+				if (!now.is_number() || !then.is_number()) continue;
+
+				const double value = now.get<double>();
+				const double reference = then.get<double>();
+				const double limit = reference * (1.0 + threshold);
+				const bool isWithinNoise = metric.isTiming && value - reference <= kTimingNoiseFloorMs;
+				if (value > limit && !isWithinNoise) {
+					regressions.push_back({
+							.scenario = name,
+							.metric = metric.pointer + 1,
+							.baseline = reference,
+							.current = value,
+					});
+				}
+			}
+		}
+		return regressions;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "Slate/GX.h"
+
+namespace Slate {
+	enum class BenchSceneType : uint8_t {
+		Primitives, // cubes and spheres from the built in meshes
+		GLTF,       // instances of one imported model
+		Lights,     // point and spot lights over a fixed field of primitives
+		Textures    // resident bindless textures over the same field, a few get recreated every frame
+	};
+	// written as "<type>:<count>" on the command line, the name is what baselines are matched by
+	struct BenchScenario
+	{
+		std::string name;
+		BenchSceneType type = BenchSceneType::Primitives;
+		uint32_t count = 0;
+	};
+	struct BenchResult
+	{
+		BenchScenario scenario;
+		uint32_t numEntities = 0;
+		// one entry per measured frame
+		std::vector<double> frameMs;  // whole tick, including the wait for a free swapchain image
+		std::vector<double> updateMs; // scene tick and per frame data
+		std::vector<double> recordMs;
+		std::vector<double> submitMs;
+		std::vector<double> gpuMs;    // empty when gpu profiling is unsupported
+		std::vector<double> descriptorUpdateMs; // only frames that wrote bindless descriptors
+		// of the last measured frame, every frame records the same commands
+		uint32_t drawCalls = 0;
+		uint32_t stateCommands = 0;
+		uint32_t descriptorSlotsWritten = 0;
+		DeviceMemoryStats memory = {};
+	};
+	struct BenchRegression
+	{
+		std::string scenario;
+		std::string metric;
+		double baseline = 0.0;
+		double current = 0.0;
+	};
+
+	bool ParseBenchScenario(const std::string& arg, BenchScenario& scenario);
+	const char* ToString(BenchSceneType type);
+
+	nlohmann::json WriteBenchReport(const std::vector<BenchResult>& results, const nlohmann::json& environment);
+	// a metric regressed when it grew past baseline * (1 + threshold), timings also have to move by more than the noise floor
+	std::vector<BenchRegression> CompareBenchReports(const nlohmann::json& current, const nlohmann::json& baseline, double threshold);
+}
@@ -0,0 +1,123 @@
+#include "BenchApp.h"
+#include "BenchReport.h"
+
+#include "Slate/Common/Logger.h"
+#include "Slate/Filesystem.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// exit codes, scripts only need to tell "slower than the baseline" apart from "did not run"
+static constexpr int kExitOk = 0;
+static constexpr int kExitRegressed = 1;
+static constexpr int kExitBadArguments = 2;
+
+static void PrintUsage() {
+	fmt::println("usage: SlateBench [options]\n"
+				 "  --scene <type>:<count>   primitives, gltf, lights or textures, can be repeated, runs the default suite when left out\n"
+				 "  --frames <n>             measured frames per scene (300)\n"
+				 "  --warmup <n>             frames rendered before measuring (30)\n"
+				 "  --extent <w>x<h>         size of the offscreen swapchain (1280x720)\n"
+				 "  --seed <n>               seed for the scene layouts (1337)\n"
+				 "  --assets <dir>           folder shaders and models are loaded from\n"
+				 "  --gltf <file>            model the gltf scenes instance, relative to the asset folder\n"
+				 "  --out <file.json>        where the report goes, printed when left out\n"
+				 "  --baseline <file.json>   compare against an earlier report, exits with 1 on a regression\n"
+				 "  --threshold <fraction>   how much worse than the baseline a metric may get (0.1)");
+}
+
+int main(int argc, char* argv[]) {
+	using namespace Slate;
+	BenchSettings settings = {
+			.assetFolder = SLATE_BENCH_ASSET_FOLDER,
+	};
+	std::filesystem::path outPath;
+	std::filesystem::path baselinePath;
+	double threshold = 0.1;
+
+	for (int i = 1; i < argc; i++) {
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--scene") == 0 && hasValue) {
+			BenchScenario scenario;
+			if (!ParseBenchScenario(argv[++i], scenario)) {
+				LOG_USER(LogType::Error, "Bad scene '{}', expected <primitives|gltf|lights|textures>:<count>", argv[i]);
+				return kExitBadArguments;
+			}
+			settings.scenarios.push_back(std::move(scenario));
+		} else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+			settings.measuredFrames = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--warmup") == 0 && hasValue) {
+			settings.warmupFrames = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--extent") == 0 && hasValue) {
+			unsigned int w = 0, h = 0;
+			if (std::sscanf(argv[++i], "%ux%u", &w, &h) != 2 || w == 0 || h == 0) {
+				LOG_USER(LogType::Error, "Bad extent '{}', expected <width>x<height>", argv[i]);
+				return kExitBadArguments;
+			}
+			settings.extent = {w, h};
+		} else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+			settings.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--assets") == 0 && hasValue) {
+			settings.assetFolder = argv[++i];
+		} else if (strcmp(argv[i], "--gltf") == 0 && hasValue) {
+			settings.gltfModel = argv[++i];
+		} else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+			outPath = argv[++i];
+		} else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+			baselinePath = argv[++i];
+		} else if (strcmp(argv[i], "--threshold") == 0 && hasValue) {
+			threshold = std::strtod(argv[++i], nullptr);
+		} else {
+			PrintUsage();
+			return strcmp(argv[i], "--help") == 0 ? kExitOk : kExitBadArguments;
+		}
+	}
+	if (settings.measuredFrames == 0) {
+		LOG_USER(LogType::Error, "Need at least one measured frame");
+		return kExitBadArguments;
+	}
+	if (settings.scenarios.empty()) {
+		for (const char* arg : {"primitives:100", "primitives:1000", "primitives:10000", "gltf:100", "gltf:1000", "lights:64", "lights:1024", "textures:10000"}) {
+			ParseBenchScenario(arg, settings.scenarios.emplace_back());
+		}
+	}
+	// the asset folder is prepended as a plain string
+	std::string assetFolder = settings.assetFolder.string();
+	if (!assetFolder.empty() && assetFolder.back() != '/') {
+		settings.assetFolder = assetFolder + "/";
+	}
+	// read it up front, no point rendering anything if the comparison can't happen
+	nlohmann::json baseline;
+	if (!baselinePath.empty()) {
+		baseline = Filesystem::ReadJsonFile(baselinePath);
+		if (baseline.empty()) return kExitBadArguments;
+	}
+
+	BenchApp app(std::move(settings));
+	app.runHeadless();
+
+	const nlohmann::json report = WriteBenchReport(app.getResults(), app.getEnvironment());
+	if (outPath.empty()) {
+		fmt::println("{}", report.dump(2));
+	} else {
+		std::ofstream file(outPath, std::ios::trunc);
+		if (!file.is_open()) {
+			LOG_USER(LogType::Error, "Failed to write the report to '{}'", outPath.string());
+			return kExitBadArguments;
+		}
+		file << report.dump(2) << "\n";
+		LOG_USER(LogType::Info, "Wrote the report to '{}'", outPath.string());
+	}
+
+	if (baseline.empty()) return kExitOk;
+	const std::vector<BenchRegression> regressions = CompareBenchReports(report, baseline, threshold);
+	for (const BenchRegression& regression : regressions) {
+		LOG_USER(LogType::Error, "{} regressed {}: {:.3f} -> {:.3f} (+{:.1f}%)", regression.scenario, regression.metric,
+				 regression.baseline, regression.current, regression.baseline > 0.0 ? (regression.current / regression.baseline - 1.0) * 100.0 : 100.0);
+	}
+	if (!regressions.empty()) return kExitRegressed;
+	LOG_USER(LogType::Info, "No regressions against '{}' at a {:.0f}% threshold", baselinePath.string(), threshold * 100.0);
+	return kExitOk;
+}
@@ -24,6 +24,13 @@ namespace Slate {
 
 	public:
 		bool isEditorMode = false;
+		// headless runs, captures the last frame and dumps the gpu timings when these are set
+		uint32_t numFrames = 0;
+		std::filesystem::path capturePath;
+		std::filesystem::path gpuTimingsPath;
+	private:
+		uint32_t _frame = 0;
+		ReadbackToken _captureToken = {};
 	};
 
 	struct Camera {
@@ -220,7 +227,8 @@ namespace Slate {
 				.app_name = "Slate Example App",
 				.app_version = {0, 0, 1},
 				.engine_name = "Slate Engine",
-				.engine_version = {0, 0, 1}
+				.engine_version = {0, 0, 1},
+				.gpu_profiling = !gpuTimingsPath.empty()
 		};
 		_gx.create(vk_info, _window.getGLFWWindow());
 		Filesystem::SetRelativePath("/Users/hayde/Projects/Personal/Slated/Source/EditorOLD/");
@@ -457,12 +465,11 @@ namespace Slate {
 
 				GPU::PerObjectData constants = {
 						.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-						.vertexBufferAddress = _gx.gpuAddress(mesh.getVertexBufferHandle()),
+						.vertexBufferAddress = _gx.meshVertexAddress(mesh),
 						.id = (uint32_t) entity.getHandle(),
 				};
 				cmd.cmdPushConstants(constants);
-				cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-				cmd.cmdDrawIndexed(mesh.getIndexCount());
+				cmd.cmdDrawMesh(mesh);
 			}
 //			for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<GeometryGLTFComponent>()) {
 //				const auto meshSource = _meshPool.get(entity.getComponent<GeometryGLTFComponent>().handle);
@@ -470,12 +477,11 @@ namespace Slate {
 //					const MeshData &mesh = meshSource->getBuffers()[k];
 //					GPU::PushConstants_EditorPrimitives constants = {
 //							.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-//							.vertexBufferAddress = _gx.gpuAddress(mesh.getVertexBufferHandle()),
+//							.vertexBufferAddress = _gx.meshVertexAddress(mesh),
 //							.color = {1, 0, 0}// we just keep red for now
 //					};
 //					cmd.cmdPushConstants(constants);
-//					cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-//					cmd.cmdDrawIndexed(mesh.getIndexCount());
+//					cmd.cmdDrawMesh(mesh);
 //				}
 //			}
 		}
@@ -488,18 +494,45 @@ namespace Slate {
 		cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
 		_gx.submitCommand(cmd, swapTexHandle);
+		if (_gx.isHeadless() && !capturePath.empty() && _frame + 1 == numFrames) {
+			_captureToken = _gx.captureTexture(swapTexHandle, capturePath);
+		}
+		_frame++;
 	}
 	void App::onRender() {
 	}
 	void App::onShutdown() {
+		if (!_captureToken.empty()) {
+			_gx.waitDownload(_captureToken);
+		}
+		if (!gpuTimingsPath.empty()) {
+			_gx.deviceWaitIdle();
+			_gx.saveGPUTimings(gpuTimingsPath);
+		}
 	}
 }
 
 int main(int argc, char* argv[]) {
 	Slate::App app;
 	app.isEditorMode = false;
-	if (argc > 1 && strcmp(argv[1], "--editor") != 0)
-		app.isEditorMode = true;
-	app.run();
+	bool isHeadless = false;
+	// --headless <frames> [--capture <file.png>] [--gpu-timings <file.csv>]
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--editor") == 0) {
+			app.isEditorMode = true;
+		} else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+			isHeadless = true;
+			app.numFrames = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			app.capturePath = argv[++i];
+		} else if (strcmp(argv[i], "--gpu-timings") == 0 && i + 1 < argc) {
+			app.gpuTimingsPath = argv[++i];
+		}
+	}
+	if (isHeadless) {
+		app.runHeadless(app.numFrames);
+	} else {
+		app.run();
+	}
 	return 0;
 }
\ No newline at end of file
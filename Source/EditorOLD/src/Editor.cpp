@@ -11,6 +11,7 @@
 #include <imgui_impl_glfw.h>
 
 
+#include <algorithm>
 #include <thread>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -23,9 +24,12 @@
 #include "Slate/Common/Logger.h"
 #include "Slate/ECS/Components.h"
 #include "Slate/ECS/Entity.h"
+#include <Slate/DrawList.h>
+#include <Slate/FrameGraph.h>
 #include <Slate/Filesystem.h>
 #include <Slate/Loaders/GLTFLoader.h>
 #include <Slate/MeshGenerators.h>
+#include <Slate/ParallelRecorder.h>
 #include <Slate/PipelineBuilder.h>
 #include <Slate/Primitives.h>
 #include <Slate/Resources/MeshResource.h>
@@ -682,12 +686,15 @@ namespace Slate {
 	InternalPipelineHandle shadedModePipeline;
 	InternalPipelineHandle wireframeModePipeline;
 	InternalPipelineHandle unshadedModePipeline;
+	InternalComputePipelineHandle cullInstancesPipeline;
+	InternalComputePipelineHandle compactDrawsPipeline;
 	InternalPipelineHandle gridShaderPipeline;
 
 	InternalPipelineHandle wireframeVisualizerPipeline;
 	InternalPipelineHandle filledVisualizerPipeline;
 	InternalPipelineHandle fullscreenPipeline;
 	InternalPipelineHandle pureOutlinePipeline;
+	InternalPipelineHandle pickingPipeline;
 
 	// editor provided resources
 
@@ -696,6 +703,26 @@ namespace Slate {
 	MeshData cubeMeshData;
 	MeshData sphereMeshData;
 
+	// the solid pipeline of the viewport mode, the wireframe overlay has its own list for its color and depth bias
+	UniquePtr<DrawList> sceneDrawList = nullptr;
+	UniquePtr<DrawList> wireframeDrawList = nullptr;
+	UniquePtr<FrameGraph> frameGraph = nullptr;
+	UniquePtr<ParallelRecorder> parallelRecorder = nullptr;
+	// picks with fewer draws than this are cheaper to record on the render thread alone
+	static constexpr uint32_t kParallelPickDrawThreshold = 512;
+	static constexpr uint32_t kPickDrawsPerTask = 128;
+	struct SceneDraw {
+		glm::mat4 model;
+		const MeshData* mesh;
+		VkDeviceAddress vertexBufferAddress;
+		uint32_t id;
+	};
+	std::vector<SceneDraw> sceneDraws;
+	std::vector<GPU::PerObjectData> pickBillboards;
+	// set whenever the attachments are recreated, they are aliased once the frame graph told us their lifetimes
+	bool attachmentsNeedAliasing = true;
+	// the groups the attachments were aliased with, the pass set changes with the editor state
+	std::vector<std::vector<InternalTextureHandle>> attachmentAliasGroups;
 
 	// visible built in editor resources
 	TextureResource lightbulbTexture;
@@ -708,10 +735,13 @@ namespace Slate {
 	ShaderResource standardShader;
 	ShaderResource primitiveShader;
 	ShaderResource imageShader;
-	ShaderResource solidShader;
+	ShaderResource solidIndirectShader;
+	ShaderResource primitiveIndirectShader;
+	ShaderResource frustumCullShader;
 	ShaderResource infiniteGridShader;
 	ShaderResource fullscreenShader;
 	ShaderResource pureMaskShader;
+	ShaderResource pickingShader;
 
 
 	void CreateEditorAttachments(GX& gx, EditorApplication& app) {
@@ -741,21 +771,22 @@ namespace Slate {
 				.format = VK_FORMAT_D32_SFLOAT_S8_UINT,
 				.debugName = "DepthStencil Image"
 		});
-		app.entityResolveImage = gx.createTexture({
+		// picking only needs the nearest id, a single sample is exact and nothing has to be resolved
+		app.entityIdImage = gx.createTexture({
 				.dimension = extent2D,
 				.samples = SampleCount::X1,
-				.usage = TextureUsageBits::TextureUsageBits_Attachment | TextureUsageBits::TextureUsageBits_Storage,
+				.usage = TextureUsageBits::TextureUsageBits_Attachment,
 				.storage = StorageType::Device,
 				.format = VK_FORMAT_R32_UINT,
 				.debugName = "Entity Image"
 		});
-		app.entityMSAAImage = gx.createTexture({
+		app.entityDepthImage = gx.createTexture({
 				.dimension = extent2D,
-				.samples = SampleCount::X4,
+				.samples = SampleCount::X1,
 				.usage = TextureUsageBits::TextureUsageBits_Attachment,
 				.storage = StorageType::Memoryless,
-				.format = VK_FORMAT_R32_UINT,
-				.debugName = "Entity MSAA Image"
+				.format = VK_FORMAT_D32_SFLOAT,
+				.debugName = "Entity Depth Image"
 		});
 
 		app.outlineImage = gx.createTexture({
@@ -775,6 +806,31 @@ namespace Slate {
 				.format = VK_FORMAT_R8G8B8A8_UNORM,
 				.debugName = "Viewport Image"
 		});
+		attachmentsNeedAliasing = true;
+	}
+	void DestroyEditorAttachments(GX& gx, EditorApplication& app) {
+		gx.destroy(app.colorResolveImage);
+		gx.destroy(app.colorMSAAImage);
+		gx.destroy(app.entityIdImage);
+		gx.destroy(app.entityDepthImage);
+		gx.destroy(app.depthStencilMSAAImage);
+		gx.destroy(app.outlineImage);
+		gx.destroy(app.viewportImage);
+	}
+	void LogAttachmentMemory(GX& gx, const EditorApplication& app) {
+		const InternalTextureHandle attachments[] = {
+				app.colorResolveImage, app.colorMSAAImage, app.depthStencilMSAAImage, app.entityIdImage,
+				app.entityDepthImage, app.outlineImage, app.viewportImage
+		};
+		VkDeviceSize before = 0;
+		for (InternalTextureHandle attachment : attachments) {
+			before += gx.getTextureMemorySize(attachment);
+		}
+		const TransientMemoryStats& stats = gx.getTransientMemoryStats();
+		const VkDeviceSize after = before - stats.aliasedRequestedBytes + stats.aliasedCommittedBytes - stats.lazilyAllocatedBytes;
+		LOG_USER(LogType::Info, "Editor attachments: {:.1f} MB -> {:.1f} MB ({} textures aliased into {} allocations, {:.1f} MB lazily allocated)",
+				 (double)before / (1024.0 * 1024.0), (double)after / (1024.0 * 1024.0), stats.numAliasedTextures, stats.numAliasGroups,
+				 (double)stats.lazilyAllocatedBytes / (1024.0 * 1024.0));
 	}
 	void CreateEditorMeshes(GX& gx, std::unordered_map<MeshPrimitiveType, MeshData>& defaults) {
 		quadMeshData = gx.createMesh(Primitives::quadVertices, Primitives::quadIndices);
@@ -837,9 +893,10 @@ namespace Slate {
 		}));
 	}
 	void LoadEditorShaders(GX& gx) {
-		standardShader.loadResource(Filesystem::GetRelativePath("shaders/zippy.slang"));
+		standardShader.loadResource(Filesystem::GetRelativePath("shaders/zippy_indirect.slang"));
 		standardShader.assignHandle(gx.createShader({
-				.spirvBlob = standardShader.requestCode()
+				.spirvBlob = standardShader.requestCode(),
+				.pushConstantSize = standardShader.getPushSize()
 		}));
 		crazyShader.loadResource(Filesystem::GetRelativePath("shaders/zippy.slang"));
 		crazyShader.assignHandle(gx.createShader({
@@ -856,10 +913,20 @@ namespace Slate {
 				.spirvBlob = imageShader.requestCode(),
 				.pushConstantSize = imageShader.getPushSize()
 		}));
-		solidShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/solid_shading.slang"));
-		solidShader.assignHandle(gx.createShader({
-				.spirvBlob = solidShader.requestCode(),
-				.pushConstantSize = solidShader.getPushSize()
+		solidIndirectShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/solid_shading_indirect.slang"));
+		solidIndirectShader.assignHandle(gx.createShader({
+				.spirvBlob = solidIndirectShader.requestCode(),
+				.pushConstantSize = solidIndirectShader.getPushSize()
+		}));
+		primitiveIndirectShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/editor_primitives_indirect.slang"));
+		primitiveIndirectShader.assignHandle(gx.createShader({
+				.spirvBlob = primitiveIndirectShader.requestCode(),
+				.pushConstantSize = primitiveIndirectShader.getPushSize()
+		}));
+		frustumCullShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/frustum_cull.slang"));
+		frustumCullShader.assignHandle(gx.createShader({
+				.spirvBlob = frustumCullShader.requestCode(),
+				.pushConstantSize = frustumCullShader.getPushSize()
 		}));
 		infiniteGridShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/editor_grid.slang"));
 		infiniteGridShader.assignHandle(gx.createShader({
@@ -876,6 +943,11 @@ namespace Slate {
 				.spirvBlob = pureMaskShader.requestCode(),
 				.pushConstantSize = pureMaskShader.getPushSize()
 		}));
+		pickingShader.loadResource(Filesystem::GetRelativePath("shaders/EditorEXT/picking.slang"));
+		pickingShader.assignHandle(gx.createShader({
+				.spirvBlob = pickingShader.requestCode(),
+				.pushConstantSize = pickingShader.getPushSize()
+		}));
 	}
 
 	void EditorApplication::onInitialize() {
@@ -893,7 +965,9 @@ namespace Slate {
 				.app_name = "Slate Editor",
 				.app_version = {0, 0, 1},
 				.engine_name = "Slate Engine",
-				.engine_version = {0, 0, 1}
+				.engine_version = {0, 0, 1},
+				.preallocate_bindless = true,
+				.gpu_profiling = true,
 		};
 		GX& gx = this->_gx;
 		gx.create(vk_info, getActiveWindow()->getGLFWWindow());
@@ -906,13 +980,6 @@ namespace Slate {
 		CreateEditorAttachments(gx, *this);
 		CreateEditorMeshes(gx, defaultMeshPrimitiveTypes);
 		this->_createVisualizerMeshes();
-		// for edito viewport object selection
-		_stagbuf = gx.createBuffer({
-				.size = sizeof(uint32_t),
-				.usage = BufferUsageBits::BufferUsageBits_Storage,
-				.storage = StorageType::HostVisible,
-				.debugName = "Viewport Selection Buffer"
-		});
 		// visible editor resources
 		LoadEditorTextures(gx);
 		LoadEditorShaders(gx);
@@ -932,10 +999,7 @@ namespace Slate {
 		// ImGui
 		ImGuiRequiredData imgui_required = gx.requestImGuiRequiredData();
 		this->InitImGui(imgui_required, getActiveWindow()->getGLFWWindow(), VK_FORMAT_R8G8B8A8_UNORM);
-		{
-			auto [ sampler, image_view ] = gx.requestViewportImageData(viewportImage);
-			this->_viewportImageDescriptorSet = ImGui_ImplVulkan_AddTexture(sampler, image_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-		}
+		this->_refreshViewportDescriptorSet();
 		{
 			int w, h;
 			void* data = stbi_load(Filesystem::GetRelativePath("textures/icons/file.png").c_str(), &w, &h, nullptr, 4);
@@ -966,10 +1030,10 @@ namespace Slate {
 		// do our themes setting, imgui fonts and style
 		BuildStyle();
 
+		// the scene shaders still write their id to the second target, without an attachment there it is simply dropped
 		const PipelineSpec::AttachmentFormats standardFormats = {
 				.colorFormats = {
 						gx.getTextureFormat(colorMSAAImage),
-						gx.getTextureFormat(entityMSAAImage)
 				},
 				.depthFormat = gx.getTextureFormat(depthStencilMSAAImage)
 		};
@@ -984,6 +1048,12 @@ namespace Slate {
 						gx.getTextureFormat(outlineImage)
 				}
 		};
+		const PipelineSpec::AttachmentFormats pickingFormats = {
+				.colorFormats = {
+						gx.getTextureFormat(entityIdImage)
+				},
+				.depthFormat = gx.getTextureFormat(entityDepthImage)
+		};
 		shadedModePipeline = gx.createPipeline({
 				.topology = TopologyMode::TRIANGLE,
 				.polygon = PolygonMode::FILL,
@@ -1000,7 +1070,7 @@ namespace Slate {
 				.cull = CullMode::OFF,
 				.multisample = SampleCount::X4,
 				.formats = standardFormats,
-				.shaderhandle = primitiveShader.getHandle()
+				.shaderhandle = primitiveIndirectShader.getHandle()
 		});
 		unshadedModePipeline = gx.createPipeline({
 			   .topology = TopologyMode::TRIANGLE,
@@ -1009,8 +1079,22 @@ namespace Slate {
 			   .cull = CullMode::BACK,
 			   .multisample = SampleCount::X4,
 			   .formats = standardFormats,
-			   .shaderhandle = solidShader.getHandle()
+			   .shaderhandle = solidIndirectShader.getHandle()
 	   });
+		cullInstancesPipeline = gx.createComputePipeline({
+				.shaderhandle = frustumCullShader.getHandle(),
+				.entryPoint = "cs_cull_instances"
+		});
+		compactDrawsPipeline = gx.createComputePipeline({
+				.shaderhandle = frustumCullShader.getHandle(),
+				.entryPoint = "cs_compact_draws"
+		});
+		sceneDrawList = CreateUniquePtr<DrawList>(gx);
+		sceneDrawList->setCulling(cullInstancesPipeline, compactDrawsPipeline);
+		wireframeDrawList = CreateUniquePtr<DrawList>(gx);
+		wireframeDrawList->setCulling(cullInstancesPipeline, compactDrawsPipeline);
+		frameGraph = CreateUniquePtr<FrameGraph>(gx);
+		parallelRecorder = CreateUniquePtr<ParallelRecorder>(gx, std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u));
 		gridShaderPipeline = gx.createPipeline({
 				.topology = TopologyMode::TRIANGLE,
 				.polygon = PolygonMode::FILL,
@@ -1054,6 +1138,15 @@ namespace Slate {
 				.formats = maskFormats,
 				.shaderhandle = pureMaskShader.getHandle()
 		});
+		pickingPipeline = gx.createPipeline({
+				.topology = TopologyMode::TRIANGLE,
+				.polygon = PolygonMode::FILL,
+				.blend = BlendingMode::OFF,
+				.cull = CullMode::OFF,
+				.multisample = SampleCount::X1,
+				.formats = pickingFormats,
+				.shaderhandle = pickingShader.getHandle()
+		});
 
 		cubemapRes.loadResource(Filesystem::GetRelativePath("textures/hdri/qwantani_dusk_2_1k.hdr"));
 		cubemapRes.assignHandle(gx.createTexture({
@@ -1131,6 +1224,9 @@ namespace Slate {
 		spotlight.addComponent<TransformComponent>().global.position = glm::vec3{2.f, 4.f, -4.f};
 		spotlight.addComponent<SpotLightComponent>().spot.Color = glm::vec3{0.3f, 0.6f, 0.1f};
 
+		// all textures for startup exist now, build every pipeline in parallel instead of on first bind
+		gx.warmPipelines();
+
 		ImGui_ImplGlfw_InstallCallbacks(_window.getGLFWWindow());
 	}
 
@@ -1146,17 +1242,20 @@ namespace Slate {
 	void EditorApplication::onSwapchainResize() {
 		GX& gx = _gx;
 
-		gx.destroy(colorResolveImage);
-		gx.destroy(colorMSAAImage);
-		gx.destroy(entityResolveImage);
-		gx.destroy(entityMSAAImage);
-		gx.destroy(depthStencilMSAAImage);
-		gx.destroy(viewportImage);
-
+		DestroyEditorAttachments(gx, *this);
 		CreateEditorAttachments(gx, *this);
-		// recreate descriptor set for the viewport image used by imgui
+		this->_refreshViewportDescriptorSet();
+	}
+	void EditorApplication::_refreshViewportDescriptorSet() {
+		GX& gx = _gx;
+		if (_viewportImageDescriptorSet != VK_NULL_HANDLE) {
+			// frames in flight may still draw the old set
+			gx.deferredTask(std::packaged_task<void()>([descriptorSet = _viewportImageDescriptorSet]() {
+				ImGui_ImplVulkan_RemoveTexture(descriptorSet);
+			}));
+		}
 		auto [ sampler, image_view ] = gx.requestViewportImageData(viewportImage);
-		this->_viewportImageDescriptorSet = ImGui_ImplVulkan_AddTexture(sampler, image_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		_viewportImageDescriptorSet = ImGui_ImplVulkan_AddTexture(sampler, image_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 	}
 
 	void EditorApplication::onRender() {
@@ -1219,11 +1318,6 @@ namespace Slate {
 		{
 			CommandBuffer& cmd = gx.acquireCommand();
 			{
-				cmd.cmdTransitionLayout(colorMSAAImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-				cmd.cmdTransitionLayout(depthStencilMSAAImage, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-				cmd.cmdTransitionLayout(entityResolveImage, VK_IMAGE_LAYOUT_GENERAL);
-				cmd.cmdTransitionLayout(entityMSAAImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-
 				// you must update buffer before using it in push constants
 				const GPU::PerFrameData perframedata = {
 						.camera = cameraData,
@@ -1233,222 +1327,87 @@ namespace Slate {
 				};
 				cmd.cmdUpdateBuffer(gx._globalBufferHandle, perframedata);
 
-				RenderPass first = {
-						.color = {
-								RenderPass::ColorAttachmentDesc{
-										.texture = colorMSAAImage,
-										.loadOp = LoadOperation::CLEAR,
-										.storeOp = StoreOperation::STORE,
-										.clear = gx._clearColor
-								},
-								RenderPass::ColorAttachmentDesc{
-										.texture = entityMSAAImage,
-										.loadOp = LoadOperation::CLEAR,
-										.storeOp = StoreOperation::STORE,
-										.clear = RGBA{-1, 0, 0, 0}
-								}
-						},
-						.depth = {
-								.texture = depthStencilMSAAImage,
-								.loadOp = LoadOperation::CLEAR,
-								.storeOp = StoreOperation::STORE,
-								.clear = 1.f
-						}
-				};
-				RenderPass intermediate = {
-						.color = {
-								RenderPass::ColorAttachmentDesc{
-										.texture = colorMSAAImage,
-										.loadOp = LoadOperation::LOAD,
-										.storeOp = StoreOperation::STORE,
-								},
-								RenderPass::ColorAttachmentDesc{
-										.texture = entityMSAAImage,
-										.loadOp = LoadOperation::LOAD,
-										.storeOp = StoreOperation::STORE,
-								}
-						},
-						.depth = {
-								.texture = depthStencilMSAAImage,
-								.loadOp = LoadOperation::LOAD,
-								.storeOp = StoreOperation::STORE,
-						}
-				};
-				RenderPass last = {
-						.color = {
-								RenderPass::ColorAttachmentDesc{
-										.texture = colorMSAAImage,
-										.resolveTexture = colorResolveImage,
-										.loadOp = LoadOperation::LOAD,
-										.storeOp = StoreOperation::STORE,
-								},
-								RenderPass::ColorAttachmentDesc{
-										.texture = entityMSAAImage,
-										.resolveTexture = entityResolveImage,
-										.resolveMode = ResolveMode::SAMPLE_ZERO,
-										.loadOp = LoadOperation::LOAD,
-										.storeOp = StoreOperation::STORE,
-								}
-						},
-						.depth = {
-								.texture = depthStencilMSAAImage,
-								.loadOp = LoadOperation::LOAD,
-								.storeOp = StoreOperation::NO_CARE,
-						}
-				};
+				RenderPassBuilder first;
+				first.addColorAttachment(colorMSAAImage, LoadOperation::CLEAR, StoreOperation::STORE, gx._clearColor)
+						.addDepthStencilAttachment(depthStencilMSAAImage, LoadOperation::CLEAR, StoreOperation::STORE, 1.f);
+				RenderPassBuilder intermediate;
+				intermediate.addColorAttachment(colorMSAAImage, LoadOperation::LOAD, StoreOperation::STORE)
+						.addDepthStencilAttachment(depthStencilMSAAImage, LoadOperation::LOAD, StoreOperation::STORE);
+				RenderPassBuilder last;
+				last.addMultisampledColorAttachment(colorMSAAImage, colorResolveImage, LoadOperation::LOAD, StoreOperation::STORE)
+						.addDepthStencilAttachment(depthStencilMSAAImage, LoadOperation::LOAD, StoreOperation::NO_CARE);
 				// gui pass needs store op to be true!
-				RenderPass fullscreenPass = {
-						.color = {
-								RenderPass::ColorAttachmentDesc{
-										.texture = colorResolveImage,
-										.loadOp = LoadOperation::LOAD,
-										.storeOp = StoreOperation::STORE
-								}
-						}
-				};
-				RenderPass outlinePass = {
-						.color = {
-								RenderPass::ColorAttachmentDesc{
-										.texture = outlineImage,
-										.loadOp = LoadOperation::NO_CARE,
-										.storeOp = StoreOperation::STORE,
-										.clear = RGBA{0, 0, 0, 1}
-								}
-						}
-				};
-				RenderPass guiPass = {
-						.color = {
-								RenderPass::ColorAttachmentDesc{
-										.texture = colorResolveImage,
-										.loadOp = LoadOperation::NO_CARE,
-										.storeOp = StoreOperation::STORE
-								}
-						}
-				};
+				RenderPassBuilder fullscreenPass;
+				fullscreenPass.addColorAttachment(colorResolveImage, LoadOperation::LOAD, StoreOperation::STORE);
+				RenderPassBuilder outlinePass;
+				outlinePass.addColorAttachment(outlineImage, LoadOperation::NO_CARE, StoreOperation::STORE);
+				RenderPassBuilder guiPass;
+				guiPass.addColorAttachment(colorResolveImage, LoadOperation::NO_CARE, StoreOperation::STORE);
 
 				// same texture that must be submitted at the end of cmd buffer
 				InternalTextureHandle swapchainTexture = gx.acquireCurrentSwapchainTexture();
 
-				cmd.cmdBeginRendering(first);
-				if (_viewportMode == ViewportModes::SHADED || _viewportMode == ViewportModes::SOLID_WIREFRAME) {
-
-					// for shaded
-					cmd.cmdBindRenderPipeline(shadedModePipeline);
-					cmd.cmdBindDepthState({
-							.compareOp = CompareOperation::CompareOp_Less,
-							.isDepthWriteEnabled = true,
-					});
-					for (const GameEntity &entity: ctx.scene->GetAllEntitiesWithEXT<GeometryPrimitiveComponent>()) {
-						const MeshPrimitiveType type = entity.getComponent<GeometryPrimitiveComponent>().mesh_type;
-						if (type == MeshPrimitiveType::Empty) continue;
-						const MeshData &mesh = defaultMeshPrimitiveTypes[type];
-
-						GPU::PerObjectData constants = {
-								.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-								.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-								.id = (uint32_t) entity.getHandle(),
-						};
-						cmd.cmdPushConstants(constants);
-						cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-						cmd.cmdDrawIndexed(mesh.getIndexCount());
-					}
-					for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<GeometryGLTFComponent>()) {
-						const auto meshSource = _meshPool.get(entity.getComponent<GeometryGLTFComponent>().handle);
-						for (int k = 0; k < meshSource->getMeshCount(); k++) {
-							const MeshData& mesh = meshSource->getBuffers()[k];
-							GPU::PerObjectData constants = {
-									.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-									.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-									.id = (uint32_t) entity.getHandle(),
-							};
-							cmd.cmdPushConstants(constants);
-							cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-							cmd.cmdDrawIndexed(mesh.getIndexCount());
-						}
-					}
+				// gathered up front so picking can be recorded from any thread without touching the scene or gx
+				// the scene draw lists are filled from these too
+				sceneDraws.clear();
+				for (const GameEntity& entity: ctx.scene->GetAllEntitiesWithEXT<GeometryPrimitiveComponent>()) {
+					const MeshPrimitiveType type = entity.getComponent<GeometryPrimitiveComponent>().mesh_type;
+					if (type == MeshPrimitiveType::Empty) continue;
+					const MeshData& mesh = defaultMeshPrimitiveTypes.at(type);
+					sceneDraws.push_back({ TransformToModelMatrix(entity.getComponent<TransformComponent>()), &mesh, gx.meshVertexAddress(mesh), (uint32_t) entity.getHandle() });
 				}
-				if (_viewportMode == ViewportModes::SOLID_WIREFRAME || _viewportMode == ViewportModes::WIREFRAME) {
-					cmd.cmdBindRenderPipeline(wireframeModePipeline);
-					cmd.cmdBindDepthState({
-							.compareOp = CompareOperation::CompareOp_Less,
-							.isDepthWriteEnabled = true,
-					});
-					if (_viewportMode == ViewportModes::SOLID_WIREFRAME) {
-						cmd.cmdSetDepthBiasEnable(true);
-						cmd.cmdSetDepthBias(0.f, -1.f, 0.f);
+				for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<GeometryGLTFComponent>()) {
+					const auto meshSource = _meshPool.get(entity.getComponent<GeometryGLTFComponent>().handle);
+					const glm::mat4 model = TransformToModelMatrix(entity.getComponent<TransformComponent>());
+					for (int k = 0; k < meshSource->getMeshCount(); k++) {
+						const MeshData& mesh = meshSource->getBuffers()[k];
+						sceneDraws.push_back({ model, &mesh, gx.meshVertexAddress(mesh), (uint32_t) entity.getHandle() });
 					}
-
-					for (const GameEntity& entity: ctx.scene->GetAllEntitiesWithEXT<GeometryPrimitiveComponent>()) {
-						const MeshPrimitiveType type = entity.getComponent<GeometryPrimitiveComponent>().mesh_type;
-						if (type == MeshPrimitiveType::Empty) continue;
-						const MeshData &mesh = defaultMeshPrimitiveTypes[type];
-
-						GPU::PushConstants_EditorPrimitives constants = {
-								.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-								.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-								.color = {1, 0, 0}// we just keep red for now
-						};
-						cmd.cmdPushConstants(constants);
-						cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-						cmd.cmdDrawIndexed(mesh.getIndexCount());
+				}
+				// one multi-draw indirect call per pipeline for the whole scene, entities sharing a mesh become instances of one draw
+				// culled before the frame graph runs, dispatches can't be recorded inside the scene pass
+				const bool isShaded = _viewportMode == ViewportModes::SHADED || _viewportMode == ViewportModes::SOLID_WIREFRAME;
+				const bool isWireframe = _viewportMode == ViewportModes::SOLID_WIREFRAME || _viewportMode == ViewportModes::WIREFRAME;
+				const InternalPipelineHandle scenePipeline = isShaded ? shadedModePipeline : (_viewportMode == ViewportModes::UNSHADED ? unshadedModePipeline : InternalPipelineHandle{});
+				sceneDrawList->reset();
+				wireframeDrawList->reset();
+				for (const SceneDraw& draw : sceneDraws) {
+					if (scenePipeline.valid()) {
+						sceneDrawList->add(scenePipeline, *draw.mesh, draw.model, draw.id);
 					}
-					for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<GeometryGLTFComponent>()) {
-						const auto meshSource = _meshPool.get(entity.getComponent<GeometryGLTFComponent>().handle);
-						for (int k = 0; k < meshSource->getMeshCount(); k++) {
-							const MeshData& mesh = meshSource->getBuffers()[k];
-							GPU::PushConstants_EditorPrimitives constants = {
-									.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-									.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-									.color = {1, 0, 0}// we just keep red for now
-							};
-							cmd.cmdPushConstants(constants);
-							cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-							cmd.cmdDrawIndexed(mesh.getIndexCount());
-						}
+					if (isWireframe) {
+						wireframeDrawList->add(wireframeModePipeline, *draw.mesh, draw.model, draw.id);
 					}
 				}
-				if (_viewportMode == ViewportModes::UNSHADED) {
-					cmd.cmdBindRenderPipeline(unshadedModePipeline);
+				sceneDrawList->upload();
+				wireframeDrawList->upload();
+				sceneDrawList->cull(cmd);
+				wireframeDrawList->cull(cmd);
+
+				// passes only say what they touch, the graph orders them and places the transitions
+				frameGraph->reset();
+				frameGraph->addPass("Scene").setRenderPass(first).setExecute([&](CommandBuffer& cmd) {
 					cmd.cmdBindDepthState({
 							.compareOp = CompareOperation::CompareOp_Less,
 							.isDepthWriteEnabled = true,
 					});
-					for (const GameEntity& entity: ctx.scene->GetAllEntitiesWithEXT<GeometryPrimitiveComponent>()) {
-						const MeshPrimitiveType type = entity.getComponent<GeometryPrimitiveComponent>().mesh_type;
-						if (type == MeshPrimitiveType::Empty) continue;
-						const MeshData &mesh = defaultMeshPrimitiveTypes[type];
-
-						GPU::PushConstants_EditorSolidShading constants = {
-								.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-								.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-								.color = glm::vec3{0.4f}, // gray
-								.id = (uint32_t) entity.getHandle()
-						};
-						cmd.cmdPushConstants(constants);
-						cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-						cmd.cmdDrawIndexed(mesh.getIndexCount());
+					if (_viewportMode == ViewportModes::UNSHADED) {
+						const glm::vec3 color = glm::vec3{0.4f}; // gray
+						sceneDrawList->submit(cmd, &color, sizeof(color));
+					} else {
+						sceneDrawList->submit(cmd);
 					}
-					for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<GeometryGLTFComponent>()) {
-						const auto meshSource = _meshPool.get(entity.getComponent<GeometryGLTFComponent>().handle);
-						for (int k = 0; k < meshSource->getMeshCount(); k++) {
-							const MeshData& mesh = meshSource->getBuffers()[k];
-							GPU::PushConstants_EditorSolidShading constants = {
-									.modelMatrix = TransformToModelMatrix(entity.getComponent<TransformComponent>()),
-									.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-									.color = glm::vec3{0.4f}, // gray
-									.id = (uint32_t) entity.getHandle()
-							};
-							cmd.cmdPushConstants(constants);
-							cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-							cmd.cmdDrawIndexed(mesh.getIndexCount());
+					if (isWireframe) {
+						if (_viewportMode == ViewportModes::SOLID_WIREFRAME) {
+							cmd.cmdSetDepthBiasEnable(true);
+							cmd.cmdSetDepthBias(0.f, -1.f, 0.f);
 						}
+						const glm::vec3 color = {1, 0, 0}; // we just keep red for now
+						wireframeDrawList->submit(cmd, &color, sizeof(color));
 					}
-				}
-				cmd.cmdEndRendering();
-
+				});
 				if (_gridEnabled) {
-					cmd.cmdBeginRendering(intermediate);
-					{
+					frameGraph->addPass("Grid").setRenderPass(intermediate).setExecute([&](CommandBuffer& cmd) {
 						cmd.cmdBindRenderPipeline(gridShaderPipeline);
 						cmd.cmdBindDepthState({
 								.compareOp = CompareOperation::CompareOp_Less,
@@ -1457,10 +1416,8 @@ namespace Slate {
 						cmd.cmdSetDepthBiasEnable(true);
 						cmd.cmdSetDepthBias(0.f, -1.f, 0.f);
 						cmd.cmdDraw(6);
-					}
-					cmd.cmdEndRendering();
-					cmd.cmdBeginRendering(intermediate);
-					{
+					});
+					frameGraph->addPass("Editor Wireframes").setRenderPass(intermediate).setExecute([&](CommandBuffer& cmd) {
 						// WIREFRAME EDITOR RENDERING //
 						{
 							cmd.cmdBindRenderPipeline(wireframeVisualizerPipeline);
@@ -1475,10 +1432,10 @@ namespace Slate {
 
 								GPU::PushConstants_EditorPrimitives constants = {
 										.modelMatrix = spheremodel,
-										.vertexBufferAddress = gx.gpuAddress(simplespheremesh.getVertexBufferHandle()),
+										.vertexBufferAddress = gx.meshVertexAddress(simplespheremesh),
 								};
 								cmd.cmdPushConstants(constants);
-								cmd.cmdDraw(simplespheremesh.getVertexCount());
+								cmd.cmdDrawMesh(simplespheremesh);
 							}
 							// SPOT LIGHTS
 							for (const GameEntity &entity: ctx.scene->GetAllEntitiesWithEXT<SpotLightComponent>()) {
@@ -1491,27 +1448,24 @@ namespace Slate {
 
 								GPU::PushConstants_EditorPrimitives constants = {
 										.modelMatrix = spotmodel,
-										.vertexBufferAddress = gx.gpuAddress(spotmesh.getVertexBufferHandle()),
+										.vertexBufferAddress = gx.meshVertexAddress(spotmesh),
 								};
 								cmd.cmdPushConstants(constants);
-								cmd.cmdDraw(spotmesh.getVertexCount());
+								cmd.cmdDrawMesh(spotmesh);
 							}
 							// DIRECTIONAL LIGHTS
 							for (const GameEntity &entity: ctx.scene->GetAllEntitiesWithEXT<DirectionalLightComponent>()) {
 								glm::mat4 model = TransformToModelMatrix(entity.getComponent<TransformComponent>(), false);
 								GPU::PushConstants_EditorPrimitives constants = {
 										.modelMatrix = model,
-										.vertexBufferAddress = gx.gpuAddress(arrowmesh.getVertexBufferHandle()),
+										.vertexBufferAddress = gx.meshVertexAddress(arrowmesh),
 								};
 								cmd.cmdPushConstants(constants);
-								cmd.cmdDraw(arrowmesh.getVertexCount());
+								cmd.cmdDrawMesh(arrowmesh);
 							}
 						}
-					}
-					cmd.cmdEndRendering();
-
-					cmd.cmdBeginRendering(last);
-					{
+					});
+					frameGraph->addPass("Editor Billboards").setRenderPass(last).setExecute([&](CommandBuffer& cmd) {
 						// FILLED EDITOR RENDERING //
 						{
 							cmd.cmdBindRenderPipeline(filledVisualizerPipeline);
@@ -1520,7 +1474,6 @@ namespace Slate {
 									.isDepthWriteEnabled = true,
 							});
 							const MeshData &quad_mesh_ref = defaultMeshPrimitiveTypes[MeshPrimitiveType::Quad];
-							cmd.cmdBindIndexBuffer(quad_mesh_ref.getIndexBufferHandle());// because we just use the same quad mesh, we can bind once at the beginning
 							// POINT LIGHTS
 							for (const GameEntity &entity: ctx.scene->GetAllEntitiesWithEXT<PointLightComponent>()) {
 								glm::mat4 model = TransformToModelMatrix(entity.getComponent<TransformComponent>(), false, false);
@@ -1530,11 +1483,11 @@ namespace Slate {
 								GPU::PushConstants_EditorImages constants = {
 										.modelMatrix = model,
 										.color = entity.getComponent<PointLightComponent>().point.Color,
-										.vertexBufferAddress = gx.gpuAddress(quad_mesh_ref.getVertexBufferHandle()),
+										.vertexBufferAddress = gx.meshVertexAddress(quad_mesh_ref),
 										.id = (uint32_t) entity.getHandle(),
 										.textureId = lightbulbTexture.getHandle().index()};
 								cmd.cmdPushConstants(constants);
-								cmd.cmdDrawIndexed(quad_mesh_ref.getIndexCount());
+								cmd.cmdDrawMesh(quad_mesh_ref);
 							}
 							// SPOT LIGHTS
 							for (const GameEntity &entity: ctx.scene->GetAllEntitiesWithEXT<SpotLightComponent>()) {
@@ -1545,11 +1498,11 @@ namespace Slate {
 								GPU::PushConstants_EditorImages constants = {
 										.modelMatrix = model,
 										.color = entity.getComponent<SpotLightComponent>().spot.Color,
-										.vertexBufferAddress = gx.gpuAddress(quad_mesh_ref.getVertexBufferHandle()),
+										.vertexBufferAddress = gx.meshVertexAddress(quad_mesh_ref),
 										.id = (uint32_t) entity.getHandle(),
 										.textureId = spotlightTexture.getHandle().index()};
 								cmd.cmdPushConstants(constants);
-								cmd.cmdDrawIndexed(quad_mesh_ref.getIndexCount());
+								cmd.cmdDrawMesh(quad_mesh_ref);
 							}
 							// DIRECTIONAL LIGHTS
 							for (const GameEntity &entity: ctx.scene->GetAllEntitiesWithEXT<DirectionalLightComponent>()) {
@@ -1560,104 +1513,210 @@ namespace Slate {
 								GPU::PushConstants_EditorImages constants = {
 										.modelMatrix = model,
 										.color = entity.getComponent<DirectionalLightComponent>().directional.Color,
-										.vertexBufferAddress = gx.gpuAddress(quad_mesh_ref.getVertexBufferHandle()),
+										.vertexBufferAddress = gx.meshVertexAddress(quad_mesh_ref),
 										.id = (uint32_t) entity.getHandle(),
 										.textureId = sunTexture.getHandle().index()};
 								cmd.cmdPushConstants(constants);
-								cmd.cmdDrawIndexed(quad_mesh_ref.getIndexCount());
+								cmd.cmdDrawMesh(quad_mesh_ref);
 							}
 						}
-					}
-					cmd.cmdEndRendering();
+					});
 				} else {
-					cmd.cmdBeginRendering(last);
-					cmd.cmdEndRendering();
+					// still need the msaa resolve
+					frameGraph->addPass("Resolve").setRenderPass(last);
 				}
 
-				// render to outline image to be sampled in the next step
-				cmd.cmdTransitionLayout(outlineImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-				cmd.cmdBeginRendering(outlinePass);
-				if (ctx.activeEntity.has_value()) {
-					const GameEntity activeEntity = ctx.activeEntity.value();
-					cmd.cmdBindRenderPipeline(pureOutlinePipeline);
-					{
-						if (activeEntity.hasComponent<GeometryPrimitiveComponent>()) {
-							const MeshPrimitiveType type = activeEntity.getComponent<GeometryPrimitiveComponent>().mesh_type;
-							if (type != MeshPrimitiveType::Empty) {
-								const MeshData& mesh = defaultMeshPrimitiveTypes[type];
-								struct P {
-									glm::mat4 modelMatrix;
-									VkDeviceAddress vertexBufferAddress;
-								} constants {
-										.modelMatrix = TransformToModelMatrix(activeEntity.getComponent<TransformComponent>()),
-										.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-								};
-								cmd.cmdPushConstants(constants);
-								cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-								cmd.cmdDrawIndexed(mesh.getIndexCount());
-							}
+				// entity ids are only rendered on frames a pick was asked for, and only inside the queried region
+				const Optional<PickQuery> pick = std::exchange(_pendingPick, std::nullopt);
+				if (pick.has_value()) {
+					RenderPassBuilder pickingPass;
+					pickingPass.addColorAttachment(entityIdImage, LoadOperation::CLEAR, StoreOperation::STORE, RGBA{-1, 0, 0, 0})
+							.addDepthStencilAttachment(entityDepthImage, LoadOperation::CLEAR, StoreOperation::NO_CARE, 1.f);
+					// the scene is only walked on the render thread, workers just read these and sceneDraws
+					// light billboards are picked as whole quads
+					pickBillboards.clear();
+					if (_gridEnabled) {
+						const MeshData& quad_mesh_ref = defaultMeshPrimitiveTypes[MeshPrimitiveType::Quad];
+						const auto addBillboard = [&](const GameEntity& entity) {
+							glm::mat4 model = TransformToModelMatrix(entity.getComponent<TransformComponent>(), false, false);
+							model = BillboardModelMatrix(model, _camera);
+							pickBillboards.push_back({
+									.modelMatrix = glm::scale(model, glm::vec3{0.5}),
+									.vertexBufferAddress = gx.meshVertexAddress(quad_mesh_ref),
+									.id = (uint32_t) entity.getHandle(),
+							});
+						};
+						for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<PointLightComponent>()) addBillboard(entity);
+						for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<SpotLightComponent>()) addBillboard(entity);
+						for (const GameEntity& entity : ctx.scene->GetAllEntitiesWithEXT<DirectionalLightComponent>()) addBillboard(entity);
+					}
+					const auto recordPicking = [&](CommandBuffer& cmd, std::span<const SceneDraw> draws, bool withBillboards) {
+						cmd.cmdSetScissor(pick->region);
+						cmd.cmdBindRenderPipeline(pickingPipeline);
+						cmd.cmdBindDepthState({
+								.compareOp = CompareOperation::CompareOp_Less,
+								.isDepthWriteEnabled = true,
+						});
+						for (const SceneDraw& draw : draws) {
+							const GPU::PerObjectData constants = {
+									.modelMatrix = draw.model,
+									.vertexBufferAddress = draw.vertexBufferAddress,
+									.id = draw.id,
+							};
+							cmd.cmdPushConstants(constants);
+							cmd.cmdDrawMesh(*draw.mesh);
 						}
-						if (activeEntity.hasComponent<GeometryGLTFComponent>()) {
-							const auto meshSource = _meshPool.get(activeEntity.getComponent<GeometryGLTFComponent>().handle);
-							for (int k = 0; k < meshSource->getMeshCount(); k++) {
-								const MeshData& mesh = meshSource->getBuffers()[k];
-								struct P {
-									glm::mat4 modelMatrix;
-									VkDeviceAddress vertexBufferAddress;
-								} constants {
-										.modelMatrix = TransformToModelMatrix(activeEntity.getComponent<TransformComponent>()),
-										.vertexBufferAddress = gx.gpuAddress(mesh.getVertexBufferHandle()),
-								};
+						if (withBillboards) {
+							for (const GPU::PerObjectData& constants : pickBillboards) {
 								cmd.cmdPushConstants(constants);
-								cmd.cmdBindIndexBuffer(mesh.getIndexBufferHandle());
-								cmd.cmdDrawIndexed(mesh.getIndexCount());
+								cmd.cmdDrawMesh(defaultMeshPrimitiveTypes.at(MeshPrimitiveType::Quad));
 							}
 						}
-					}
-				}
-				cmd.cmdEndRendering();
-				cmd.cmdTransitionLayout(outlineImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-				cmd.cmdBlitImage(colorResolveImage, viewportImage);
-				cmd.cmdTransitionLayout(colorResolveImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-				cmd.cmdTransitionLayout(viewportImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-
-				// fullscreen shader test
-				cmd.cmdBeginRendering(fullscreenPass);
-				{
-					cmd.cmdBindRenderPipeline(fullscreenPipeline);
-					struct P {
-						uint32_t imageTexId;
-						uint32_t maskTexId;
-					} push {
-							.imageTexId = viewportImage.index(),
-							.maskTexId = outlineImage.index()
 					};
-					cmd.cmdPushConstants(push);
-					cmd.cmdDraw(3);
+					// the scene pass is a handful of indirect calls, picking still draws entity by entity so this is where recording threads pay off
+					const bool isParallel = sceneDraws.size() >= kParallelPickDrawThreshold && parallelRecorder->getNumThreads() > 1;
+					frameGraph->addPass("Picking").setRenderPass(pickingPass, isParallel ? RenderingContents::Secondary : RenderingContents::Inline).setExecute([&, recordPicking](CommandBuffer& cmd) {
+						if (isParallel) {
+							// slices executed in task order so the result matches the serial path, the billboards go last
+							const uint32_t numTasks = ((uint32_t) sceneDraws.size() + kPickDrawsPerTask - 1) / kPickDrawsPerTask;
+							parallelRecorder->record(cmd, numTasks, [&](CommandBuffer& secondary, uint32_t task) {
+								const uint32_t begin = task * kPickDrawsPerTask;
+								const std::span<const SceneDraw> draws = std::span<const SceneDraw>(sceneDraws).subspan(begin, std::min<size_t>(kPickDrawsPerTask, sceneDraws.size() - begin));
+								recordPicking(secondary, draws, task == numTasks - 1);
+							});
+							return;
+						}
+						recordPicking(cmd, sceneDraws, true);
+					});
+					// read back once the frame is submitted
+					frameGraph->markOutput(entityIdImage);
 				}
-				cmd.cmdEndRendering();
 
+				// render to outline image to be sampled in the composite
+				frameGraph->addPass("Selection Outline").setRenderPass(outlinePass).setExecute([&](CommandBuffer& cmd) {
+					// the marquee selection only counts while the active entity is part of it, picking elsewhere replaces it
+					std::vector<entt::entity> outlined;
+					if (ctx.activeEntity.has_value()) {
+						const entt::entity activeHandle = ctx.activeEntity.value().getHandle();
+						if (std::find(ctx.selectedHandles.begin(), ctx.selectedHandles.end(), activeHandle) != ctx.selectedHandles.end()) {
+							outlined = ctx.selectedHandles;
+						} else {
+							outlined.push_back(activeHandle);
+						}
+					}
+					if (!outlined.empty()) {
+						cmd.cmdBindRenderPipeline(pureOutlinePipeline);
+					}
+					for (const entt::entity handle : outlined) {
+						if (!ctx.scene->isValidEntity(handle)) continue;
+						const GameEntity activeEntity = ctx.scene->resolveEntity(handle);
+						{
+							if (activeEntity.hasComponent<GeometryPrimitiveComponent>()) {
+								const MeshPrimitiveType type = activeEntity.getComponent<GeometryPrimitiveComponent>().mesh_type;
+								if (type != MeshPrimitiveType::Empty) {
+									const MeshData& mesh = defaultMeshPrimitiveTypes[type];
+									struct P {
+										glm::mat4 modelMatrix;
+										VkDeviceAddress vertexBufferAddress;
+									} constants {
+											.modelMatrix = TransformToModelMatrix(activeEntity.getComponent<TransformComponent>()),
+											.vertexBufferAddress = gx.meshVertexAddress(mesh),
+									};
+									cmd.cmdPushConstants(constants);
+									cmd.cmdDrawMesh(mesh);
+								}
+							}
+							if (activeEntity.hasComponent<GeometryGLTFComponent>()) {
+								const auto meshSource = _meshPool.get(activeEntity.getComponent<GeometryGLTFComponent>().handle);
+								for (int k = 0; k < meshSource->getMeshCount(); k++) {
+									const MeshData& mesh = meshSource->getBuffers()[k];
+									struct P {
+										glm::mat4 modelMatrix;
+										VkDeviceAddress vertexBufferAddress;
+									} constants {
+											.modelMatrix = TransformToModelMatrix(activeEntity.getComponent<TransformComponent>()),
+											.vertexBufferAddress = gx.meshVertexAddress(mesh),
+									};
+									cmd.cmdPushConstants(constants);
+									cmd.cmdDrawMesh(mesh);
+								}
+							}
+						}
+					}
+				});
+				frameGraph->addPass("Copy Viewport")
+						.read(colorResolveImage, TextureAccess::TransferSrc)
+						.write(viewportImage, TextureAccess::TransferDst)
+						.setExecute([&](CommandBuffer& cmd) { cmd.cmdBlitImage(colorResolveImage, viewportImage); });
+				// fullscreen shader test
+				frameGraph->addPass("Outline Composite").setRenderPass(fullscreenPass)
+						.read(viewportImage)
+						.read(outlineImage)
+						.setExecute([&](CommandBuffer& cmd) {
+							cmd.cmdBindRenderPipeline(fullscreenPipeline);
+							struct P {
+								uint32_t imageTexId;
+								uint32_t maskTexId;
+							} push {
+									.imageTexId = viewportImage.index(),
+									.maskTexId = outlineImage.index()
+							};
+							cmd.cmdPushConstants(push);
+							cmd.cmdDraw(3);
+						});
+				frameGraph->addPass("Copy Composited Viewport")
+						.read(colorResolveImage, TextureAccess::TransferSrc)
+						.write(viewportImage, TextureAccess::TransferDst)
+						.setExecute([&](CommandBuffer& cmd) { cmd.cmdBlitImage(colorResolveImage, viewportImage); });
+				// render ui
+				frameGraph->addPass("ImGui").setRenderPass(guiPass)
+						.read(viewportImage)
+						.setExecute([&](CommandBuffer& cmd) { ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd.requestVkCmdBuffer()); });
+				// close out
+				frameGraph->addPass("Present")
+						.read(colorResolveImage, TextureAccess::TransferSrc)
+						.setSideEffect()
+						.setExecute([&](CommandBuffer& cmd) {
+							cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+							cmd.cmdBlitToSwapchain(colorResolveImage);
+							cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+						});
+				frameGraph->markTransient(colorMSAAImage);
+				frameGraph->markTransient(depthStencilMSAAImage);
+				frameGraph->markTransient(outlineImage);
+				frameGraph->markTransient(viewportImage);
 
-				cmd.cmdBlitImage(colorResolveImage, viewportImage);
-				cmd.cmdTransitionLayout(viewportImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-				cmd.cmdTransitionLayout(colorResolveImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+				frameGraph->compile();
+				frameGraph->execute(cmd);
 
+				gx.submitCommand(cmd, swapchainTexture);
 
-				// render ui
-				{
-					cmd.cmdBeginRendering(guiPass);
-					ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd.requestVkCmdBuffer());
-					cmd.cmdEndRendering();
+				if (pick.has_value()) {
+					// requested after the submit so the copy lands behind the picking pass, the frame never waits on it
+					const PickQuery query = pick.value();
+					const ReadbackToken token = gx.requestDownload(entityIdImage, TexRange{
+							.offset = {query.region.offset.x, query.region.offset.y, 0},
+							.dimensions = {query.region.extent.width, query.region.extent.height, 1}
+					}, [this, query](std::span<const uint8_t> data) {
+						_numPicksInFlight--;
+						_onPickResult(query, std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(data.data()), data.size() / sizeof(uint32_t)));
+					});
+					if (!token.empty()) {
+						_numPicksInFlight++;
+					}
 				}
-				// close out
-				cmd.cmdTransitionLayout(colorResolveImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-				cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-				cmd.cmdBlitToSwapchain(colorResolveImage);
-				cmd.cmdTransitionSwapchainLayout(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
-				gx.submitCommand(cmd, swapchainTexture);
+				std::vector<std::vector<InternalTextureHandle>> aliasGroups = frameGraph->computeAliasGroups();
+				// other passes may run from frame to frame, textures sharing memory could then be alive at the same time
+				// groups that did not change keep their memory, only the members of changed ones are moved
+				if (attachmentsNeedAliasing || aliasGroups != attachmentAliasGroups) {
+					gx.aliasTextures(aliasGroups);
+					attachmentAliasGroups = std::move(aliasGroups);
+					attachmentsNeedAliasing = false;
+					// aliasing recreates the images, imgui holds on to the old view
+					this->_refreshViewportDescriptorSet();
+					LogAttachmentMemory(gx, *this);
+				}
 			}
 		}
 	}
@@ -1668,10 +1727,10 @@ namespace Slate {
 		gx.destroy(this->colorResolveImage);
 		gx.destroy(this->colorMSAAImage);
 		gx.destroy(this->depthStencilMSAAImage);
-		gx.destroy(this->entityMSAAImage);
-		gx.destroy(this->entityResolveImage);
+		gx.destroy(this->entityIdImage);
+		gx.destroy(this->entityDepthImage);
+		gx.destroy(this->outlineImage);
 		gx.destroy(this->viewportImage);
-		gx.destroy(this->_stagbuf);
 
 		gx.destroy(standardShader.getHandle());
 		gx.destroy(primitiveShader.getHandle());
@@ -1680,20 +1739,26 @@ namespace Slate {
 		gx.destroy(shadedModePipeline);
 		gx.destroy(wireframeVisualizerPipeline);
 		gx.destroy(filledVisualizerPipeline);
-
-
-		gx.destroy(quadMeshData.getVertexBufferHandle());
-		gx.destroy(quadMeshData.getIndexBufferHandle());
-		gx.destroy(planeMeshData.getVertexBufferHandle());
-		gx.destroy(planeMeshData.getIndexBufferHandle());
-		gx.destroy(cubeMeshData.getVertexBufferHandle());
-		gx.destroy(cubeMeshData.getIndexBufferHandle());
-		gx.destroy(sphereMeshData.getVertexBufferHandle());
-		gx.destroy(sphereMeshData.getIndexBufferHandle());
-
-		gx.destroy(arrowmesh.getVertexBufferHandle());
-		gx.destroy(simplespheremesh.getVertexBufferHandle());
-		gx.destroy(spotmesh.getVertexBufferHandle());
+		gx.destroy(pickingPipeline);
+		gx.destroy(pickingShader.getHandle());
+		gx.destroy(cullInstancesPipeline);
+		gx.destroy(compactDrawsPipeline);
+		gx.destroy(frustumCullShader.getHandle());
+		gx.destroy(primitiveIndirectShader.getHandle());
+		sceneDrawList.reset(nullptr);
+		wireframeDrawList.reset(nullptr);
+		frameGraph.reset(nullptr);
+		parallelRecorder.reset(nullptr);
+
+
+		gx.destroy(quadMeshData);
+		gx.destroy(planeMeshData);
+		gx.destroy(cubeMeshData);
+		gx.destroy(sphereMeshData);
+
+		gx.destroy(arrowmesh);
+		gx.destroy(simplespheremesh);
+		gx.destroy(spotmesh);
 
 		gx.destroy(lightbulbTexture.getHandle());
 		gx.destroy(spotlightTexture.getHandle());
@@ -1702,6 +1767,8 @@ namespace Slate {
 		NFD_Quit();
 		// got to call this prior to imgui shutdown
 		Application::getGX().deviceWaitIdle();
+		// old viewport descriptor sets are released by deferred tasks
+		Application::getGX().waitDeferredTasks();
 		// this order specifically
 		ImGui_ImplVulkan_RemoveTexture(_viewportImageDescriptorSet);
 		ImGui_ImplVulkan_Shutdown();
@@ -1805,11 +1872,52 @@ namespace Slate {
 				// should be the same if everything is correct
 				ImGui::Text("Slate Delta Time: %.2f", this->getTime().getDeltaTime());
 				ImGui::Text("ImGui Delta Time: %.2f", io.DeltaTime);
-//				if (this->ctx.hoveredEntity.has_value()) {
-//					GameEntity hovered_entity = this->ctx.hoveredEntity.value();
-//					ImGui::Text("Hovered Entity: %s | %u", hovered_entity.getName().c_str(), static_cast<int>(hovered_entity.getHandle()));
-//				}
-//				else ImGui::Text("Hovered Entity: 'NONE'");
+				const CommandStats& cmdStats = getGX().getLastCommandStats();
+				ImGui::Text("Draw Calls: %u, Dispatches: %u", cmdStats.draws, cmdStats.dispatches);
+				ImGui::Text("State Commands Issued / Filtered: %u / %u", cmdStats.getTotalIssued(), cmdStats.getTotalFiltered());
+				ImGui::Text("Barriers: %u in %u batches (%u folded)", cmdStats.barriers, cmdStats.barrierBatches, cmdStats.barriersFolded);
+				const FrameGraphStats& graphStats = frameGraph->getStats();
+				ImGui::Text("Frame Graph Passes: %u (%u culled)", graphStats.declaredPasses, graphStats.culledPasses);
+				ImGui::Text("Frame Graph Barriers: %u images, %u buffers in %u batches", graphStats.imageBarriers, graphStats.bufferBarriers, graphStats.barrierBatches);
+				const TransientMemoryStats& memoryStats = getGX().getTransientMemoryStats();
+				ImGui::Text("Aliased Attachments: %u in %u allocations, %.1f MB -> %.1f MB", memoryStats.numAliasedTextures, memoryStats.numAliasGroups,
+							(double)memoryStats.aliasedRequestedBytes / (1024.0 * 1024.0), (double)memoryStats.aliasedCommittedBytes / (1024.0 * 1024.0));
+				ImGui::Text("Lazily Allocated Attachments: %.1f MB", (double)memoryStats.lazilyAllocatedBytes / (1024.0 * 1024.0));
+				ImGui::Text("Picking Recording Threads: %u (parallel above %u draws)", parallelRecorder->getNumThreads(), kParallelPickDrawThreshold);
+				ImGui::Text("Upload Stalls: %u", getGX().getNumUploadStalls());
+				ImGui::Text("Picks In Flight: %u", _numPicksInFlight);
+				if (getGX().isGPUProfilingSupported() && ImGui::CollapsingHeader("GPU Timings")) {
+					bool isProfiling = getGX().isGPUProfiling();
+					if (ImGui::Checkbox("Enabled", &isProfiling)) {
+						getGX().setGPUProfiling(isProfiling);
+					}
+					ImGui::SameLine();
+					if (ImGui::Button("Save To File")) {
+						getGX().saveGPUTimings("gpu_timings.csv");
+					}
+					const GPUFrameTimings& timings = getGX().getGPUFrameTimings();
+					ImGui::Text("Frame %llu: %.3f ms", (unsigned long long)timings.frameNum, timings.milliseconds);
+					if (ImGui::BeginTable("gpu-timings", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit)) {
+						ImGui::TableSetupColumn("Scope");
+						ImGui::TableSetupColumn("ms");
+						ImGui::TableSetupColumn("Vertices");
+						ImGui::TableSetupColumn("Fragments");
+						ImGui::TableHeadersRow();
+						for (const GPUScopeTiming& scope : timings.scopes) {
+							ImGui::TableNextRow();
+							ImGui::TableNextColumn();
+							ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (float)scope.depth * ImGui::GetStyle().IndentSpacing);
+							ImGui::TextUnformatted(scope.name.c_str());
+							ImGui::TableNextColumn();
+							ImGui::Text("%.3f", scope.milliseconds);
+							ImGui::TableNextColumn();
+							if (scope.hasStatistics) ImGui::Text("%llu", (unsigned long long)scope.vertexInvocations);
+							ImGui::TableNextColumn();
+							if (scope.hasStatistics) ImGui::Text("%llu", (unsigned long long)scope.fragmentInvocations);
+						}
+						ImGui::EndTable();
+					}
+				}
 				ImGui::End();
 			}
 			ImGui::End();// last end statement, dont put more imgui calls after this
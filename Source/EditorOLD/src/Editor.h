@@ -19,6 +19,9 @@
 #include <imgui.h>
 #include <ImGuizmo.h>
 
+#include <span>
+#include <vector>
+
 namespace Slate {
 
 	enum struct ViewportModes : char {
@@ -37,7 +40,8 @@ namespace Slate {
 	struct Context
 	{
 		Optional<GameEntity> activeEntity = std::nullopt;
-		Optional<GameEntity> hoveredEntity = std::nullopt;
+		// marquee selection, only shown while activeEntity is still part of it
+		std::vector<entt::entity> selectedHandles;
 		Scene* scene;
 	};
 
@@ -64,23 +68,31 @@ namespace Slate {
 		void _settingsUpdate();
 
 		void _createVisualizerMeshes();
+		// imgui keeps its own descriptor set for the viewport image, redo it whenever the image changes
+		void _refreshViewportDescriptorSet();
 
 		bool IsMouseInViewportBounds();
+		// entity ids are only rendered when something asks for them, the answer comes back a frame or two later
+		struct PickQuery {
+			VkRect2D region = {}; // in entity image pixels
+			bool isMarquee = false;
+			bool isDoubleClick = false;
+		};
+		glm::ivec2 _viewportToImagePixel(glm::vec2 mousePosition);
+		void _onPickResult(const PickQuery& query, std::span<const uint32_t> ids);
 		void InitImGui(ImGuiRequiredData req, GLFWwindow* glfwWindow, VkFormat format);
 	public:
 		InternalTextureHandle colorResolveImage;
 		InternalTextureHandle colorMSAAImage;
 		InternalTextureHandle depthStencilMSAAImage;
-		InternalTextureHandle entityResolveImage;
-		InternalTextureHandle entityMSAAImage;
+		InternalTextureHandle entityIdImage;
+		InternalTextureHandle entityDepthImage;
 		InternalTextureHandle viewportImage;
 		InternalTextureHandle outlineImage;
 
 		VkDescriptorSet _fileImageDS;
 		VkDescriptorSet _folderImageDS;
 
-		InternalBufferHandle _stagbuf;
-
 		MeshData arrowmesh;
 		MeshData simplespheremesh;
 		MeshData spotmesh;
@@ -115,6 +127,12 @@ namespace Slate {
 		bool _gridEnabled = true;
 		glm::vec2 _viewportBounds[2]{};
 
+		Optional<PickQuery> _pendingPick = std::nullopt; // rendered with the next frame
+		uint32_t _numPicksInFlight = 0;
+		glm::vec2 _marqueeStart{};
+		bool _isMarqueeActive = false;
+		bool _isMarqueeDoubleClick = false;
+
 
 		VkDescriptorSet _viewportImageDescriptorSet = VK_NULL_HANDLE;
 		VkDescriptorPool _imguiDescriptorPool = VK_NULL_HANDLE;
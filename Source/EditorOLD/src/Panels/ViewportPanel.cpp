@@ -2,6 +2,8 @@
 // Created by Hayden Rivas on 1/16/25.
 //
 
+#include <algorithm>
+
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
@@ -43,53 +45,47 @@ namespace Slate {
 		}
 	}
 
-	void EditorApplication::_onViewportPanelUpdate() {
-		// yes all of these checks are required
-		// isCameraControlActive: Requires user to not be in fly mode to select
-		// ImGui::IsItemHovered(): Requires user to be hovering item, works in tandem with the next check
-		// IsMouseInViewportBounds(): Requires the mouse position is actually inside the viewport
-		// TODO: move into main input function and make sure color picking isnt on
-		if (!_isCameraControlActive && ImGui::IsItemHovered() && IsMouseInViewportBounds()) {
-			auto [ mouseX, mouseY ] = GetInput().GetMousePosition();
-
-			float xrel = ((float)mouseX - _viewportBounds[0].x) / _viewportSize.x;
-			float yrel = ((float)mouseY - _viewportBounds[0].y) / _viewportSize.y;
-
-			auto offsetX = static_cast<int32_t>((float) getGX().getSwapchainExtent().width * xrel);
-			auto offsetY = static_cast<int32_t>((float) getGX().getSwapchainExtent().height * yrel);
-
-			VkImageSubresourceLayers layer = {};
-			layer.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			layer.baseArrayLayer = 0;
-			layer.layerCount = 1;
-			layer.mipLevel = 0;
-
-			VkBufferImageCopy region = {};
-			region.bufferOffset = 0;
-			int pack = 1;
-			region.bufferImageHeight = pack;
-			region.bufferRowLength = pack;
-			region.imageOffset = { offsetX, offsetY, 0 };
-			region.imageExtent = { 1, 1, 1 };
-			region.imageSubresource = layer;
-
-			GX& gx = this->getGX();
-			CommandBuffer& copycmd = gx.acquireCommand();
-			{
-				copycmd.cmdCopyImageToBuffer(entityResolveImage, _stagbuf, region);
-			}
-			gx.submitCommand(copycmd);
+	glm::ivec2 EditorApplication::_viewportToImagePixel(glm::vec2 mousePosition) {
+		const VkExtent2D extent = getGX().getSwapchainExtent();
+		const glm::vec2 rel = (mousePosition - _viewportBounds[0]) / _viewportSize;
+		const glm::ivec2 pixel = { (int32_t)((float)extent.width * rel.x), (int32_t)((float)extent.height * rel.y) };
+		return glm::clamp(pixel, glm::ivec2(0), glm::ivec2((int32_t)extent.width - 1, (int32_t)extent.height - 1));
+	}
 
-			int32_t data = *reinterpret_cast<int32_t*>(gx.getAllocatedBuffer(_stagbuf)->getMappedPtr());
-			if (data >= 0) { // basically not negative max value of int32t
-				ctx.hoveredEntity.emplace(this->ctx.scene->resolveEntity(static_cast<entt::entity>(data)));
+	void EditorApplication::_onPickResult(const PickQuery& query, std::span<const uint32_t> ids) {
+		std::vector<entt::entity> hits;
+		hits.reserve(ids.size());
+		for (const uint32_t id : ids) {
+			// cleared to -1, anything negative is background
+			if ((int32_t)id < 0) continue;
+			hits.push_back(static_cast<entt::entity>(id));
+		}
+		std::sort(hits.begin(), hits.end());
+		hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+		// the scene may have changed while the readback was in flight
+		std::erase_if(hits, [this](entt::entity handle) { return !ctx.scene->isValidEntity(handle); });
+
+		if (query.isMarquee) {
+			ctx.selectedHandles = hits;
+			if (hits.empty()) {
+				ctx.activeEntity = std::nullopt;
 			} else {
-				ctx.hoveredEntity = std::nullopt;
+				ctx.activeEntity.emplace(ctx.scene->resolveEntity(hits.front()));
+				_selectedEntry = std::nullopt;
 			}
-		} else {
-			ctx.hoveredEntity = std::nullopt;
+			return;
 		}
+		if (!hits.empty()) {
+			ctx.activeEntity.emplace(ctx.scene->resolveEntity(hits.front()));
+			ctx.selectedHandles = { hits.front() };
+			_selectedEntry = std::nullopt;
+		} else if (query.isDoubleClick) {
+			ctx.activeEntity = std::nullopt;
+			ctx.selectedHandles.clear();
+		}
+	}
 
+	void EditorApplication::_onViewportPanelUpdate() {
 		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.f, 0.f)); // image takes up entire window
 		ImGui::Begin("Viewport", nullptr, ImGuiWindowFlags_MenuBar);
 		if (ImGui::IsWindowHovered()) this->_currenthovered = HoverWindow::ViewportWindow;
@@ -312,15 +308,38 @@ namespace Slate {
 			}
 			// mouse interaction with clicked object must be after guizmo
 			// required so that overlapping guizmo and different object dont interfere
-			if (glfwGetMouseButton(this->getActiveWindow()->getGLFWWindow(), GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-				if (ctx.hoveredEntity.has_value() && !ImGuizmo::IsUsing()) {
-					this->ctx.activeEntity.emplace(this->ctx.hoveredEntity.value());
-					_selectedEntry = std::nullopt;
-				}
+			// picks are only queued here, the ids are rendered and read back with the next frame and land in _onPickResult
+			if (ImGui::IsMouseClicked(ImGuiMouseButton_Left) && ImGui::IsWindowHovered() && IsMouseInViewportBounds()
+				&& !_isCameraControlActive && !ImGuizmo::IsOver() && !ImGuizmo::IsUsing()) {
+				auto [ mouseX, mouseY ] = GetInput().GetMousePosition();
+				_marqueeStart = { (float)mouseX, (float)mouseY };
+				_isMarqueeActive = true;
+				_isMarqueeDoubleClick = ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left);
 			}
-			// right now will currently go off in menu that overlaps the image
-			if (ImGui::IsMouseDoubleClicked(GLFW_MOUSE_BUTTON_LEFT) && IsMouseInViewportBounds() && !this->ctx.hoveredEntity.has_value()) {
-				this->ctx.activeEntity = std::nullopt;
+			if (_isMarqueeActive) {
+				auto [ mouseX, mouseY ] = GetInput().GetMousePosition();
+				const glm::vec2 mouse = { (float)mouseX, (float)mouseY };
+				// a few pixels of slack so a shaky click is still a click
+				const bool isDragging = glm::any(glm::greaterThan(glm::abs(mouse - _marqueeStart), glm::vec2(4.f)));
+				if (isDragging) {
+					ImGui::GetWindowDrawList()->AddRectFilled({_marqueeStart.x, _marqueeStart.y}, {mouse.x, mouse.y}, IM_COL32(255, 165, 0, 40));
+					ImGui::GetWindowDrawList()->AddRect({_marqueeStart.x, _marqueeStart.y}, {mouse.x, mouse.y}, IM_COL32(255, 165, 0, 200));
+				}
+				if (!ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+					_isMarqueeActive = false;
+					const glm::ivec2 start = _viewportToImagePixel(_marqueeStart);
+					const glm::ivec2 end = isDragging ? _viewportToImagePixel(mouse) : start;
+					const glm::ivec2 minPixel = glm::min(start, end);
+					const glm::ivec2 maxPixel = glm::max(start, end);
+					_pendingPick = PickQuery{
+						.region = {
+								.offset = { minPixel.x, minPixel.y },
+								.extent = { (uint32_t)(maxPixel.x - minPixel.x + 1), (uint32_t)(maxPixel.y - minPixel.y + 1) }
+						},
+						.isMarquee = isDragging,
+						.isDoubleClick = _isMarqueeDoubleClick,
+					};
+				}
 			}
 		}
 		ImGui::End();
@@ -23,6 +23,14 @@ namespace Slate {
 			}
 			stop();
 		}
+		// no glfw and no window, createWindow does nothing and GX renders into its offscreen swapchain
+		// stops on its own after numFrames, 0 runs until callStop
+		inline virtual void runHeadless(uint32_t numFrames = 0) final {
+			_isHeadless = true;
+			_maxHeadlessFrames = numFrames;
+			run();
+		}
+		inline bool isHeadless() const { return _isHeadless; }
 		virtual void callStop() final { _running = false; };
 	public:
 //		virtual void onWindowMouseButton() {};
@@ -44,6 +52,7 @@ namespace Slate {
 
 		// function
 		inline virtual void createWindow(const WindowSpec& spec) final {
+			if (_isHeadless) return;
 			_window.create(spec);
 			_inputHandler = new InputHandler(_window);
 			installAppCallbacksToWindow(_window.getGLFWWindow());
@@ -64,10 +73,14 @@ namespace Slate {
 		std::atomic<bool> _running = true;
 		// every app has its graphics
 		GX _gx;
-		InputHandler* _inputHandler;
+		InputHandler* _inputHandler = nullptr; // null when headless
 		Window _window;
 		// time
 		Timer _apptime;
+	private:
+		bool _isHeadless = false;
+		uint32_t _maxHeadlessFrames = 0;
+		uint32_t _numHeadlessFrames = 0;
 	};
 }
 
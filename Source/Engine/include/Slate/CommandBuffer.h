@@ -3,7 +3,11 @@
 //
 
 #pragma once
+#include <span>
+#include <vector>
 #include <volk.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 
 #include "Slate/VK/vkenums.h"
 #include "Slate/Common/Handles.h"
@@ -14,6 +18,8 @@ namespace Slate {
 	class GX;
 	class Framebuffer;
 	class RenderPass;
+	class MeshData;
+	struct AllocatedImage;
 
 	// we only use it for the cmdBeginRendering command anyways
 	struct Dependencies {
@@ -22,11 +28,45 @@ namespace Slate {
 		InternalBufferHandle buffers[kMaxSubmitDependencies] = {};
 	};
 
+	// where the commands of a render pass are recorded
+	enum class RenderingContents : uint8_t {
+		Inline,
+		Secondary // only cmdExecuteCommands in between, see ParallelRecorder
+	};
+
 	struct DepthState {
 		CompareOperation compareOp = CompareOperation::CompareOp_AlwaysPass;
 		bool isDepthWriteEnabled = false;
 	};
 
+	// state commands a command buffer sent to the driver vs. the ones it dropped because nothing changed
+	enum class StateCommand : uint8_t {
+		BindPipeline,
+		BindIndexBuffer,
+		PushConstants,
+		Viewport,
+		Scissor,
+		DepthWrite,
+		DepthTest,
+		DepthCompareOp,
+		DepthBiasEnable,
+		DepthBias,
+		Count
+	};
+	struct CommandStats {
+		uint32_t issued[(size_t)StateCommand::Count] = {};
+		uint32_t filtered[(size_t)StateCommand::Count] = {};
+		uint32_t draws = 0;
+		uint32_t dispatches = 0;
+		uint32_t barriers = 0;        // image and buffer barriers recorded
+		uint32_t barrierBatches = 0;  // vkCmdPipelineBarrier2 calls they went out in
+		uint32_t barriersFolded = 0;  // transitions dropped or merged into one already queued
+
+		uint32_t getTotalIssued() const;
+		uint32_t getTotalFiltered() const;
+		void add(const CommandStats& other);
+	};
+
 
 
 	// lets RAII this guy
@@ -37,10 +77,17 @@ namespace Slate {
 		~CommandBuffer();
 
 		VkCommandBufferSubmitInfo requestSubmitInfo() const;
-		VkCommandBuffer requestVkCmdBuffer() const { return _wrapper ? _wrapper->_cmdBuf : VK_NULL_HANDLE; }
+		// queued barriers are not in it yet, call cmdFlushBarriers before recording into it outside of a render pass
+		// whatever gets recorded into it may change bound state behind our back, so everything shadowed is forgotten
+		VkCommandBuffer requestVkCmdBuffer() {
+			_invalidateBoundState();
+			return _vkCmdBuf;
+		}
 	public:
-		void cmdBeginRendering(RenderPass pass, const Dependencies& deps = {});
+		void cmdBeginRendering(RenderPass pass, const Dependencies& deps = {}, RenderingContents contents = RenderingContents::Inline);
 		void cmdEndRendering();
+		// secondaries have to continue the render pass this one is in, their stats are added to ours
+		void cmdExecuteCommands(std::span<const CommandBuffer> secondaries);
 
 		void cmdBindRenderPipeline(InternalPipelineHandle handle);
 		void cmdBindIndexBuffer(InternalBufferHandle buffer);
@@ -52,6 +99,8 @@ namespace Slate {
 			cmdPushConstants(&type, (uint32_t)sizeof(Struct), offset);
 		}
 		void cmdUpdateBuffer(InternalBufferHandle bufhandle, size_t offset, size_t size, const void* data);
+		// repeats a 4 byte value, for clearing counters the gpu writes to, no barriers are inserted around it
+		void cmdFillBuffer(InternalBufferHandle buffer, size_t offset, size_t size, uint32_t value);
 		template<typename Struct>
 		void cmdUpdateBuffer(InternalBufferHandle buffer, const Struct& data, size_t bufferOffset = 0) {
 			cmdUpdateBuffer(buffer, bufferOffset, sizeof(Struct), &data);
@@ -59,21 +108,50 @@ namespace Slate {
 
 		void cmdDraw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
 		void cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t baseInstance = 0);
-		void cmdDrawInstanced();
-		void cmdDrawIndexedInstanced();
+		// draw instanceCount copies of an arena mesh, per-instance data is up to the shader (usually a storage buffer indexed by SV_InstanceID)
+		void cmdDrawInstanced(const MeshData& mesh, uint32_t instanceCount, uint32_t firstInstance = 0);
+		void cmdDrawIndexedInstanced(const MeshData& mesh, uint32_t instanceCount, uint32_t firstInstance = 0);
+		// draws a mesh out of the shared geometry arena, the arena index buffer is only bound once per command buffer
+		void cmdDrawMesh(const MeshData& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+		void cmdBindGeometryIndexBuffer();
+		// stride of 0 means tightly packed VkDrawIndexedIndirectCommands
+		void cmdDrawIndexedIndirect(InternalBufferHandle indirectBuffer, size_t offset, uint32_t drawCount, uint32_t stride = 0);
+		void cmdDrawIndexedIndirectCount(InternalBufferHandle indirectBuffer, size_t offset, InternalBufferHandle countBuffer, size_t countOffset, uint32_t maxDrawCount, uint32_t stride = 0);
+
+		// the bindless sets are bound for compute the same as for graphics, push constants go to whichever pipeline was bound last
+		void cmdBindComputePipeline(InternalComputePipelineHandle handle);
+		// counts are in workgroups, not threads, and only valid outside of a render pass
+		void cmdDispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+		// offset points at a VkDispatchIndirectCommand, usually written by an earlier dispatch
+		void cmdDispatchIndirect(InternalBufferHandle indirectBuffer, size_t offset = 0);
 
 
 		void cmdSetViewport(VkExtent2D extent2D);
 		void cmdSetScissor(VkExtent2D extent2D);
+		void cmdSetScissor(VkRect2D rect);
 
 		void cmdBindDepthState(const DepthState& state);
 		void cmdSetDepthBiasEnable(bool enable);
 		void cmdSetDepthBias(float constantFactor, float slopeFactor, float clamp);
 
+		inline const CommandStats& getStats() const { return _stats; }
+
+		// named gpu timing regions for GX::getGPUFrameTimings, they nest and every render pass opens one of its own
+		// ignored in secondaries, those are recorded from several threads at once
+		void cmdBeginScope(const char* name);
+		void cmdEndScope();
 
+
+		// transitions and barriers are only queued, they go out together right before the next command that needs them
 		void cmdTransitionLayout(InternalTextureHandle source, VkImageLayout newLayout);
+		void cmdTransitionLayout(InternalTextureHandle source, VkImageLayout newLayout, const VkImageSubresourceRange& range);
 		void cmdTransitionLayout(InternalTextureHandle source, VkImageLayout currentLayout, VkImageLayout newLayout);
 		void cmdTransitionSwapchainLayout(VkImageLayout newLayout);
+		void cmdPipelineBarrier(std::span<const VkImageMemoryBarrier2> imageBarriers, std::span<const VkBufferMemoryBarrier2> bufferBarriers);
+		// for memory that stays put between the writer and the reader, storage buffers and storage images in GENERAL
+		void cmdBufferBarrier(InternalBufferHandle buffer, VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage);
+		void cmdImageBarrier(InternalTextureHandle texture, VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage);
+		void cmdFlushBarriers();
 
 		void cmdCopyImageToBuffer(InternalTextureHandle source, InternalBufferHandle destination, const VkBufferImageCopy& region);
 		void cmdCopyImage(InternalTextureHandle source, InternalTextureHandle destination, VkExtent2D size);
@@ -81,20 +159,89 @@ namespace Slate {
 		void _cmdBlitImage(InternalTextureHandle source, InternalTextureHandle destination, VkExtent2D srcSize, VkExtent2D dstSize);
 		void cmdBlitToSwapchain(InternalTextureHandle source);
 	private:
-		void bufferBarrier(InternalBufferHandle bufhandle, VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage);
+		void _queueImageBarrier(const VkImageMemoryBarrier2& barrier);
+		// continues the render pass primary is in, dynamic state is set up again since secondaries inherit none of it
+		void _beginSecondary(GX* gx, VkCommandBuffer secondary, const CommandBuffer& primary);
+		void _endSecondary();
+		void _beginProfileScope(const char* name, bool collectStatistics);
+		void _queueImageTransition(const AllocatedImage& image, VkImageLayout oldLayout, VkImageLayout newLayout, const VkImageSubresourceRange& range);
+		void _bindIndexBuffer(VkBuffer buffer);
+		bool _isPushConstantRedundant(VkPipelineLayout layout, const void* data, uint32_t size, uint32_t offset);
+		// forget every shadowed bind and dynamic state, the next command of each kind is always recorded
+		void _invalidateBoundState();
+		// returns true when the command has to be recorded, false when the shadowed value already matches
+		template<class T>
+		bool _shadow(StateCommand command, T& shadow, const T& value, bool& isKnown) {
+			if (isKnown && shadow == value) {
+				_stats.filtered[(size_t)command]++;
+				return false;
+			}
+			shadow = value;
+			isKnown = true;
+			_stats.issued[(size_t)command]++;
+			return true;
+		}
 
 	private:
 		GX* _gxCtx = nullptr;
-		const VulkanImmediateCommands::CommandBufferWrapper* _wrapper = nullptr;
+		const VulkanImmediateCommands::CommandBufferWrapper* _wrapper = nullptr; // null for secondaries
+		VkCommandBuffer _vkCmdBuf = VK_NULL_HANDLE;
 
 		bool _isRecording = false; // cmdBegin
 		bool _isRendering = false; // cmdBeginRendering
+		bool _isSecondary = false;
+		RenderingContents _renderingContents = RenderingContents::Inline;
+		// what secondaries continuing the current render pass have to declare
+		struct {
+			std::vector<VkFormat> colorFormats;
+			VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+			VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+			VkExtent2D extent = {};
+		} _renderingInfo;
 
 		VkPipeline _lastBoundPipeline = VK_NULL_HANDLE;
 		InternalPipelineHandle _currentPipeline;
+		bool _isPipelinePending = false; // bound pipeline is compiling with no fallback, draws are skipped
+		VkBuffer _currentIndexBuffer = VK_NULL_HANDLE;
+		VkPipeline _lastBoundComputePipeline = VK_NULL_HANDLE;
+		InternalComputePipelineHandle _currentComputePipeline;
+		VkPipelineBindPoint _lastBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+		// shadowed dynamic state, every pipeline declares the same dynamic states so these survive pipeline binds
+		struct {
+			glm::uvec2 viewport = {};
+			glm::ivec4 scissor = {}; // offset, extent
+			bool depthWrite = false;
+			bool depthTest = false;
+			VkCompareOp depthCompareOp = VK_COMPARE_OP_NEVER;
+			bool depthBiasEnable = false;
+			glm::vec3 depthBias = {}; // constant, slope, clamp
+
+			bool hasViewport = false;
+			bool hasScissor = false;
+			bool hasDepthWrite = false;
+			bool hasDepthTest = false;
+			bool hasDepthCompareOp = false;
+			bool hasDepthBiasEnable = false;
+			bool hasDepthBias = false;
+		} _dynamic;
+		// last pushed bytes, one valid bit per 4 byte word, dropped whenever the pipeline layout changes
+		static constexpr uint32_t kMaxPushConstantBytes = 256;
+		uint8_t _pushShadow[kMaxPushConstantBytes] = {};
+		uint64_t _pushValidWords = 0;
+		VkPipelineLayout _lastPushLayout = VK_NULL_HANDLE;
+
+		CommandStats _stats = {};
+		// open profiler scopes, innermost last
+		std::vector<uint32_t> _profileScopes;
+		size_t _renderingScopeDepth = 0; // size of _profileScopes once cmdBeginRendering opened its scope
+
+		std::vector<VkImageMemoryBarrier2> _pendingImageBarriers;
+		std::vector<VkBufferMemoryBarrier2> _pendingBufferBarriers;
 
 		SubmitHandle _lastSubmitHandle = {};
 		friend class GX; // for injection of command buffer data
+		friend class ParallelRecorder;
 	};
 
 }
\ No newline at end of file
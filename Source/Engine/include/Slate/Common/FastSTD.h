@@ -170,6 +170,7 @@ namespace Slate {
 		};
 		// ENTRY //
 		struct ResourceEntry {
+			ResourceEntry() = default; // FastVector default constructs its whole array
 			explicit ResourceEntry(T&& obj) : _obj(std::move(obj)) {}
 			T _obj = {};
 			uint32_t _gen = 1;
@@ -205,7 +206,7 @@ namespace Slate {
 			// destruction made need to be rewritten
 			_objects[index]._obj = T{};
 			_objects[index]._gen++;
-			_objects[index]._nextFree = _firstFreeIndex;
+			_objects[index]._nextFreeIndex = _firstFreeIndex;
 			_firstFreeIndex = index;
 			_numObjects--;
 		}
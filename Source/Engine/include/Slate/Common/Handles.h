@@ -31,6 +31,9 @@ namespace Slate {
 		bool empty() const {
 			return _generation == 0;
 		}
+		bool operator==(const ObjectHandle& other) const {
+			return _index == other._index && _generation == other._generation;
+		}
 	private:
 		uint32_t _index = 0;
 		uint32_t _generation = 0;
@@ -39,7 +42,9 @@ namespace Slate {
 	using InternalTextureHandle = ObjectHandle<struct Texture>;
 	using InternalSamplerHandle = ObjectHandle<struct Sampler>;
 	using InternalPipelineHandle = ObjectHandle<struct Pipeline>;
+	using InternalComputePipelineHandle = ObjectHandle<struct Compute>;
 	using InternalShaderHandle = ObjectHandle<struct Shader>;
+	using InternalGeometryHandle = ObjectHandle<struct Geometry>;
 
 
 
@@ -89,6 +94,23 @@ namespace Slate {
 			_freeListHead = index;
 			_numObjects--;
 		}
+		// like destroy, but the slot stays off the free list until release(), for slots the gpu may still reference
+		void retire(HandleType handle) {
+			if (handle.empty()) return;
+
+			const uint32_t index = handle.index();
+			assert(index < _objects.size());
+			assert(handle.gen() == _objects[index]._gen);
+
+			_objects[index]._obj = ActualObject{};
+			_objects[index]._gen++;
+			_numObjects--;
+		}
+		void release(uint32_t index) {
+			assert(index < _objects.size());
+			_objects[index]._nextFree = _freeListHead;
+			_freeListHead = index;
+		}
 		ActualObject* get(HandleType handle) {
 			if (handle.empty()) return nullptr;
 
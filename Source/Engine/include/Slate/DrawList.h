@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <volk.h>
+#include <glm/mat4x4.hpp>
+
+#include "Slate/Common/Handles.h"
+#include "Slate/SubmitHandle.h"
+#include "Slate/VK/vktypes.h"
+
+namespace Slate {
+	// forward declare
+	class GX;
+	class CommandBuffer;
+	class MeshData;
+
+	// collects every mesh draw of a frame, then submits one multi-draw indirect call per pipeline
+	// draws sharing a mesh + pipeline are merged into one instanced command, so repeated props cost a single draw
+	// per-draw data is indexed with SV_DrawIndex, per-instance data with DrawData::firstInstance + SV_InstanceID
+	// with culling enabled a compute pass drops the instances outside the camera frustum and packs what is left into
+	// indirect commands with a count (or empty draws where drawIndirectCount is missing), shaders see the same
+	// DrawData/InstanceData either way
+	class DrawList final {
+	public:
+		explicit DrawList(GX& gx, uint32_t initialCapacity = 1024);
+		~DrawList();
+
+		DrawList(const DrawList&) = delete;
+		DrawList& operator=(const DrawList&) = delete;
+	public:
+		// clears the previous frame's draws
+		void reset();
+		void add(InternalPipelineHandle pipeline, const MeshData& mesh, const glm::mat4& modelMatrix, uint32_t id = 0);
+		// groups by pipeline then mesh and writes the commands + draw/instance data for this frame, call once after the last add
+		void upload();
+		// both entry points of the culling shader, empty handles turn culling back off
+		void setCulling(InternalComputePipelineHandle cullInstances, InternalComputePipelineHandle compactDraws);
+		inline bool isCullingEnabled() const { return _cullInstancesPipeline.valid() && _compactDrawsPipeline.valid(); }
+		// tests every instance against the camera of GPU::PerFrameData, record it after upload and outside of a render pass
+		void cull(CommandBuffer& cmd) const;
+		// extra push constants land right after GPU::DrawListPushConstants for every pipeline
+		void submit(CommandBuffer& cmd, const void* extraPushData = nullptr, uint32_t extraPushSize = 0) const;
+
+		inline uint32_t getNumInstances() const { return static_cast<uint32_t>(_draws.size()); }
+		inline uint32_t getNumCommands() const { return static_cast<uint32_t>(_commandScratch.size()); }
+		inline uint32_t getNumBatches() const { return static_cast<uint32_t>(_batches.size()); }
+	private:
+		void _ensureCapacity(uint32_t numDraws);
+		void _destroyFrameBuffers();
+	private:
+		struct PendingDraw {
+			InternalPipelineHandle pipeline;
+			InternalGeometryHandle geometry;
+			uint32_t indexCount = 0;
+			uint32_t firstIndex = 0;
+			VkDeviceAddress vertexBufferAddress = 0;
+			glm::vec4 bounds = {};
+			GPU::InstanceData instance;
+		};
+		struct Batch {
+			InternalPipelineHandle pipeline;
+			uint32_t firstCommand = 0;
+			uint32_t numCommands = 0;
+		};
+		// a frame in flight may still read the buffers we wrote before, so each frame gets its own set
+		struct FrameBuffers {
+			InternalBufferHandle commands;
+			InternalBufferHandle drawData;
+			InternalBufferHandle instanceData;
+			// culling only, the culled buffers are written by the gpu and never leave device memory
+			InternalBufferHandle cullCommands;
+			InternalBufferHandle instanceCommands;
+			InternalBufferHandle culledCommands;
+			InternalBufferHandle culledDrawData;
+			InternalBufferHandle culledInstances;
+			InternalBufferHandle counts;
+			SubmitHandle lastUse = {};
+		};
+		static constexpr uint32_t kNumFrameBuffers = 3;
+
+		GX& _gx;
+		std::vector<PendingDraw> _draws;
+		std::vector<Batch> _batches;
+		std::vector<VkDrawIndexedIndirectCommand> _commandScratch;
+		std::vector<GPU::DrawData> _dataScratch;
+		std::vector<GPU::InstanceData> _instanceScratch;
+		std::vector<GPU::CullCommand> _cullScratch;
+		std::vector<uint32_t> _instanceCommandScratch;
+
+		InternalComputePipelineHandle _cullInstancesPipeline;
+		InternalComputePipelineHandle _compactDrawsPipeline;
+
+		FrameBuffers _frames[kNumFrameBuffers];
+		uint32_t _currentFrame = 0;
+		uint32_t _capacity = 0;
+	};
+}
@@ -49,6 +49,8 @@ namespace Slate {
 
 		// try not call resolve
 		GameEntity resolveEntity(entt::entity handle);
+		// handles kept around for a few frames (picking, selections) may belong to entities destroyed since
+		inline bool isValidEntity(entt::entity handle) const { return _registry.valid(handle); }
 	public:
 		AmbientLightComponent& GetEnvironment() {
 			auto view = _registry.view<AmbientLightComponent>();
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+#include "Slate/CommandBuffer.h"
+#include "Slate/Common/Handles.h"
+#include "Slate/RenderPassBuilder.h"
+
+namespace Slate {
+	// forward declare
+	class GX;
+	class CommandBuffer;
+
+	// how a pass touches a texture, decides the layout it needs and the stages that have to wait on it
+	enum class TextureAccess : uint8_t {
+		ColorAttachment,
+		DepthAttachment,
+		Sampled,
+		Storage,
+		TransferSrc,
+		TransferDst
+	};
+	enum class BufferAccess : uint8_t {
+		Uniform,
+		Storage,
+		Index,
+		Indirect,
+		TransferSrc,
+		TransferDst
+	};
+
+	struct FrameGraphStats {
+		uint32_t declaredPasses = 0;
+		uint32_t culledPasses = 0;
+		uint32_t barrierBatches = 0; // batches handed to the command buffer
+		uint32_t imageBarriers = 0;
+		uint32_t bufferBarriers = 0;
+	};
+
+	// passes declare what they read and write, the graph works out the rest:
+	// passes nobody consumes are culled, independent passes share one barrier batch and layouts are tracked for you
+	// rebuild it every frame, declaring is cheap and the closures can capture whatever the frame needs
+	class FrameGraph final {
+	public:
+		using ExecuteFn = std::function<void(CommandBuffer&)>;
+
+		class Pass {
+		public:
+			Pass& read(InternalTextureHandle texture, TextureAccess access = TextureAccess::Sampled);
+			Pass& write(InternalTextureHandle texture, TextureAccess access);
+			Pass& read(InternalBufferHandle buffer, BufferAccess access);
+			Pass& write(InternalBufferHandle buffer, BufferAccess access);
+			// attachments are declared as writes, loaded attachments as reads too, the pass runs inside cmdBeginRendering/cmdEndRendering
+			// with RenderingContents::Secondary the execute closure may only hand secondaries to the command buffer, see ParallelRecorder
+			Pass& setRenderPass(const RenderPassBuilder& builder, RenderingContents contents = RenderingContents::Inline);
+			// never culled, for passes that matter outside the graph (presenting, readbacks...)
+			Pass& setSideEffect();
+			Pass& setExecute(ExecuteFn fn);
+		private:
+			struct Use {
+				uint64_t key = 0;
+				InternalTextureHandle texture = {};
+				InternalBufferHandle buffer = {};
+				uint8_t access = 0; // TextureAccess or BufferAccess
+				bool isRead = false;
+				bool isWrite = false;
+				bool isResolve = false; // depth resolves run in the color attachment output stage
+			};
+			void _use(const Use& use);
+
+			std::string _name;
+			std::vector<Use> _uses;
+			ExecuteFn _execute;
+			RenderPass _renderPass = {};
+			RenderingContents _renderingContents = RenderingContents::Inline;
+			bool _hasRenderPass = false;
+			bool _hasSideEffect = false;
+			// filled in by compile
+			bool _isAlive = false;
+			uint32_t _level = 0;
+			friend class FrameGraph;
+		};
+	public:
+		explicit FrameGraph(GX& gx) : _gx(gx) {}
+		~FrameGraph() = default;
+
+		FrameGraph(const FrameGraph&) = delete;
+		FrameGraph& operator=(const FrameGraph&) = delete;
+	public:
+		// forgets every pass, call at the start of the frame
+		void reset();
+		// the returned reference is valid until the next addPass
+		Pass& addPass(const char* name);
+		// keeps the passes writing this texture alive and leaves it in the layout of finalAccess once the graph ran
+		void markOutput(InternalTextureHandle texture, TextureAccess finalAccess);
+		void markOutput(InternalTextureHandle texture);
+		// contents do not need to survive the frame, the first pass touching it each frame starts from a discarded image
+		void markTransient(InternalTextureHandle texture);
+
+		// transient textures whose lifetimes in the compiled order never overlap, feed these to GX::aliasTextures
+		std::vector<std::vector<InternalTextureHandle>> computeAliasGroups() const;
+
+		// culls and orders the declared passes
+		void compile();
+		// records every surviving pass into cmd, inserting barriers in between
+		void execute(CommandBuffer& cmd);
+
+		inline const FrameGraphStats& getStats() const { return _stats; }
+		// names of the surviving passes in the order they run, for debug ui
+		std::vector<const char*> getExecutionOrder() const;
+	private:
+		struct ResourceState {
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags2 stage = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 access = VK_ACCESS_2_NONE;
+			bool isWrite = false;
+		};
+		struct Output {
+			InternalTextureHandle texture;
+			TextureAccess finalAccess;
+			bool hasFinalAccess;
+		};
+		void _cull();
+		void _computeLevels();
+		ResourceState& _getState(const Pass::Use& use);
+		// queues whatever barrier the use needs into the current batch
+		void _requireAccess(const Pass::Use& use);
+		void _flushBarriers(CommandBuffer& cmd);
+	private:
+		GX& _gx;
+		std::vector<Pass> _passes;
+		std::vector<Output> _outputs;
+		std::vector<InternalTextureHandle> _transients;
+		std::vector<uint32_t> _order; // alive pass indices sorted by level
+		bool _isCompiled = false;
+
+		// rebuilt on execute
+		std::unordered_map<uint64_t, ResourceState> _states;
+		std::vector<VkImageMemoryBarrier2> _imageBarriers;
+		std::vector<VkBufferMemoryBarrier2> _bufferBarriers;
+		std::unordered_map<uint64_t, uint32_t> _batchedBarriers; // resource -> index into one of the barrier arrays
+		std::unordered_map<uint64_t, uint32_t> _transientGroups; // transient resource -> alias group, 0 if it owns its memory
+		std::unordered_map<uint32_t, uint64_t> _groupOccupants; // alias group -> resource that used the memory last
+
+		FrameGraphStats _stats = {};
+	};
+}
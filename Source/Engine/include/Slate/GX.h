@@ -13,6 +13,8 @@
 #include "Slate/Common/Handles.h"
 #include "Slate/Common/HelperMacros.h"
 #include "Slate/PipelineBuilder.h"
+#include "Slate/OffsetAllocator.h"
+#include "Slate/PipelineCompiler.h"
 #include "Slate/Resources/MeshResource.h"
 #include "Slate/VK/vkenums.h"
 
@@ -20,11 +22,17 @@
 #include "Slate/Resources/TextureResource.h"
 #include "Slate/SubmitHandle.h"
 #include "Slate/Version.h"
+#include "Slate/VulkanProfiler.h"
+#include "Slate/VulkanReadbackDevice.h"
 #include "Slate/VulkanStagingDevice.h"
 #include "SmartPointers.h"
 
 
+#include <filesystem>
 #include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <slang/slang-com-ptr.h>
 #include <volk.h>
 
@@ -42,6 +50,128 @@ namespace Slate {
 		Version app_version;
 		const char* engine_name = "Unnamed_Engine";
 		Version engine_version;
+		// on-disk location of the pipeline cache, nullptr disables persistence
+		const char* pipeline_cache_path = "pipeline_cache.bin";
+		// when enabled createPipeline() hands compilation to worker threads instead of the first bind
+		bool async_pipeline_compilation = false;
+		uint32_t pipeline_compile_threads = 0; // 0 picks hardware_concurrency - 1
+		// size the bindless set once up front so adding textures never recreates the layout (and every pipeline)
+		bool preallocate_bindless = false;
+		uint32_t max_bindless_textures = 65536; // clamped to the device's update-after-bind limits
+		uint32_t max_bindless_samplers = 4096;
+		// starting size of the shared geometry arena in vertices / indices, it grows on demand
+		uint32_t geometry_vertex_capacity = 256 * 1024;
+		uint32_t geometry_index_capacity = 1024 * 1024;
+		// timestamps and pipeline statistics around every render pass and command buffer scope, see GX::getGPUFrameTimings
+		bool gpu_profiling = false;
+		// size of the offscreen swapchain GX renders into when it is created without a window
+		VkExtent2D headless_extent = {1280, 720};
+	};
+
+	// tracks which elements of a bindless array need rewriting on the next checkAndUpdateDescriptorSets()
+	struct DescriptorSlotTracker
+	{
+		std::vector<uint32_t> dirty;
+		// per slot, the submit that may still read the current descriptor, the slot is not rewritten before it retires
+		std::vector<SubmitHandle> retireHandles;
+		// slots of destroyed objects, they only go back to their pool once the retire handle is done
+		std::vector<bool> isFreed;
+
+		inline void markDirty(uint32_t slot) { dirty.push_back(slot); }
+		void markRetired(uint32_t slot, SubmitHandle handle) {
+			if (slot >= retireHandles.size()) {
+				retireHandles.resize(slot + 1);
+				isFreed.resize(slot + 1);
+			}
+			retireHandles[slot] = handle;
+			dirty.push_back(slot);
+		}
+		void markFreed(uint32_t slot, SubmitHandle handle) {
+			markRetired(slot, handle);
+			isFreed[slot] = true;
+		}
+		void markAll(uint32_t numSlots) {
+			dirty.resize(numSlots);
+			for (uint32_t i = 0; i < numSlots; i++) {
+				dirty[i] = i;
+			}
+		}
+	};
+	struct DescriptorUpdateStats
+	{
+		uint32_t numUpdates = 0;      // calls that actually wrote something
+		uint32_t numSlotsWritten = 0; // array elements written by the last update
+		double lastUpdateMs = 0.0;
+	};
+
+	struct PipelineCacheStats
+	{
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		size_t loadedBytes = 0; // 0 means we started cold
+	};
+
+	struct GeometryArenaStats
+	{
+		uint32_t vertexCapacity = 0;
+		uint32_t verticesUsed = 0;
+		uint32_t indexCapacity = 0;
+		uint32_t indicesUsed = 0;
+		uint32_t numFreeRanges = 0; // across both pools, a rough fragmentation measure
+		uint32_t numRebuilds = 0;   // grows + defragmentations
+	};
+
+	struct TransientMemoryStats
+	{
+		VkDeviceSize aliasedRequestedBytes = 0; // what the aliased textures would take with memory of their own
+		VkDeviceSize aliasedCommittedBytes = 0; // what their shared allocations take
+		VkDeviceSize lazilyAllocatedBytes = 0;  // memoryless textures in lazily allocated memory, only backed if the tiler spills
+		uint32_t numAliasedTextures = 0;
+		uint32_t numAliasGroups = 0;
+	};
+
+	// vma's view of device memory, summed over every heap
+	struct DeviceMemoryStats
+	{
+		VkDeviceSize allocatedBytes = 0; // what our allocations take
+		VkDeviceSize blockBytes = 0;     // device memory vma holds for them, including the free space inside its blocks
+		VkDeviceSize usageBytes = 0;     // what the driver reports this process uses, blockBytes when the budget extension is missing
+		VkDeviceSize budgetBytes = 0;
+		uint32_t numAllocations = 0;
+		uint32_t numBlocks = 0;
+	};
+
+	// how often creating a state object handed back an existing one instead of making a new vulkan object
+	struct StateCacheStats
+	{
+		uint32_t samplerHits = 0;
+		uint32_t samplerMisses = 0;
+		uint32_t layoutHits = 0;
+		uint32_t layoutMisses = 0;
+		uint32_t pipelineHits = 0;
+		uint32_t pipelineMisses = 0;
+	};
+
+	// every pipeline layout uses the same set layouts, so only the bindless layout and push constant range tell them apart
+	struct PipelineLayoutKey
+	{
+		VkDescriptorSetLayout dsl = VK_NULL_HANDLE;
+		uint32_t pushConstantSize = 0;
+		VkShaderStageFlags pushConstantStages = 0; // graphics and compute layouts never share a range
+
+		bool operator==(const PipelineLayoutKey& other) const { return dsl == other.dsl && pushConstantSize == other.pushConstantSize && pushConstantStages == other.pushConstantStages; }
+		struct Hash {
+			size_t operator()(const PipelineLayoutKey& key) const {
+				return std::hash<const void*>{}(key.dsl) ^ (std::hash<uint32_t>{}(key.pushConstantSize) << 1) ^ (std::hash<uint32_t>{}(key.pushConstantStages) << 2);
+			}
+		};
+	};
+	// push constants of graphics pipelines are visible to both stages of the module
+	constexpr VkShaderStageFlags kGraphicsPushConstantStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	struct CachedPipelineLayout
+	{
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		uint32_t refCount = 0;
 	};
 
 
@@ -138,11 +268,32 @@ namespace Slate {
 		} formats = {};
 
 		InternalShaderHandle shaderhandle;
+		// bound in its place while this pipeline compiles in the background, empty skips the draws instead
+		InternalPipelineHandle fallback = {};
 	};
 	struct RenderPipeline
 	{
 		PipelineSpec _spec;
 
+		VkPipeline _vkPipeline = VK_NULL_HANDLE;
+		VkPipelineLayout _vkPipelineLayout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout _vkLastDescriptorSetLayout = VK_NULL_HANDLE;
+		bool _isCompiling = false;
+		// identical specs share one handle, the last destroy() actually frees it
+		size_t _specHash = 0;
+		uint32_t _refCount = 1;
+	};
+	struct ComputePipelineSpec
+	{
+		InternalShaderHandle shaderhandle;
+		// a [shader("compute")] function of the slang module the shader was compiled from
+		std::string entryPoint = "cs_main";
+	};
+	// built on first bind, compute pipelines are a single stage so they skip the worker threads
+	struct ComputePipeline
+	{
+		ComputePipelineSpec _spec;
+
 		VkPipeline _vkPipeline = VK_NULL_HANDLE;
 		VkPipelineLayout _vkPipelineLayout = VK_NULL_HANDLE;
 		VkDescriptorSetLayout _vkLastDescriptorSetLayout = VK_NULL_HANDLE;
@@ -195,6 +346,8 @@ namespace Slate {
 
 		ColorAttachmentDesc color[kMaxColorAttachments];
 		DepthAttachmentDesc depth;
+		// names the gpu scope cmdBeginRendering opens, the frame graph fills in the pass name
+		const char* debugName = nullptr;
 	};
 
 	struct Framebuffer
@@ -236,10 +389,15 @@ namespace Slate {
 		VkSampler getLinearSampler() const { return _samplerPool.get(_linearSamplerHandle)->_vkSampler; }
 	public:
 		inline void deviceWaitIdle() const { vkDeviceWaitIdle(_backend.getDevice()); }
+		inline std::string getDeviceName() const { return _backend.getPhysDeviceProperties().deviceName; }
+		// vkCmdDrawIndexedIndirectCount is optional, check before calling CommandBuffer::cmdDrawIndexedIndirectCount
+		inline bool isDrawIndirectCountSupported() const { return _backend.hasDrawIndirectCount(); }
 		// swapchain
 		InternalTextureHandle acquireCurrentSwapchainTexture();
 
 		inline uint32_t getFrameNum() const { return _swapchain->_currentFrameNum; }
+		// no window, the swapchain is a ring of offscreen textures that can be captured like any other texture
+		inline bool isHeadless() const { return _swapchain->isHeadless(); }
 		inline bool isSwapchainDirty() const { return _swapchain->isDirty(); }
 		inline VkExtent2D getSwapchainExtent() const { return _swapchain->_vkExtent2D; };
 		inline VkImage getCurrentSwapchainImage() const { return _swapchain->getCurrentImage(); }
@@ -259,6 +417,18 @@ namespace Slate {
 		inline AllocatedImage* getTexture(InternalTextureHandle handle) { return _texturePool.get(handle); }
 
 		RenderPipeline* resolveRenderPipeline(InternalPipelineHandle handle);
+		ComputePipeline* resolveComputePipeline(InternalComputePipelineHandle handle);
+		inline const PipelineCacheStats& getPipelineCacheStats() const { return _pipelineCacheStats; }
+		// pipelines thrown away and rebuilt because the bindless descriptor set layout changed
+		inline uint32_t getNumPipelineRebuilds() const { return _numPipelineRebuilds; }
+		inline const StateCacheStats& getStateCacheStats() const { return _stateCacheStats; }
+		// issued vs. filtered state commands of the last submitted command buffer
+		inline const CommandStats& getLastCommandStats() const { return _lastCommandStats; }
+		// compile every registered pipeline that isnt built yet across all worker threads, blocks until done
+		void warmPipelines();
+		inline void setAsyncPipelineCompilation(bool enabled) { _isAsyncPipelineCompilation = enabled; }
+		inline bool isAsyncPipelineCompilation() const { return _isAsyncPipelineCompilation; }
+		uint32_t getNumPendingPipelines() const;
 		inline AllocatedBuffer* getAllocatedBuffer(InternalBufferHandle handle) { return _bufferPool.get(handle); };
 		// this is literally only for the cmd buffer single function, so useless
 		inline RenderPipeline& getPipelineObject(InternalPipelineHandle handle) { return *_pipelinePool.get(handle); }
@@ -266,6 +436,7 @@ namespace Slate {
 		// confusing things
 		void bindDefaultDescriptorSets(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout);
 		void checkAndUpdateDescriptorSets();
+		inline const DescriptorUpdateStats& getDescriptorUpdateStats() const { return _descriptorUpdateStats; }
 		void growDescriptorPool(uint32_t newMaxTextureCount, uint16_t newMaxSamplerCount);
 
 		// execute a task some time in the future after the submit handle finished processing
@@ -276,11 +447,36 @@ namespace Slate {
 		RGBA _clearColor = { 0.1, 0.1, 0.1, 1 };
 
 
-		void upload(InternalBufferHandle handle, const void* data, size_t size, size_t offset = 0);
+		// uploads return right away, the token says when the copy landed, frames recorded afterwards already see the data
+		UploadToken upload(InternalBufferHandle handle, const void* data, size_t size, size_t offset = 0);
 		void download(InternalBufferHandle handle, void* data, size_t size, size_t offset);
 
-		void upload(InternalTextureHandle handle, const void* data, const TexRange& range);
+		UploadToken upload(InternalTextureHandle handle, const void* data, const TexRange& range);
 		void download(InternalTextureHandle handle, void* data, const TexRange& range);
+		bool isUploadComplete(UploadToken token) const;
+		void waitUpload(UploadToken token);
+		inline uint32_t getNumUploadStalls() const { return _staging->getNumStalls(); }
+
+		// downloads that never stall the frame, the copy is submitted right away and the bytes show up a few frames later
+		// either in the callback, run from submitCommand, or through fetchDownload when there is no callback
+		ReadbackToken requestDownload(InternalBufferHandle handle, size_t size, size_t offset = 0, ReadbackCallback callback = nullptr);
+		ReadbackToken requestDownload(InternalTextureHandle handle, const TexRange& range, ReadbackCallback callback = nullptr);
+		bool isDownloadComplete(ReadbackToken token) const;
+		bool fetchDownload(ReadbackToken token, void* data, size_t size);
+		void waitDownload(ReadbackToken token);
+		// writes the texture to disk once its readback lands, .png for 8 bit color formats and .hdr for float ones
+		// swapchain images can only be captured headless, after the frame that drew them was submitted
+		ReadbackToken captureTexture(InternalTextureHandle handle, const std::filesystem::path& path);
+		inline uint32_t getNumPendingDownloads() const { return _readback->getNumPending(); }
+
+		// gpu timings of render passes and CommandBuffer scopes, resolved a few frames after they were recorded
+		inline bool isGPUProfilingSupported() const { return _profiler->isSupported(); }
+		inline void setGPUProfiling(bool enabled) { _profiler->setEnabled(enabled); }
+		inline bool isGPUProfiling() const { return _profiler->isEnabled(); }
+		inline const GPUFrameTimings& getGPUFrameTimings() const { return _profiler->getLatest(); }
+		// oldest first, the last couple hundred resolved frames
+		inline const std::deque<GPUFrameTimings>& getGPUTimingHistory() const { return _profiler->getHistory(); }
+		inline bool saveGPUTimings(const std::filesystem::path& path) const { return _profiler->writeHistory(path); }
 		InternalBufferHandle _globalBufferHandle;
 	private:
 		InternalSamplerHandle _linearSamplerHandle;
@@ -289,10 +485,14 @@ namespace Slate {
 
 		mutable std::vector<DeferredTask> _deferredTasks;
 
-		bool _awaitingCreation = false;
+		DescriptorSlotTracker _textureSlots;
+		DescriptorSlotTracker _samplerSlots;
+		DescriptorUpdateStats _descriptorUpdateStats;
 		bool _awaitingNewImmutableSamplers = false;
 		uint32_t _currentMaxTextureCount = 16;
 		uint16_t _currentMaxSamplerCount = 16;
+		bool _isBindlessPreallocated = false;
+		uint32_t _numPipelineRebuilds = 0;
 
 		VkDescriptorSetLayout _vkGlobalDSL = VK_NULL_HANDLE;
 		VkDescriptorPool _vkGlobalDPool = VK_NULL_HANDLE;
@@ -304,9 +504,26 @@ namespace Slate {
 
 		VkSemaphore _timelineSemaphore = VK_NULL_HANDLE;
 		CommandBuffer _currentCommandBuffer;
+		CommandStats _lastCommandStats = {};
+
+		VkPipelineCache _vkPipelineCache = VK_NULL_HANDLE;
+		std::filesystem::path _pipelineCachePath;
+		PipelineCacheStats _pipelineCacheStats;
+		// hash-consed state objects
+		std::unordered_map<uint64_t, InternalSamplerHandle> _samplerLookup;
+		std::unordered_map<size_t, InternalPipelineHandle> _pipelineLookup;
+		std::unordered_map<PipelineLayoutKey, CachedPipelineLayout, PipelineLayoutKey::Hash> _pipelineLayoutCache;
+		// layouts whose bindless layout was destroyed, only released from here, the driver may hand the old key out again
+		std::vector<CachedPipelineLayout> _retiredPipelineLayouts;
+		StateCacheStats _stateCacheStats;
+		UniquePtr<PipelineCompiler> _pipelineCompiler = nullptr;
+		bool _isAsyncPipelineCompilation = false;
+		std::mutex _recordingMutex; // guards pipeline resolution while secondaries are recorded in parallel
 
 		UniquePtr<VulkanSwapchain> _swapchain = nullptr;
 		UniquePtr<VulkanStagingDevice> _staging = nullptr;
+		UniquePtr<VulkanReadbackDevice> _readback = nullptr;
+		UniquePtr<VulkanProfiler> _profiler = nullptr;
 	public:
 		GXBackend _backend;
 		UniquePtr<VulkanImmediateCommands> _imm = nullptr;
@@ -330,17 +547,37 @@ namespace Slate {
 
 		InternalSamplerHandle createSampler(SamplerSpec spec);
 		InternalPipelineHandle createPipeline(PipelineSpec spec);
+		InternalComputePipelineHandle createComputePipeline(ComputePipelineSpec spec);
 		InternalShaderHandle createShader(ShaderSpec spec);
 
 		MeshData createMesh(const std::vector<Vertex>& vertices);
 		MeshData createMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+		void destroy(const MeshData& mesh);
+		// start of this mesh's vertices, indices are local to the mesh so this is what shaders index into
+		VkDeviceAddress meshVertexAddress(const MeshData& mesh);
+		inline const GeometryAllocation* getGeometryAllocation(const MeshData& mesh) const { return _geometryPool.get(mesh.getGeometryHandle()); }
+		inline InternalBufferHandle getGeometryIndexBuffer() const { return _geometryIndexBuffer; }
+		// packs every live mesh to the front of the arena, blocks on the copy
+		void defragmentGeometry();
+		GeometryArenaStats getGeometryArenaStats() const;
 
 		void destroy(InternalBufferHandle handle);
 		void destroy(InternalTextureHandle handle);
 		void destroy(InternalSamplerHandle handle);
 		void destroy(InternalPipelineHandle handle);
+		void destroy(InternalComputePipelineHandle handle);
 		void destroy(InternalShaderHandle handle);
 
+		// textures of a group take turns in one allocation, their contents are undefined whenever another member was used in between
+		// members keep their handles, the images and views behind them are recreated
+		// call it again when lifetimes change, groups that already share one allocation are left alone and the rest moves over
+		void aliasTextures(const std::vector<std::vector<InternalTextureHandle>>& groups);
+		// 0 if the texture owns its memory
+		uint32_t getTextureAliasGroup(InternalTextureHandle handle) const;
+		VkDeviceSize getTextureMemorySize(InternalTextureHandle handle) const;
+		inline const TransientMemoryStats& getTransientMemoryStats() const { return _transientMemoryStats; }
+		DeviceMemoryStats getDeviceMemoryStats() const;
+
 		VkMemoryRequirements getImageMemoryRequirements(VkImage image) const;
 		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlagBits memPropertyBits) const;
 
@@ -350,13 +587,37 @@ namespace Slate {
 		HandlePool<InternalBufferHandle, AllocatedBuffer> _bufferPool;
 		HandlePool<InternalSamplerHandle, AllocatedSampler> _samplerPool;
 		HandlePool<InternalPipelineHandle, RenderPipeline> _pipelinePool;
+		HandlePool<InternalComputePipelineHandle, ComputePipeline> _computePipelinePool;
+		HandlePool<InternalGeometryHandle, GeometryAllocation> _geometryPool;
+
+		// one vertex and one index buffer shared by every mesh
+		InternalBufferHandle _geometryVertexBuffer;
+		InternalBufferHandle _geometryIndexBuffer;
+		OffsetAllocator _geometryVertexAllocator;
+		OffsetAllocator _geometryIndexAllocator;
+		uint32_t _geometryArenaGeneration = 0; // bumped on rebuild so stale deferred frees dont touch the new layout
+		uint32_t _numGeometryRebuilds = 0;
+
+		struct AliasedMemory {
+			uint32_t group = 0;
+			uint32_t numTextures = 0;
+			VkDeviceSize size = 0;
+			VkDeviceSize requestedSize = 0;
+		};
+		std::unordered_map<VmaAllocation, AliasedMemory> _aliasedMemory;
+		uint32_t _nextAliasGroup = 1;
+		TransientMemoryStats _transientMemoryStats;
 		// these two may be closely intertwined
 
 		friend class VulkanActions;
 		friend class CommandBuffer;
+		friend class FrameGraph;
+		friend class ParallelRecorder;
 		friend class AllocatedBuffer;
 		friend class VulkanSwapchain;
 		friend class VulkanStagingDevice;
+		friend class VulkanReadbackDevice;
+		friend class VulkanProfiler;
 		friend class VulkanImmediateCommands;
 	public:
 		// EDITOR ONLY
@@ -372,5 +633,25 @@ namespace Slate {
 			return {_samplerPool.get(_linearSamplerHandle)->_vkSampler, _texturePool.get(texturehandle)->_vkImageView};
 		}
 		VmaAllocationInfo getImageAllocInfo(InternalTextureHandle handle);
+	private:
+		void _createPipelineCache(const char* path);
+		void _savePipelineCache();
+
+		PipelineBuilder _createPipelineBuilder(PipelineSpec& spec) const;
+		VkPipelineLayout _acquirePipelineLayout(InternalShaderHandle shader, VkShaderStageFlags pushConstantStages);
+		void _releasePipelineLayout(VkPipelineLayout layout);
+		// takes every cached layout built on this bindless layout out of the lookup, call before destroying it
+		void _retirePipelineLayouts(VkDescriptorSetLayout dsl);
+		// destroys a pipeline built against an older bindless layout, it gets rebuilt on the next resolve
+		void _releaseStalePipeline(RenderPipeline& renderPipeline);
+		void _enqueuePipelineCompile(InternalPipelineHandle handle);
+		void _createGeometryArena(uint32_t vertexCapacity, uint32_t indexCapacity);
+		void _rebuildGeometryArena(uint32_t vertexCapacity, uint32_t indexCapacity);
+		GeometryAllocation _allocateGeometry(uint32_t vertexCount, uint32_t indexCount);
+		void _collectCompiledPipelines();
+		void _createImageViews(AllocatedImage& image, VkImageViewType viewType) const;
+		// queues the image, its views and whatever memory only it uses for destruction
+		void _retireImage(const AllocatedImage& image);
+		bool _supportsLazilyAllocatedMemory() const;
 	};
 }
\ No newline at end of file
@@ -22,6 +22,9 @@ namespace Slate {
 		uint32_t graphicsQueueFamilyIndex = Invalid<uint32_t>;
 		VkQueue vkPresentQueue = VK_NULL_HANDLE;
 		uint32_t presentQueueFamilyIndex = Invalid<uint32_t>;
+		// same as graphics when the device has no dedicated transfer family
+		VkQueue vkTransferQueue = VK_NULL_HANDLE;
+		uint32_t transferQueueFamilyIndex = Invalid<uint32_t>;
 	};
 
 	class GXBackend final {
@@ -45,6 +48,11 @@ namespace Slate {
 		inline uint32_t getGraphicsQueueFamilyIndex() const { return _queues.graphicsQueueFamilyIndex; }
 		inline VkQueue getPresentQueue() const { return _queues.vkPresentQueue; };
 		inline uint32_t getPresentQueueFamilyIndex() const { return _queues.presentQueueFamilyIndex; }
+		inline VkQueue getTransferQueue() const { return _queues.vkTransferQueue; };
+		inline uint32_t getTransferQueueFamilyIndex() const { return _queues.transferQueueFamilyIndex; }
+		inline bool hasDedicatedTransferQueue() const { return _queues.transferQueueFamilyIndex != _queues.graphicsQueueFamilyIndex; }
+		inline bool hasPipelineStatistics() const { return _hasPipelineStatistics; }
+		inline bool hasDrawIndirectCount() const { return _hasDrawIndirectCount; }
 
 		inline VkPhysicalDeviceProperties getPhysDeviceProperties() const { return _vkPhysDeviceProperties; };
 #if defined(VK_API_VERSION_1_3)
@@ -78,6 +86,8 @@ namespace Slate {
 		VkPhysicalDeviceVulkan11Properties _vkPhysDeviceVulkan11Properties = {};
 #endif
 		bool _hasSurface = false;
+		bool _hasPipelineStatistics = false;
+		bool _hasDrawIndirectCount = false;
 	private:
 		void _createInstance(vkb::Instance& vkb_instance, VulkanInstanceInfo info);
 		void _createDevices(vkb::Instance& vkb_instance, vkb::Device& vkb_device);
@@ -0,0 +1,37 @@
+//
+// Created by Hayden Rivas on 6/4/25.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+#include "Slate/Common/Invalids.h"
+
+namespace Slate {
+	// hands out [offset, offset + size) ranges from a fixed capacity, units are whatever the caller wants (vertices, indices...)
+	// freed ranges are merged with their neighbours so the arena only fragments as much as the allocation pattern forces it to
+	class OffsetAllocator final {
+	public:
+		static constexpr uint32_t kInvalidOffset = Invalid<uint32_t>;
+
+		OffsetAllocator() = default;
+		explicit OffsetAllocator(uint32_t capacity) { reset(capacity); }
+	public:
+		// returns kInvalidOffset when no free range is big enough
+		uint32_t allocate(uint32_t size);
+		void free(uint32_t offset, uint32_t size);
+		// forgets every allocation
+		void reset(uint32_t capacity);
+
+		inline uint32_t getCapacity() const { return _capacity; }
+		inline uint32_t getUsed() const { return _used; }
+		inline uint32_t getNumFreeRanges() const { return static_cast<uint32_t>(_freeRanges.size()); }
+		uint32_t getLargestFreeRange() const;
+	private:
+		std::map<uint32_t, uint32_t> _freeRanges; // offset -> size
+		uint32_t _capacity = 0;
+		uint32_t _used = 0;
+	};
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <volk.h>
+
+#include "Slate/CommandBuffer.h"
+#include "Slate/SubmitHandle.h"
+
+namespace Slate {
+	// forward declare
+	class GX;
+
+	// records the draws of one render pass on several threads at once
+	// every thread owns its command pools, one per frame in flight, so nothing in here is shared with the immediate commands
+	// the primary has to be inside cmdBeginRendering(..., RenderingContents::Secondary)
+	class ParallelRecorder final {
+	public:
+		using RecordFn = std::function<void(CommandBuffer& cmd, uint32_t task)>;
+
+		// numThreads extra workers, the calling thread records too so zero just records serially
+		ParallelRecorder(GX& gx, uint32_t numThreads);
+		~ParallelRecorder();
+
+		ParallelRecorder(const ParallelRecorder&) = delete;
+		ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+	public:
+		// calls fn once per task, each task into its own secondary, and executes them into primary in task order
+		// blocks until every task is recorded, fn must only touch gx through the command buffer it is handed
+		void record(CommandBuffer& primary, uint32_t numTasks, const RecordFn& fn);
+
+		inline uint32_t getNumThreads() const { return static_cast<uint32_t>(_workers.size()) + 1; }
+	private:
+		struct ThreadPool {
+			VkCommandPool pool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> buffers;
+			uint32_t numUsed = 0;
+		};
+		// a slot is reset once the primary that executed it finished, three is enough for that to never stall
+		static constexpr uint32_t kNumFrameSlots = 3;
+
+		void _workerLoop(uint32_t thread);
+		void _recordTasks(uint32_t thread);
+		void _advanceSlot(const CommandBuffer& primary);
+		VkCommandBuffer _acquireSecondary(uint32_t thread);
+	private:
+		GX& _gx;
+		std::vector<std::thread> _workers;
+		// [slot][thread]
+		std::vector<ThreadPool> _pools[kNumFrameSlots];
+		SubmitHandle _slotSubmits[kNumFrameSlots] = {};
+		uint32_t _slot = 0;
+		uint64_t _currentSubmit = 0;
+
+		// the job being recorded, only written while every worker is parked
+		std::mutex _mutex;
+		std::condition_variable _jobAvailable;
+		std::condition_variable _jobFinished;
+		const RecordFn* _fn = nullptr;
+		const CommandBuffer* _primary = nullptr;
+		std::vector<CommandBuffer>* _secondaries = nullptr;
+		uint32_t _numTasks = 0;
+		std::atomic<uint32_t> _nextTask = 0;
+		uint32_t _numBusy = 0;
+		uint64_t _jobId = 0;
+		bool _isStopping = false;
+	};
+}
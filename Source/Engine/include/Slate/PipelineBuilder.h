@@ -25,7 +25,8 @@ namespace Slate {
 		FastVector<VkPipelineShaderStageCreateInfo, 2> _shaderStages = {};
 		FastVector<VkFormat, 12> _colorAttachmentFormats = {};
 	public:
-		VkPipeline build(VkDevice device, VkPipelineLayout layout);
+		// outCacheHit is set when the driver reports the pipeline came out of the given cache
+		VkPipeline build(VkDevice device, VkPipelineLayout layout, VkPipelineCache cache = VK_NULL_HANDLE, bool* outCacheHit = nullptr);
 		void Clear();
 	public:
 		// program
@@ -48,4 +49,6 @@ namespace Slate {
 		void _setBlendtoAlphaBlend();
 		void _setBlendtoAdditive();
 	};
+	// compute pipelines only have the one stage, nothing to configure
+	VkPipeline BuildComputePipeline(VkDevice device, VkShaderModule module, const char* entryPoint, VkPipelineLayout layout, VkPipelineCache cache = VK_NULL_HANDLE, bool* outCacheHit = nullptr);
 }
\ No newline at end of file
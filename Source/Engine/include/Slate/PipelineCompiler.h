@@ -0,0 +1,69 @@
+//
+// Created by Hayden Rivas on 6/2/25.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <volk.h>
+
+#include "Slate/Common/Handles.h"
+#include "Slate/PipelineBuilder.h"
+
+namespace Slate {
+	// everything a worker needs to build a pipeline without ever touching the GX pools
+	struct PipelineCompileJob
+	{
+		InternalPipelineHandle handle;
+		PipelineBuilder builder;
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout dsl = VK_NULL_HANDLE; // bindless layout the pipeline layout was made against
+	};
+	struct PipelineCompileResult
+	{
+		InternalPipelineHandle handle;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout dsl = VK_NULL_HANDLE;
+		bool cacheHit = false;
+	};
+
+	// small pool of worker threads that turn PipelineBuilders into VkPipelines off the render thread
+	// results are only ever handed back through collect(), which GX calls on the render thread
+	class PipelineCompiler final {
+	public:
+		PipelineCompiler(VkDevice device, VkPipelineCache cache, uint32_t numThreads);
+		~PipelineCompiler();
+
+		PipelineCompiler(const PipelineCompiler&) = delete;
+		PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+	public:
+		void enqueue(PipelineCompileJob&& job);
+		// non-blocking, moves all finished results into out
+		void collect(std::vector<PipelineCompileResult>& out);
+		// blocks until every enqueued job has finished
+		void waitIdle();
+
+		inline uint32_t getNumThreads() const { return static_cast<uint32_t>(_workers.size()); }
+		uint32_t getNumPending() const;
+	private:
+		void _workerLoop();
+	private:
+		VkDevice _vkDevice = VK_NULL_HANDLE;
+		VkPipelineCache _vkPipelineCache = VK_NULL_HANDLE;
+
+		std::vector<std::thread> _workers;
+		mutable std::mutex _mutex;
+		std::condition_variable _jobAvailable;
+		std::condition_variable _jobFinished;
+
+		std::deque<PipelineCompileJob> _jobs;
+		std::vector<PipelineCompileResult> _results;
+		uint32_t _numInFlight = 0;
+		bool _isStopping = false;
+	};
+}
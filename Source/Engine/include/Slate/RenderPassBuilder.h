@@ -27,19 +27,31 @@ namespace Slate {
 		ResolveMode resolveMode = ResolveMode::SAMPLE_ZERO;
 	};
 
+	// assembles a RenderPass attachment by attachment, clear values are only kept when the load op clears
 	class RenderPassBuilder {
 	public:
 		RenderPassBuilder() { Clear(); }
 		~RenderPassBuilder() = default;
 	public:
-		RenderPassBuilder& addColorAttachment(InternalTextureHandle texture);
-		RenderPassBuilder& addDepthStencilAttachment(InternalTextureHandle texture);
-
-		RenderPassBuilder& addMultisampledColorAttachment();
-
+		RenderPassBuilder& addColorAttachment(InternalTextureHandle texture, LoadOperation loadOp, StoreOperation storeOp, Optional<RGBA> clear = std::nullopt);
+		RenderPassBuilder& addDepthStencilAttachment(InternalTextureHandle texture, LoadOperation loadOp, StoreOperation storeOp, Optional<float> clear = std::nullopt);
+		RenderPassBuilder& addMultisampledColorAttachment(InternalTextureHandle texture, InternalTextureHandle resolveTexture, LoadOperation loadOp, StoreOperation storeOp,
+														  ResolveMode resolveMode = ResolveMode::AVERAGE, Optional<RGBA> clear = std::nullopt);
+		RenderPassBuilder& addMultisampledDepthStencilAttachment(InternalTextureHandle texture, InternalTextureHandle resolveTexture, LoadOperation loadOp, StoreOperation storeOp,
+																 ResolveMode resolveMode = ResolveMode::SAMPLE_ZERO, Optional<float> clear = std::nullopt);
+
+		RenderPassBuilder& addColorAttachment(const ColorAttachment& attachment);
+		RenderPassBuilder& addDepthStencilAttachment(const DepthStencilAttachment& attachment);
+		RenderPassBuilder& addMultisampledColorAttachment(const MultisampledColorAttachment& attachment, InternalTextureHandle resolveTexture);
+		RenderPassBuilder& addMultisampledDepthStencilAttachment(const MultisampledDepthStencilAttachment& attachment, InternalTextureHandle resolveTexture);
+
+		inline const RenderPass& getRenderPass() const { return _pass; }
+		inline uint32_t getNumColorAttachments() const { return _numColorAttachments; }
+		inline bool hasDepthAttachment() const { return _pass.depth.texture.valid(); }
 	private:
 		void Clear();
 	private:
-
+		RenderPass _pass = {};
+		uint32_t _numColorAttachments = 0;
 	};
-}
\ No newline at end of file
+}
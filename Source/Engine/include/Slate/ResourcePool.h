@@ -85,7 +85,7 @@ namespace Slate {
 			// destruction made need to be rewritten
 			_objects[index]._obj = T{};
 			_objects[index]._gen++;
-			_objects[index]._nextFree = _firstFreeIndex;
+			_objects[index]._nextFreeIndex = _firstFreeIndex;
 			_firstFreeIndex = index;
 			_numObjects--;
 		}
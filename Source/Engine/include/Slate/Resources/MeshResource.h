@@ -10,19 +10,28 @@
 
 #include <array>
 #include <volk.h>
+#include <glm/vec4.hpp>
 
 namespace Slate {
 
+	// where a mesh lives inside the GX geometry arena, offsets are in vertices/indices and move when the arena is defragmented
+	struct GeometryAllocation {
+		uint32_t vertexOffset = 0;
+		uint32_t vertexCount = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		glm::vec4 bounds = {}; // bounding sphere in mesh space, center + radius, for culling
+	};
+
 	class MeshData final {
 	public:
-		const InternalBufferHandle & getVertexBufferHandle() const { return _vertexBuffer; }
-		const InternalBufferHandle & getIndexBufferHandle() const { return _indexBuffer; }
+		// the arena owns the actual buffers, resolve offsets through GX (meshVertexAddress, cmdDrawMesh)
+		const InternalGeometryHandle& getGeometryHandle() const { return _geometry; }
 		uint32_t getVertexCount() const { return _vertexCount; }
 		uint32_t getIndexCount() const { return _indexCount; }
+		bool isIndexed() const { return _indexCount > 0; }
 	private:
-		InternalBufferHandle _indexBuffer;
-		InternalBufferHandle _vertexBuffer;
-		VkDeviceAddress _vertexBufferAddress = 0;
+		InternalGeometryHandle _geometry;
 		uint32_t _vertexCount = 0;
 		uint32_t _indexCount = 0;
 
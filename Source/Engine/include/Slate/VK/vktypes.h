@@ -3,6 +3,7 @@
 //
 #pragma once
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/detail/type_mat4x4.hpp>
 #include <vk_mem_alloc.h>
@@ -115,6 +116,48 @@ namespace Slate {
 			alignas(8) VkDeviceAddress vertexBufferAddress;
 			alignas(4) uint32_t id;
 		};
+		// one per indirect draw, shaders fetch it with SV_DrawIndex instead of getting it through push constants
+		struct DrawData {
+			alignas(8) VkDeviceAddress vertexBufferAddress;
+			alignas(4) uint32_t firstInstance; // into the InstanceData array, add SV_InstanceID
+			uint32_t _pad0;
+		};
+		static_assert(sizeof(DrawData) == 16, "DrawData must match its shader counterpart");
+		// one per drawn entity, every entity sharing a mesh + pipeline becomes one instance of the same draw
+		struct InstanceData {
+			alignas(16) glm::mat4 modelMatrix;
+			alignas(4) uint32_t id;
+			uint32_t _pad0[3];
+		};
+		static_assert(sizeof(InstanceData) == 80, "InstanceData must match its shader counterpart");
+		struct DrawListPushConstants {
+			alignas(8) VkDeviceAddress drawDataAddress;
+			alignas(8) VkDeviceAddress instanceDataAddress;
+		};
+		// one per draw list command, what the culling pass needs to rebuild it with only the visible instances
+		struct CullCommand {
+			alignas(16) glm::vec4 bounds; // mesh space bounding sphere, center + radius
+			alignas(8) VkDeviceAddress vertexBufferAddress;
+			alignas(4) uint32_t indexCount;
+			uint32_t firstIndex;
+			uint32_t firstInstance;
+			uint32_t batch;             // draw count slot of the pipeline batch this command belongs to
+			uint32_t batchFirstCommand; // compacted commands of a batch are packed from here
+			uint32_t _pad0;
+		};
+		static_assert(sizeof(CullCommand) == 48, "CullCommand must match its shader counterpart");
+		struct CullPushConstants {
+			alignas(8) VkDeviceAddress cullCommandAddress;
+			alignas(8) VkDeviceAddress instanceDataAddress;
+			alignas(8) VkDeviceAddress instanceCommandAddress; // command index of every instance
+			alignas(8) VkDeviceAddress culledCommandAddress;
+			alignas(8) VkDeviceAddress culledDrawDataAddress;
+			alignas(8) VkDeviceAddress culledInstanceAddress;
+			alignas(8) VkDeviceAddress countAddress; // draw count per batch, then visible instances per command
+			alignas(4) uint32_t numInstances;
+			uint32_t numCommands;
+			uint32_t numBatches;
+		};
 	}
 	enum class MaterialPassType : uint8_t {
 		Opaque,
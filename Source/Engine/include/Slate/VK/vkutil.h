@@ -14,6 +14,8 @@ namespace Slate::vkutil {
 	uint32_t GetTextureBytesPerPlane(uint32_t width, uint32_t height, VkFormat format, uint32_t plane);
 	uint32_t GetTextureBytesPerLayer(uint32_t width, uint32_t height, VkFormat format, uint32_t level);
 	uint32_t GetBytesPerPixel(VkFormat format);
+	// texels per compressed block, 1x1 for everything else
+	VkExtent2D GetFormatBlockExtent(VkFormat format);
 	uint32_t GetNumImagePlanes(VkFormat format);
 	VkExtent2D GetImagePlaneExtent(VkExtent2D plane0, VkFormat format, uint32_t plane);
 
@@ -7,6 +7,7 @@
 #include <slang/slang.h>
 #include <vk_mem_alloc.h>
 #include <volk.h>
+#include <vector>
 
 
 namespace Slate {
@@ -16,6 +17,9 @@ namespace Slate {
 	struct AllocatedSampler final {
 		VkSampler _vkSampler = VK_NULL_HANDLE;
 		char debugName[256] = {0};
+		// identical specs share one sampler, the last destroy() actually frees it
+		uint64_t _cacheKey = 0;
+		uint32_t _refCount = 1;
 	};
 
 	struct AllocatedImage final {
@@ -32,7 +36,12 @@ namespace Slate {
 		[[nodiscard]] inline VkSampleCountFlagBits getSampleCount() const { return _vkSampleCountFlagBits; }
 		[[nodiscard]] inline VkImageType getType() const { return _vkImageType; }
 		[[nodiscard]] inline VkImageLayout getLayout() const { return _vkCurrentImageLayout; }
+		[[nodiscard]] inline bool isLayoutUniform() const { return _subresourceLayouts.empty(); }
+		[[nodiscard]] VkImageLayout getSubresourceLayout(uint32_t level, uint32_t layer) const;
 	private:
+		void _setLayout(VkImageLayout layout);
+		void _setSubresourceLayout(const VkImageSubresourceRange& range, VkImageLayout layout);
+
 		VkImage _vkImage = VK_NULL_HANDLE;
 		VkImageView _vkImageView = VK_NULL_HANDLE;
 		VkImageView _vkImageViewStorage = VK_NULL_HANDLE;
@@ -43,7 +52,8 @@ namespace Slate {
 		uint32_t _numLevels = 1u;
 		uint32_t _numLayers = 1u;
 
-		VkImageLayout _vkCurrentImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageLayout _vkCurrentImageLayout = VK_IMAGE_LAYOUT_UNDEFINED; // of the first subresource when the layout is not uniform
+		std::vector<VkImageLayout> _subresourceLayouts; // [level * _numLayers + layer], empty while every subresource shares one layout
 		VkImageType _vkImageType = VK_IMAGE_TYPE_MAX_ENUM;
 		VkImageUsageFlags _vkUsageFlags = 0;
 		VkSampleCountFlagBits _vkSampleCountFlagBits = VK_SAMPLE_COUNT_1_BIT;
@@ -54,12 +64,15 @@ namespace Slate {
 		bool _isResolveAttachment = false;
 		bool _isSwapchainImage = false;
 		bool _isOwning = true;
+		bool _isLazilyAllocated = false;
+		uint32_t _aliasGroup = 0; // shares _vmaAllocation with other textures, see GX::aliasTextures
 		char _debugName[256] = {0};
 
 		friend class GX;
 		friend class GXBackend;
 		friend class VulkanActions;
 		friend class CommandBuffer;
+		friend class FrameGraph;
 		friend class VulkanSwapchain;
 		friend class VulkanStagingDevice;
 	};
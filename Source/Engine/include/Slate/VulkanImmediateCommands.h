@@ -42,16 +42,23 @@ namespace Slate {
 
 		void waitSemaphore(VkSemaphore semaphore);
 		void signalSemaphore(VkSemaphore semaphore, uint64_t signalValue);
+		// the next submit waits until the timeline semaphore reaches waitValue
+		void waitTimelineSemaphore(VkSemaphore semaphore, uint64_t waitValue);
 
 		inline VkSemaphore acquireLastSubmitSemaphore() { return std::exchange(_lastSubmitSemaphore.semaphore, VK_NULL_HANDLE); }
 		inline SubmitHandle getLastSubmitHandle() const { return _lastSubmitHandle; };
 		inline SubmitHandle getNextSubmitHandle() const { return _nextSubmitHandle; };
+		// every submit signals the next value, other queues wait on it to order themselves after this one
+		inline VkSemaphore getSubmitTimeline() const { return _vkSubmitTimeline; }
+		inline uint64_t getLastSubmitTimelineValue() const { return _submitTimelineValue; }
 	private:
 		void _purge();
 	private:
 		VkDevice _vkDevice; // injected
 
 		VkCommandPool _vkCommandPool = VK_NULL_HANDLE;
+		VkSemaphore _vkSubmitTimeline = VK_NULL_HANDLE;
+		uint64_t _submitTimelineValue = 0;
 
 		VkSemaphoreSubmitInfo _lastSubmitSemaphore = {
 				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
@@ -61,6 +68,10 @@ namespace Slate {
 				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
 				.stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
 		};
+		VkSemaphoreSubmitInfo _waitTimelineSemaphore = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+		};
 		VkSemaphoreSubmitInfo _signalSemaphore = {
 				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
 				.stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
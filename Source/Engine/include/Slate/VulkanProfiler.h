@@ -0,0 +1,113 @@
+#pragma once
+
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <volk.h>
+
+#include "Slate/SubmitHandle.h"
+
+namespace Slate {
+	// forward declare
+	class GX;
+
+	struct GPUScopeTiming
+	{
+		std::string name;
+		uint32_t depth = 0; // how many scopes were open around this one
+		double milliseconds = 0.0;
+		// only collected around render passes recorded inline, and only when the device supports pipeline statistics
+		bool hasStatistics = false;
+		uint64_t primitives = 0;
+		uint64_t vertexInvocations = 0;
+		uint64_t clippedPrimitives = 0;
+		uint64_t fragmentInvocations = 0;
+	};
+	struct GPUFrameTimings
+	{
+		uint64_t frameNum = 0;
+		double milliseconds = 0.0; // first timestamp of the frame to its last
+		std::vector<GPUScopeTiming> scopes; // in the order they were opened
+	};
+
+	// every frame gets its own pair of query pools, results are read once the frame's last submit retired
+	// so nothing ever waits on the gpu unless the frames wrap around before the oldest one finished
+	class VulkanProfiler final {
+	public:
+		explicit VulkanProfiler(GX& ctx);
+		~VulkanProfiler();
+
+		VulkanProfiler(const VulkanProfiler&) = delete;
+		VulkanProfiler& operator=(const VulkanProfiler&) = delete;
+	public:
+		static constexpr uint32_t kInvalidScope = UINT32_MAX;
+
+		// the first command buffer of a frame resets its queries, has to be called outside of a render pass
+		void beginCommandBuffer(VkCommandBuffer cmd);
+		// kInvalidScope when profiling is off or the frame ran out of queries, endScope ignores it
+		uint32_t beginScope(VkCommandBuffer cmd, const char* name, bool collectStatistics);
+		void endScope(VkCommandBuffer cmd, uint32_t scope);
+		// the presenting submit closes the frame
+		void onSubmit(SubmitHandle handle, bool isEndOfFrame);
+		// resolves every finished frame, never waits
+		void process();
+
+		inline bool isSupported() const { return _timestampValidBits != 0; }
+		inline bool supportsStatistics() const { return _hasStatistics; }
+		inline bool isEnabled() const { return _isEnabled; }
+		inline void setEnabled(bool enabled) { _isEnabled = enabled && isSupported(); }
+
+		// newest resolved frame, a few frames behind the one being recorded
+		inline const GPUFrameTimings& getLatest() const { return _history.empty() ? _empty : _history.back(); }
+		inline const std::deque<GPUFrameTimings>& getHistory() const { return _history; }
+		// one csv row per scope of every frame still in the history
+		bool writeHistory(const std::filesystem::path& path) const;
+		// frames that had to be waited on because every query pool was still in flight
+		inline uint32_t getNumStalls() const { return _numStalls; }
+	private:
+		static constexpr uint32_t kNumFrames = 4;
+		static constexpr uint32_t kMaxTimestamps = 512;
+		static constexpr uint32_t kMaxStatistics = 128;
+		static constexpr uint32_t kMaxHistory = 240;
+		struct Scope {
+			std::string name;
+			uint32_t depth = 0;
+			uint32_t beginQuery = 0;
+			uint32_t endQuery = 0;
+			uint32_t statisticsQuery = kInvalidScope;
+			bool isOpen = true;
+		};
+		struct Frame {
+			VkQueryPool timestampPool = VK_NULL_HANDLE;
+			VkQueryPool statisticsPool = VK_NULL_HANDLE;
+			std::vector<Scope> scopes;
+			uint32_t numTimestamps = 0;
+			uint32_t numStatistics = 0;
+			uint64_t frameNum = 0;
+			SubmitHandle handle_ = {};
+			bool isReset = false;   // queries reset in this frame's first command buffer, scopes can be recorded
+			bool isPending = false; // closed and submitted, waiting on the gpu
+		};
+
+		// false while the gpu has not written every query yet
+		bool _resolve(Frame& frame);
+	private:
+		GX& _gx;
+
+		Frame _frames[kNumFrames] = {};
+		uint32_t _current = 0;
+		uint32_t _numOpenScopes = 0;
+		uint64_t _frameNum = 0;
+		bool _isEnabled = false;
+		bool _hasStatistics = false;
+		uint32_t _timestampValidBits = 0;
+		double _timestampPeriod = 1.0; // nanoseconds per tick
+
+		std::deque<GPUFrameTimings> _history;
+		const GPUFrameTimings _empty = {};
+		std::vector<uint64_t> _results; // scratch for vkGetQueryPoolResults
+		uint32_t _numStalls = 0;
+		bool _hasWarnedOverflow = false;
+	};
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <volk.h>
+
+#include "Slate/Common/Handles.h"
+#include "Slate/SubmitHandle.h"
+#include "Slate/VkObjects.h"
+#include "Slate/Common/SmartObject.h"
+
+namespace Slate {
+	// forward declare
+	class GX;
+
+	// handed out by download requests, ids grow with every request and readbacks finish in the same order
+	struct ReadbackToken
+	{
+		uint64_t id = 0;
+		inline bool empty() const { return id == 0; }
+	};
+	// the bytes are only valid for the duration of the call, copy out whatever has to live longer
+	using ReadbackCallback = std::function<void(std::span<const uint8_t> data)>;
+
+	// copies go out on graphics right away and land in a host visible ring, nothing waits on the gpu unless the ring is full
+	// finished readbacks reach their callback from process(), readbacks without one are kept until they are fetched
+	class VulkanReadbackDevice final {
+	public:
+		explicit VulkanReadbackDevice(GX& ctx);
+		~VulkanReadbackDevice();
+
+		VulkanReadbackDevice(const VulkanReadbackDevice&) = delete;
+		VulkanReadbackDevice& operator=(const VulkanReadbackDevice&) = delete;
+	public:
+		ReadbackToken requestBuffer(AllocatedBuffer& buffer, size_t offset, size_t size, ReadbackCallback callback);
+		ReadbackToken requestImage(AllocatedImage& image,
+								   const VkOffset3D& offset,
+								   const VkExtent3D& extent,
+								   VkImageSubresourceRange range,
+								   VkFormat format,
+								   ReadbackCallback callback);
+
+		// hands every finished readback over, oldest first, call once a frame
+		// callbacks may request new readbacks and wait on them, whatever finishes meanwhile is handed over after them
+		void process();
+		bool isReady(ReadbackToken token) const;
+		// copies a finished readback without a callback out and forgets it, false while it is still running
+		bool fetch(ReadbackToken token, void* outData, size_t size);
+		void wait(ReadbackToken token);
+
+		// how often a request had to wait on the gpu for ring memory
+		inline uint32_t getNumStalls() const { return _numStalls; }
+		inline uint32_t getNumPending() const { return (uint32_t)_inFlight.size(); }
+	private:
+		static constexpr uint32_t kReadbackAlignment = 16;
+		struct Request {
+			uint64_t id = 0;
+			uint32_t offset_ = 0;
+			uint32_t size_ = 0; // ring bytes held, may include the padding skipped on wrap
+			uint32_t dataSize_ = 0;
+			SubmitHandle handle_ = {};
+			ReadbackCallback callback;
+		};
+		// the ring region is given back before the callback runs, so the bytes are copied out of it
+		struct Finished {
+			ReadbackCallback callback;
+			std::vector<uint8_t> data;
+		};
+
+		// ring offset of alignedSize free bytes, waits for the oldest readbacks until they are contiguous
+		uint32_t _allocate(uint32_t alignedSize);
+		void _ensureBufferSize(uint32_t sizeNeeded);
+		ReadbackToken _push(uint32_t offset, uint32_t alignedSize, uint32_t dataSize, SubmitHandle handle, ReadbackCallback&& callback);
+		void _completeOldest();
+		// runs the callbacks of finished readbacks outside of any ring bookkeeping, nested calls leave them to the outer one
+		void _runCallbacks();
+	private:
+		GX& _gx;
+
+		Holder<InternalBufferHandle> _readbackBuffer;
+		uint32_t _bufferSize = 0;
+		uint32_t _maxBufferSize = 0;
+		const uint32_t _minBufferSize = 2048u * 2048u * 4u;
+		uint32_t _bufferCounter = 0;
+
+		std::deque<Request> _inFlight; // oldest first
+		uint32_t _head = 0;
+		std::unordered_map<uint64_t, std::vector<uint8_t>> _unclaimed; // finished readbacks nobody fetched yet
+		std::deque<Finished> _finished; // oldest first, waiting for their callback
+		uint64_t _nextId = 1;
+		uint64_t _lastCompletedId = 0;
+		bool _isCompleting = false;
+		uint32_t _numStalls = 0;
+	};
+}
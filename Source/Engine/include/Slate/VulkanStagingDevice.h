@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <deque>
+#include <span>
 #include <vector>
 #include <volk.h>
 
 #include "Slate/Common/Handles.h"
+#include "Slate/SmartPointers.h"
 #include "Slate/SubmitHandle.h"
 #include "Slate/VkObjects.h"
+#include "Slate/VulkanImmediateCommands.h"
 #include "Slate/Common/SmartObject.h"
 
 namespace Slate {
@@ -18,17 +22,26 @@ namespace Slate {
 
 	constexpr uint8_t kMaxMipLevels = 16;
 
+	// handed out by uploads, the staging memory is free and the data landed once it is ready
+	// graphics work submitted afterwards already waits on it, only the cpu has to ask
+	struct UploadToken
+	{
+		SubmitHandle handle = {};
+		inline bool empty() const { return handle.empty(); }
+	};
+
 	class VulkanStagingDevice final {
 	public:
 		explicit VulkanStagingDevice(GX& ctx);
-		~VulkanStagingDevice() = default;
+		~VulkanStagingDevice();
 
 		VulkanStagingDevice(const VulkanStagingDevice&) = delete;
 		VulkanStagingDevice& operator=(const VulkanStagingDevice&) = delete;
 		Holder<InternalBufferHandle> _stagingBuffer;
 	public:
-		void bufferSubData(AllocatedBuffer& buffer, size_t dstOffset, size_t size, const void* data);
-		void imageData2D(AllocatedImage& image,
+		// none of these wait on the gpu unless every staging region is still in flight
+		UploadToken bufferSubData(AllocatedBuffer& buffer, size_t dstOffset, size_t size, const void* data);
+		UploadToken imageData2D(AllocatedImage& image,
 						 const VkRect2D& imageRegion,
 						 uint32_t baseMipLevel,
 						 uint32_t numMipLevels,
@@ -36,13 +49,22 @@ namespace Slate {
 						 uint32_t numLayers,
 						 VkFormat format,
 						 const void* data);
-		void imageData3D(AllocatedImage& image, const VkOffset3D& offset, const VkExtent3D& extent, VkFormat format, const void* data);
+		UploadToken imageData3D(AllocatedImage& image, const VkOffset3D& offset, const VkExtent3D& extent, VkFormat format, const void* data);
 		void getImageData(AllocatedImage& image,
 						  const VkOffset3D& offset,
 						  const VkExtent3D& extent,
 						  VkImageSubresourceRange range,
 						  VkFormat format,
 						  void* outData);
+
+		// uploads are copied on a dedicated transfer queue when the device has one, readbacks always stay on graphics
+		inline bool isUsingTransferQueue() const { return _transferImm != nullptr; }
+		// the next submit of imm starts after every copy issued so far, nothing without a transfer queue
+		void orderAfterUploads(VulkanImmediateCommands& imm) const;
+		bool isReady(UploadToken token) const;
+		void wait(UploadToken token);
+		// how often an upload had to wait on the gpu for staging memory
+		inline uint32_t getNumStalls() const { return _numStalls; }
 	private:
 		static constexpr int kStagingBufferAlignment = 16;
 		struct MemoryRegionDesc {
@@ -51,17 +73,57 @@ namespace Slate {
 			SubmitHandle handle_ = {};
 		};
 
+		// one subresource of an image copy, texels are tightly packed starting at dataOffset
+		struct ImageCopyRegion {
+			uint32_t mipLevel = 0;
+			uint32_t layer = 0;
+			VkOffset3D offset = {};
+			VkExtent3D extent = {};
+			size_t dataOffset = 0;
+		};
+		// streams the copies through the staging buffer in bands of block rows, so images of any size go through bounded memory
+		UploadToken _uploadImageBands(AllocatedImage& image, VkImageAspectFlags aspect, VkFormat format, std::span<const ImageCopyRegion> copies, const void* data);
+		// as much of remaining as is free right now, but never less than one band of minSize
+		MemoryRegionDesc _getBandRegion(size_t remaining, uint32_t minSize);
+		// hands the used front of a region back with its handle and the rest as free
+		void _releaseRegion(const MemoryRegionDesc& desc, uint32_t usedSize);
+
+		// may hand back less than asked for, callers that can split their copies use this
 		MemoryRegionDesc getNextFreeOffset(uint32_t size);
+		// always at least size, waits for the oldest regions one at a time until enough is contiguous
+		MemoryRegionDesc _getContiguousRegion(uint32_t size);
+		// the staging buffer is a ring, regions are taken at the head and retire from the tail in submission order
+		// one region is open at a time and has to go back through _releaseRegion before the next one is taken
+		MemoryRegionDesc _allocateRegion(uint32_t alignedSize, bool allowSmaller);
+		MemoryRegionDesc _takeRegion(uint32_t size);
+		void _retireRegions();
 		void ensureStagingBufferSize(uint32_t sizeNeeded);
 		void waitAndReset();
+
+		// the queue uploads are recorded on, every region handle belongs to it
+		VulkanImmediateCommands& _copyCommands() const;
+		// barriers are written as if everything ran on graphics, with a transfer queue they become a release/acquire pair
+		// and graphics waits on the transfer timeline before it touches the copied resources
+		// the next transfer submit waits on everything graphics submitted so far, nothing without a transfer queue
+		void _waitForGraphics();
+		SubmitHandle _submitCopy(const VulkanImmediateCommands::CommandBufferWrapper& wrapper,
+								 std::span<VkImageMemoryBarrier2> imageBarriers,
+								 std::span<VkBufferMemoryBarrier2> bufferBarriers);
 	private:
 		GX& _gx;
 
+		UniquePtr<VulkanImmediateCommands> _transferImm = nullptr;
+		VkSemaphore _vkTransferSemaphore = VK_NULL_HANDLE;
+		uint64_t _transferSemaphoreValue = 0;
+
 		uint32_t _stagingBufferSize = 0;
 		uint32_t _stagingBufferCounter = 0;
 		uint32_t _maxBufferSize = 0;
 		const uint32_t _minBufferSize = 4u * 2048u * 2048u;
-		std::vector<MemoryRegionDesc> _regions;
+		std::deque<MemoryRegionDesc> _inFlight; // oldest first
+		uint32_t _head = 0;
+		bool _hasOpenRegion = false;
+		uint32_t _numStalls = 0;
 	};
 
 }
\ No newline at end of file
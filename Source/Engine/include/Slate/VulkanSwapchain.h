@@ -16,8 +16,10 @@ namespace Slate {
 	class AllocatedImage;
 
 	// lets try to abide RAII!
+	// without a surface it turns into a ring of offscreen textures, acquire and present only cycle through them
 	class VulkanSwapchain final {
 		enum { kMAX_SWAPCHAIN_IMAGES = 16 };
+		enum { kNUM_HEADLESS_IMAGES = 3 };
 	public:
 		explicit VulkanSwapchain(GX& gx, uint16_t width = 0, uint16_t height = 0);
 		~VulkanSwapchain();
@@ -31,11 +33,15 @@ namespace Slate {
 
 		inline uint32_t getNumOfSwapchainImages() const { return _numSwapchainImages; }
 		inline bool isDirty() const { return _isDirty; }
+		inline bool isHeadless() const { return _isHeadless; }
+		// offscreen images have no present layout, they wait in transfer src so they can be captured
+		inline VkImageLayout getPresentLayout() const { return _isHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
 
 		VkImageLayout _vkCurrentImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	private:
 		// helper
 		AllocatedImage& _getCurrentTexture() const;
+		void _createHeadless(uint16_t width, uint16_t height);
 		VkSwapchainKHR _vkSwapchain = VK_NULL_HANDLE;
 		VkExtent2D _vkExtent2D = {};
 		VkFormat _vkImageFormat = VK_FORMAT_UNDEFINED;
@@ -45,6 +51,7 @@ namespace Slate {
 		uint32_t _numSwapchainImages = 0;
 		bool _isDirty = false;
 		bool _getNextImage = true;
+		bool _isHeadless = false;
 
 		InternalTextureHandle _swapchainTextures[kMAX_SWAPCHAIN_IMAGES] = {};
 		uint64_t _timelineWaitValues[kMAX_SWAPCHAIN_IMAGES] = {}; // this HERE NEEDS FIXING
@@ -53,6 +60,7 @@ namespace Slate {
 		// injected info
 		GX& _gxCtx;
 		friend class GX; // for present
+		friend class CommandBuffer; // headless images track their layout
 	};
 
 }
\ No newline at end of file
@@ -45,11 +45,21 @@ namespace Slate {
 	}
 
 	void Application::start() {
-		int result = glfwInit();
-		ASSERT_MSG(result == GLFW_TRUE, "[GLFW] Failed to initialize GLFW.");
+		if (!_isHeadless) {
+			int result = glfwInit();
+			ASSERT_MSG(result == GLFW_TRUE, "[GLFW] Failed to initialize GLFW.");
+		}
 		this->onInitialize();
 	}
 	void Application::loop() {
+		if (_isHeadless) {
+			this->onTick();
+			this->onRender();
+			_numHeadlessFrames++;
+			if (_maxHeadlessFrames != 0 && _numHeadlessFrames >= _maxHeadlessFrames) { callStop(); }
+			_apptime.update();
+			return;
+		}
 		glfwPollEvents();
 		{
 			this->onTick();
@@ -68,6 +78,10 @@ namespace Slate {
 	}
 	void Application::stop() {
 		this->onShutdown();
+		if (_isHeadless) {
+			_gx.destroy();
+			return;
+		}
 		_window.destroy();
 		_gx.destroy();
 		glfwTerminate();
@@ -9,11 +9,92 @@
 #include "Slate/VK/vkutil.h"
 
 #include <volk.h>
+#include <algorithm>
+#include <cstring>
 namespace Slate {
-	CommandBuffer::CommandBuffer(GX* gx) : _gxCtx(gx), _wrapper(&gx->_imm->acquire()) {};
+	uint32_t CommandStats::getTotalIssued() const {
+		uint32_t total = 0;
+		for (uint32_t count : issued) total += count;
+		return total;
+	}
+	uint32_t CommandStats::getTotalFiltered() const {
+		uint32_t total = 0;
+		for (uint32_t count : filtered) total += count;
+		return total;
+	}
+	void CommandStats::add(const CommandStats& other) {
+		for (size_t i = 0; i < (size_t)StateCommand::Count; i++) {
+			issued[i] += other.issued[i];
+			filtered[i] += other.filtered[i];
+		}
+		draws += other.draws;
+		dispatches += other.dispatches;
+		barriers += other.barriers;
+		barrierBatches += other.barrierBatches;
+		barriersFolded += other.barriersFolded;
+	}
+
+	CommandBuffer::CommandBuffer(GX* gx) : _gxCtx(gx), _wrapper(&gx->_imm->acquire()), _vkCmdBuf(_wrapper->_cmdBuf) {};
 	CommandBuffer::~CommandBuffer() {
 		ASSERT_MSG(!_isRendering, "Please call to end rendering before destroying a Command Buffer!");
 	}
+	void CommandBuffer::_beginSecondary(GX* gx, VkCommandBuffer secondary, const CommandBuffer& primary) {
+		ASSERT_MSG(primary._isRendering && primary._renderingContents == RenderingContents::Secondary, "Secondaries can only continue a render pass begun with RenderingContents::Secondary!");
+		_gxCtx = gx;
+		_vkCmdBuf = secondary;
+		_isSecondary = true;
+		_renderingInfo = primary._renderingInfo;
+
+		const VkCommandBufferInheritanceRenderingInfo inheritance_rendering_i = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.viewMask = 0,
+				.colorAttachmentCount = (uint32_t)_renderingInfo.colorFormats.size(),
+				.pColorAttachmentFormats = _renderingInfo.colorFormats.data(),
+				.depthAttachmentFormat = _renderingInfo.depthFormat,
+				.stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+				.rasterizationSamples = _renderingInfo.samples
+		};
+		const VkCommandBufferInheritanceInfo inheritance_i = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+				.pNext = &inheritance_rendering_i
+		};
+		const VkCommandBufferBeginInfo begin_i = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+				.pNext = nullptr,
+				.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+				.pInheritanceInfo = &inheritance_i
+		};
+		VK_CHECK(vkBeginCommandBuffer(_vkCmdBuf, &begin_i));
+		_isRendering = true;
+
+		cmdSetScissor(_renderingInfo.extent);
+		cmdSetViewport(_renderingInfo.extent);
+		cmdBindDepthState({});
+		cmdSetDepthBiasEnable(false);
+	}
+	void CommandBuffer::_endSecondary() {
+		ASSERT_MSG(_isSecondary, "Only secondaries are ended by hand!");
+		VK_CHECK(vkEndCommandBuffer(_vkCmdBuf));
+		_isRendering = false;
+	}
+	void CommandBuffer::cmdExecuteCommands(std::span<const CommandBuffer> secondaries) {
+		ASSERT_MSG(_isRendering && _renderingContents == RenderingContents::Secondary, "Secondaries can only be executed in a render pass begun with RenderingContents::Secondary!");
+		std::vector<VkCommandBuffer> buffers;
+		buffers.reserve(secondaries.size());
+		for (const CommandBuffer& secondary : secondaries) {
+			ASSERT_MSG(secondary._isSecondary && !secondary._isRendering, "Only finished secondaries can be executed!");
+			buffers.push_back(secondary._vkCmdBuf);
+			_stats.add(secondary._stats);
+		}
+		if (buffers.empty()) {
+			return;
+		}
+		vkCmdExecuteCommands(_vkCmdBuf, (uint32_t)buffers.size(), buffers.data());
+		// the primary's bound and dynamic state is undefined after executing secondaries
+		_invalidateBoundState();
+	}
 
 	VkCommandBufferSubmitInfo CommandBuffer::requestSubmitInfo() const {
 		VkCommandBufferSubmitInfo info = {};
@@ -24,7 +105,7 @@ namespace Slate {
 		return info;
 	}
 
-	void CommandBuffer::cmdBeginRendering(RenderPass pass, const Dependencies& deps) {
+	void CommandBuffer::cmdBeginRendering(RenderPass pass, const Dependencies& deps, RenderingContents contents) {
 		ASSERT_MSG(!_isRendering, "Command Buffer is already rendering!");
 
 		// some states that we will need to refrence throughout this function
@@ -125,7 +206,7 @@ namespace Slate {
 		VkRenderingInfo rendering_i = {
 				.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
 				.pNext = nullptr,
-				.flags = 0,
+				.flags = (contents == RenderingContents::Secondary) ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : VkRenderingFlags(0),
 				.renderArea = {
 						.offset = { 0, 0 },
 						.extent = renderExtent
@@ -142,39 +223,138 @@ namespace Slate {
 		cmdSetScissor(renderExtent);
 		cmdSetViewport(renderExtent);
 		cmdBindDepthState({});
+		cmdSetDepthBiasEnable(false);
 
 		_gxCtx->checkAndUpdateDescriptorSets();
 
-		vkCmdSetDepthCompareOp(_wrapper->_cmdBuf, VK_COMPARE_OP_ALWAYS);
-		vkCmdSetDepthBiasEnable(_wrapper->_cmdBuf, VK_FALSE);
-		vkCmdBeginRendering(_wrapper->_cmdBuf, &rendering_i);
+		// draws only happen in here, whatever the pass and its draws wait on has to go out now
+		cmdFlushBarriers();
+		// statistics queries would have to be inherited by secondaries, so only inline passes count invocations
+		_beginProfileScope(pass.debugName ? pass.debugName : "Rendering", contents == RenderingContents::Inline);
+		_renderingScopeDepth = _profileScopes.size();
+		vkCmdBeginRendering(_vkCmdBuf, &rendering_i);
 		_isRendering = true;
+		_renderingContents = contents;
+
+		_renderingInfo.colorFormats.clear();
+		for (uint32_t i = 0; i < colorAttachmentCount; i++) {
+			_renderingInfo.colorFormats.push_back(_gxCtx->getTextureFormat(pass.color[i].texture));
+		}
+		_renderingInfo.depthFormat = hasDepth ? _gxCtx->getTextureFormat(pass.depth.texture) : VK_FORMAT_UNDEFINED;
+		_renderingInfo.samples = _gxCtx->_texturePool.get(pass.color[0].texture)->getSampleCount();
+		_renderingInfo.extent = renderExtent;
 	}
 	void CommandBuffer::cmdEndRendering() {
-		vkCmdEndRendering(_wrapper->_cmdBuf);
+		vkCmdEndRendering(_vkCmdBuf);
 		_isRendering = false;
+		_renderingContents = RenderingContents::Inline;
+		ASSERT_MSG(_profileScopes.size() == _renderingScopeDepth, "GPU scopes opened inside a render pass have to be closed before it ends!");
+		cmdEndScope();
+	}
+
+	void CommandBuffer::_beginProfileScope(const char* name, bool collectStatistics) {
+		if (_isSecondary) return;
+		_profileScopes.push_back(_gxCtx->_profiler->beginScope(_vkCmdBuf, name, collectStatistics));
+	}
+	void CommandBuffer::cmdBeginScope(const char* name) {
+		_beginProfileScope(name, false);
+	}
+	void CommandBuffer::cmdEndScope() {
+		if (_isSecondary) return;
+		ASSERT_MSG(!_profileScopes.empty(), "No GPU scope is open!");
+		_gxCtx->_profiler->endScope(_vkCmdBuf, _profileScopes.back());
+		_profileScopes.pop_back();
 	}
 
 	void CommandBuffer::cmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
-		vkCmdDraw(_wrapper->_cmdBuf, vertexCount, instanceCount, firstVertex, firstInstance);
+		if (_isPipelinePending) return;
+		_stats.draws++;
+		vkCmdDraw(_vkCmdBuf, vertexCount, instanceCount, firstVertex, firstInstance);
 	}
 	void CommandBuffer::cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t baseInstance) {
-		vkCmdDrawIndexed(_wrapper->_cmdBuf, indexCount, instanceCount, firstIndex, vertexOffset, baseInstance);
+		if (_isPipelinePending) return;
+		_stats.draws++;
+		vkCmdDrawIndexed(_vkCmdBuf, indexCount, instanceCount, firstIndex, vertexOffset, baseInstance);
 	}
-	void CommandBuffer::cmdDrawInstanced() {
-
+	void CommandBuffer::cmdDrawInstanced(const MeshData& mesh, uint32_t instanceCount, uint32_t firstInstance) {
+		if (_isPipelinePending || instanceCount == 0) return;
+		const GeometryAllocation* alloc = _gxCtx->getGeometryAllocation(mesh);
+		ASSERT_MSG(alloc, "Mesh does not live in the geometry arena!");
+		// vertices are reached through meshVertexAddress, which already points at the first vertex of the mesh
+		_stats.draws++;
+		vkCmdDraw(_vkCmdBuf, alloc->vertexCount, instanceCount, 0, firstInstance);
 	}
-	void CommandBuffer::cmdDrawIndexedInstanced() {
-
+	void CommandBuffer::cmdDrawIndexedInstanced(const MeshData& mesh, uint32_t instanceCount, uint32_t firstInstance) {
+		if (_isPipelinePending || instanceCount == 0) return;
+		const GeometryAllocation* alloc = _gxCtx->getGeometryAllocation(mesh);
+		ASSERT_MSG(alloc, "Mesh does not live in the geometry arena!");
+		ASSERT_MSG(mesh.isIndexed(), "Mesh has no indices, use cmdDrawInstanced!");
+		cmdBindGeometryIndexBuffer();
+		_stats.draws++;
+		vkCmdDrawIndexed(_vkCmdBuf, alloc->indexCount, instanceCount, alloc->firstIndex, 0, firstInstance);
+	}
+	void CommandBuffer::cmdDrawMesh(const MeshData& mesh, uint32_t instanceCount, uint32_t firstInstance) {
+		if (mesh.isIndexed()) {
+			cmdDrawIndexedInstanced(mesh, instanceCount, firstInstance);
+		} else {
+			cmdDrawInstanced(mesh, instanceCount, firstInstance);
+		}
+	}
+	void CommandBuffer::cmdBindGeometryIndexBuffer() {
+		const AllocatedBuffer* indexArena = _gxCtx->getAllocatedBuffer(_gxCtx->getGeometryIndexBuffer());
+		_bindIndexBuffer(indexArena->_vkBuffer);
+	}
+	void CommandBuffer::cmdDrawIndexedIndirect(InternalBufferHandle indirectBuffer, size_t offset, uint32_t drawCount, uint32_t stride) {
+		if (_isPipelinePending || drawCount == 0) return;
+		const AllocatedBuffer* buffer = _gxCtx->getAllocatedBuffer(indirectBuffer);
+		ASSERT_MSG(buffer && (buffer->_vkUsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT), "Indirect draws need a buffer created with BufferUsageBits_Indirect!");
+		_stats.draws++;
+		vkCmdDrawIndexedIndirect(_vkCmdBuf, buffer->_vkBuffer, offset, drawCount, stride ? stride : sizeof(VkDrawIndexedIndirectCommand));
+	}
+	void CommandBuffer::cmdDrawIndexedIndirectCount(InternalBufferHandle indirectBuffer, size_t offset, InternalBufferHandle countBuffer, size_t countOffset, uint32_t maxDrawCount, uint32_t stride) {
+		ASSERT_MSG(_gxCtx->isDrawIndirectCountSupported(), "Device does not support drawIndirectCount, use cmdDrawIndexedIndirect!");
+		if (_isPipelinePending || maxDrawCount == 0) return;
+		const AllocatedBuffer* buffer = _gxCtx->getAllocatedBuffer(indirectBuffer);
+		const AllocatedBuffer* count = _gxCtx->getAllocatedBuffer(countBuffer);
+		ASSERT_MSG(buffer && (buffer->_vkUsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT), "Indirect draws need a buffer created with BufferUsageBits_Indirect!");
+		ASSERT_MSG(count && (count->_vkUsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT), "Indirect count needs a buffer created with BufferUsageBits_Indirect!");
+		_stats.draws++;
+		vkCmdDrawIndexedIndirectCount(_vkCmdBuf, buffer->_vkBuffer, offset, count->_vkBuffer, countOffset, maxDrawCount, stride ? stride : sizeof(VkDrawIndexedIndirectCommand));
+	}
+	void CommandBuffer::cmdDispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+		ASSERT_MSG(!_isRendering, "Dispatches can not be recorded inside of a render pass!");
+		if (_currentComputePipeline.empty() || groupCountX == 0 || groupCountY == 0 || groupCountZ == 0) return;
+		cmdFlushBarriers();
+		_stats.dispatches++;
+		vkCmdDispatch(_vkCmdBuf, groupCountX, groupCountY, groupCountZ);
+	}
+	void CommandBuffer::cmdDispatchIndirect(InternalBufferHandle indirectBuffer, size_t offset) {
+		ASSERT_MSG(!_isRendering, "Dispatches can not be recorded inside of a render pass!");
+		if (_currentComputePipeline.empty()) return;
+		const AllocatedBuffer* buffer = _gxCtx->getAllocatedBuffer(indirectBuffer);
+		ASSERT_MSG(buffer && (buffer->_vkUsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT), "Indirect dispatches need a buffer created with BufferUsageBits_Indirect!");
+		ASSERT_MSG(offset % 4 == 0, "Indirect dispatch offset needs to be a multiple of 4. Is offset {}", offset);
+		cmdFlushBarriers();
+		_stats.dispatches++;
+		vkCmdDispatchIndirect(_vkCmdBuf, buffer->_vkBuffer, offset);
 	}
 
 
 	void CommandBuffer::cmdBindIndexBuffer(InternalBufferHandle handle) {
 		AllocatedBuffer* buffer = _gxCtx->getAllocatedBuffer(handle);
-		vkCmdBindIndexBuffer(_wrapper->_cmdBuf, buffer->_vkBuffer, 0, VK_INDEX_TYPE_UINT32);
+		_bindIndexBuffer(buffer->_vkBuffer);
+	}
+	void CommandBuffer::_bindIndexBuffer(VkBuffer buffer) {
+		bool isKnown = _currentIndexBuffer != VK_NULL_HANDLE;
+		if (_shadow(StateCommand::BindIndexBuffer, _currentIndexBuffer, buffer, isKnown)) {
+			vkCmdBindIndexBuffer(_vkCmdBuf, buffer, 0, VK_INDEX_TYPE_UINT32);
+		}
 	}
 
 	void CommandBuffer::cmdSetViewport(VkExtent2D extent2D) {
+		if (!_shadow(StateCommand::Viewport, _dynamic.viewport, glm::uvec2{extent2D.width, extent2D.height}, _dynamic.hasViewport)) {
+			return;
+		}
 		// we flip the viewport because Vulkan is reversed using LH instead of OpenGL's RH
 		// HOWEVER: using Slang compilier option to reflect the y axis solves this so we dont have to flip here
 		VkViewport viewport = {};
@@ -184,58 +364,291 @@ namespace Slate {
 		viewport.height = static_cast<float>(extent2D.height);
 		viewport.minDepth = 0.f;
 		viewport.maxDepth = 1.f;
-		vkCmdSetViewport(_wrapper->_cmdBuf, 0, 1, &viewport);
+		vkCmdSetViewport(_vkCmdBuf, 0, 1, &viewport);
 	}
 	void CommandBuffer::cmdSetScissor(VkExtent2D extent2D) {
-		VkRect2D scissor = {};
-		scissor.offset.x = 0; // default 0 for both
-		scissor.offset.y = 0;
-		scissor.extent = extent2D;
-		vkCmdSetScissor(_wrapper->_cmdBuf, 0, 1, &scissor);
+		cmdSetScissor(VkRect2D{.offset = {0, 0}, .extent = extent2D});
+	}
+	void CommandBuffer::cmdSetScissor(VkRect2D rect) {
+		const glm::ivec4 scissor = {rect.offset.x, rect.offset.y, (int32_t)rect.extent.width, (int32_t)rect.extent.height};
+		if (!_shadow(StateCommand::Scissor, _dynamic.scissor, scissor, _dynamic.hasScissor)) {
+			return;
+		}
+		vkCmdSetScissor(_vkCmdBuf, 0, 1, &rect);
 	}
 	void CommandBuffer::cmdTransitionLayout(InternalTextureHandle source, VkImageLayout newLayout) {
-		cmdTransitionLayout(source, _gxCtx->getTextureCurrentLayout(source), newLayout);
+		cmdTransitionLayout(source, newLayout, { vkutil::AspectMaskFromFormat(_gxCtx->getTextureFormat(source)), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS });
+	}
+	void CommandBuffer::cmdTransitionLayout(InternalTextureHandle source, VkImageLayout newLayout, const VkImageSubresourceRange& range) {
+		AllocatedImage* image = _gxCtx->_texturePool.get(source);
+		const uint32_t numLevels = (range.levelCount == VK_REMAINING_MIP_LEVELS) ? image->_numLevels - range.baseMipLevel : range.levelCount;
+		const uint32_t numLayers = (range.layerCount == VK_REMAINING_ARRAY_LAYERS) ? image->_numLayers - range.baseArrayLayer : range.layerCount;
+		if (image->isLayoutUniform()) {
+			_queueImageTransition(*image, image->_vkCurrentImageLayout, newLayout, range);
+		} else {
+			// one barrier per run of layers that agree on their current layout
+			for (uint32_t level = range.baseMipLevel; level < range.baseMipLevel + numLevels; level++) {
+				uint32_t first = range.baseArrayLayer;
+				for (uint32_t layer = first + 1; layer <= range.baseArrayLayer + numLayers; layer++) {
+					const VkImageLayout runLayout = image->getSubresourceLayout(level, first);
+					if (layer < range.baseArrayLayer + numLayers && image->getSubresourceLayout(level, layer) == runLayout) continue;
+					_queueImageTransition(*image, runLayout, newLayout, { range.aspectMask, level, 1, first, layer - first });
+					first = layer;
+				}
+			}
+		}
+		image->_setSubresourceLayout(range, newLayout);
 	}
 	void CommandBuffer::cmdTransitionLayout(InternalTextureHandle source, VkImageLayout currentLayout, VkImageLayout newLayout) {
+		AllocatedImage* image = _gxCtx->_texturePool.get(source);
+		_queueImageTransition(*image, currentLayout, newLayout, vkinfo::CreateImageSubresourceRange(vkutil::AspectMaskFromFormat(image->_vkFormat)));
+		image->_setLayout(newLayout);
+	}
 
-		vkutil::StageAccess srcStage = vkutil::getPipelineStageAccess(currentLayout);
-		vkutil::StageAccess dstStage = vkutil::getPipelineStageAccess(newLayout);
-
-		if (_gxCtx->_texturePool.get(source)->_isResolveAttachment && vkutil::IsFormatDepthOrStencil(_gxCtx->getTextureFormat(source))) {
+	static bool IsReadOnlyLayout(VkImageLayout layout) {
+		switch (layout) {
+			case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+			case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+			case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
+			case VK_IMAGE_LAYOUT_READ_ONLY_OPTIMAL:
+				return true;
+			default:
+				return false;
+		}
+	}
+	static bool RangesOverlap(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b) {
+		const auto overlap = [](uint32_t baseA, uint32_t countA, uint32_t baseB, uint32_t countB) {
+			const uint64_t endA = (countA == VK_REMAINING_MIP_LEVELS) ? UINT64_MAX : (uint64_t)baseA + countA;
+			const uint64_t endB = (countB == VK_REMAINING_MIP_LEVELS) ? UINT64_MAX : (uint64_t)baseB + countB;
+			return baseA < endB && baseB < endA;
+		};
+		return (a.aspectMask & b.aspectMask) &&
+			   overlap(a.baseMipLevel, a.levelCount, b.baseMipLevel, b.levelCount) &&
+			   overlap(a.baseArrayLayer, a.layerCount, b.baseArrayLayer, b.layerCount);
+	}
+	// explicit counts, so ranges of the same image can be cut into pieces
+	static VkImageSubresourceRange ResolveRange(const AllocatedImage& image, const VkImageSubresourceRange& range) {
+		VkImageSubresourceRange resolved = range;
+		if (resolved.levelCount == VK_REMAINING_MIP_LEVELS) resolved.levelCount = image._numLevels - range.baseMipLevel;
+		if (resolved.layerCount == VK_REMAINING_ARRAY_LAYERS) resolved.layerCount = image._numLayers - range.baseArrayLayer;
+		return resolved;
+	}
+	static VkImageSubresourceRange IntersectRanges(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b) {
+		const uint32_t baseLevel = std::max(a.baseMipLevel, b.baseMipLevel);
+		const uint32_t baseLayer = std::max(a.baseArrayLayer, b.baseArrayLayer);
+		return {
+				.aspectMask = a.aspectMask & b.aspectMask,
+				.baseMipLevel = baseLevel,
+				.levelCount = std::min(a.baseMipLevel + a.levelCount, b.baseMipLevel + b.levelCount) - baseLevel,
+				.baseArrayLayer = baseLayer,
+				.layerCount = std::min(a.baseArrayLayer + a.layerCount, b.baseArrayLayer + b.layerCount) - baseLayer,
+		};
+	}
+	// the parts of a outside of b, at most five disjoint boxes, b has to overlap a
+	static void SubtractRange(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b, std::vector<VkImageSubresourceRange>& out) {
+		const VkImageSubresourceRange overlap = IntersectRanges(a, b);
+		if (const VkImageAspectFlags aspects = a.aspectMask & ~b.aspectMask) {
+			out.push_back({aspects, a.baseMipLevel, a.levelCount, a.baseArrayLayer, a.layerCount});
+		}
+		const VkImageAspectFlags aspects = overlap.aspectMask;
+		if (a.baseMipLevel < overlap.baseMipLevel) {
+			out.push_back({aspects, a.baseMipLevel, overlap.baseMipLevel - a.baseMipLevel, a.baseArrayLayer, a.layerCount});
+		}
+		if (overlap.baseMipLevel + overlap.levelCount < a.baseMipLevel + a.levelCount) {
+			const uint32_t base = overlap.baseMipLevel + overlap.levelCount;
+			out.push_back({aspects, base, a.baseMipLevel + a.levelCount - base, a.baseArrayLayer, a.layerCount});
+		}
+		if (a.baseArrayLayer < overlap.baseArrayLayer) {
+			out.push_back({aspects, overlap.baseMipLevel, overlap.levelCount, a.baseArrayLayer, overlap.baseArrayLayer - a.baseArrayLayer});
+		}
+		if (overlap.baseArrayLayer + overlap.layerCount < a.baseArrayLayer + a.layerCount) {
+			const uint32_t base = overlap.baseArrayLayer + overlap.layerCount;
+			out.push_back({aspects, overlap.baseMipLevel, overlap.levelCount, base, a.baseArrayLayer + a.layerCount - base});
+		}
+	}
+	// stages and accesses a layout really implies for this image, a barrier only has to make writes available on the source side
+	static vkutil::StageAccess GetTransitionStageAccess(const AllocatedImage& image, VkImageLayout layout, bool isSource) {
+		vkutil::StageAccess stageAccess = vkutil::getPipelineStageAccess(layout);
+		if (layout == VK_IMAGE_LAYOUT_GENERAL) {
+			VkPipelineStageFlags2 stages = 0;
+			if (image.isStorageImage()) {
+				stages |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			}
+			if (image._vkUsageFlags & (VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)) {
+				stages |= VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+			}
+			if (stages) {
+				stageAccess.stage = stages;
+			}
+		}
+		if (image.isDepthAttachment() && image._isResolveAttachment) {
 			// https://registry.khronos.org/vulkan/specs/latest/html/vkspec.html#renderpass-resolve-operations
-			srcStage.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			srcStage.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dstStage.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
-			dstStage.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			stageAccess.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			stageAccess.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		}
+		if (isSource) {
+			constexpr VkAccessFlags2 kWriteAccess = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+													VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT |
+													VK_ACCESS_2_MEMORY_WRITE_BIT;
+			stageAccess.access &= kWriteAccess;
+		}
+		return stageAccess;
+	}
+	void CommandBuffer::_queueImageTransition(const AllocatedImage& image, VkImageLayout oldLayout, VkImageLayout newLayout, const VkImageSubresourceRange& range) {
+		// reading on in the same layout has nothing to wait for
+		if (oldLayout == newLayout && IsReadOnlyLayout(newLayout)) {
+			_stats.barriersFolded++;
+			return;
+		}
+		const vkutil::StageAccess src = GetTransitionStageAccess(image, oldLayout, true);
+		const vkutil::StageAccess dst = GetTransitionStageAccess(image, newLayout, false);
+		// barriers of one batch are unordered, so queued ranges of an image never overlap, where this transition hits
+		// a queued one nothing was recorded in between and that part goes straight to the final layout
+		std::vector<VkImageSubresourceRange> remaining = { ResolveRange(image, range) };
+		std::vector<VkImageSubresourceRange> pieces;
+		// split off pieces are appended and still get visited, they can overlap other parts of this transition
+		for (size_t i = 0; i < _pendingImageBarriers.size() && !remaining.empty(); i++) {
+			if (_pendingImageBarriers[i].image != image._vkImage) continue;
+			const VkImageSubresourceRange pendingRange = ResolveRange(image, _pendingImageBarriers[i].subresourceRange);
+			for (size_t r = 0; r < remaining.size();) {
+				if (!RangesOverlap(pendingRange, remaining[r])) {
+					r++;
+					continue;
+				}
+				// what is left of the queued barrier keeps its own transition
+				const VkImageMemoryBarrier2 pending = _pendingImageBarriers[i];
+				pieces.clear();
+				SubtractRange(pendingRange, remaining[r], pieces);
+				for (const VkImageSubresourceRange& piece : pieces) {
+					VkImageMemoryBarrier2 split = pending;
+					split.subresourceRange = piece;
+					_pendingImageBarriers.push_back(split);
+				}
+				VkImageMemoryBarrier2& folded = _pendingImageBarriers[i];
+				folded.subresourceRange = IntersectRanges(pendingRange, remaining[r]);
+				folded.newLayout = newLayout;
+				folded.dstStageMask = dst.stage;
+				folded.dstAccessMask = dst.access;
+				_stats.barriersFolded++;
+
+				// the rest of this transition still has to be checked against the other queued barriers
+				pieces.clear();
+				SubtractRange(remaining[r], pendingRange, pieces);
+				remaining.erase(remaining.begin() + (ptrdiff_t)r);
+				remaining.insert(remaining.end(), pieces.begin(), pieces.end());
+				break;
+			}
+		}
+		for (const VkImageSubresourceRange& piece : remaining) {
+			_pendingImageBarriers.push_back({
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.pNext = nullptr,
+					.srcStageMask = src.stage,
+					.srcAccessMask = src.access,
+					.dstStageMask = dst.stage,
+					.dstAccessMask = dst.access,
+					.oldLayout = oldLayout,
+					.newLayout = newLayout,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = image._vkImage,
+					.subresourceRange = piece
+			});
+		}
+	}
+	void CommandBuffer::_queueImageBarrier(const VkImageMemoryBarrier2& barrier) {
+		for (const VkImageMemoryBarrier2& pending : _pendingImageBarriers) {
+			if (pending.image == barrier.image && RangesOverlap(pending.subresourceRange, barrier.subresourceRange)) {
+				cmdFlushBarriers();
+				break;
+			}
+		}
+		_pendingImageBarriers.push_back(barrier);
+	}
+	void CommandBuffer::cmdPipelineBarrier(std::span<const VkImageMemoryBarrier2> imageBarriers, std::span<const VkBufferMemoryBarrier2> bufferBarriers) {
+		for (const VkImageMemoryBarrier2& barrier : imageBarriers) {
+			_queueImageBarrier(barrier);
+		}
+		_pendingBufferBarriers.insert(_pendingBufferBarriers.end(), bufferBarriers.begin(), bufferBarriers.end());
+	}
+	// what the given stages can write on the source side and read or write on the destination side, shader access only where shaders run
+	static VkAccessFlags2 GetBarrierAccess(VkPipelineStageFlags2 stages, bool isSource) {
+		constexpr VkPipelineStageFlags2 kShaderStages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
+														VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT | VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		constexpr VkPipelineStageFlags2 kTransferStages = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		VkAccessFlags2 access = VK_ACCESS_2_NONE;
+		if (stages & kTransferStages) {
+			access |= isSource ? VK_ACCESS_2_TRANSFER_WRITE_BIT : VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		}
+		if (stages & kShaderStages) {
+			access |= isSource ? VK_ACCESS_2_SHADER_WRITE_BIT : VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
 		}
+		return access;
+	}
+	void CommandBuffer::cmdBufferBarrier(InternalBufferHandle bufhandle, VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage) {
+		const AllocatedBuffer* buf = _gxCtx->_bufferPool.get(bufhandle);
+		ASSERT_MSG(buf, "Buffer barrier on a buffer that does not exist!");
 
-		VkImageMemoryBarrier2 barrier = {
+		VkAccessFlags2 dstAccess = GetBarrierAccess(dstStage, false);
+		if (dstStage & (VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT)) {
+			dstAccess |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+		}
+		if ((buf->_vkUsageFlags & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) && (dstStage & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT))) {
+			dstAccess |= VK_ACCESS_2_INDEX_READ_BIT;
+		}
+		_pendingBufferBarriers.push_back({
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.pNext = nullptr,
+				.srcStageMask = srcStage,
+				.srcAccessMask = GetBarrierAccess(srcStage, true),
+				.dstStageMask = dstStage,
+				.dstAccessMask = dstAccess,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = buf->_vkBuffer,
+				.offset = 0,
+				.size = VK_WHOLE_SIZE,
+		});
+	}
+	void CommandBuffer::cmdImageBarrier(InternalTextureHandle texture, VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage) {
+		const AllocatedImage* image = _gxCtx->_texturePool.get(texture);
+		ASSERT_MSG(image, "Image barrier on a texture that does not exist!");
+		// the layout stays, changing it is what cmdTransitionLayout is for
+		ASSERT_MSG(image->isLayoutUniform(), "Image barriers need every subresource in the same layout, transition the texture first!");
+		_queueImageBarrier({
 				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
 				.pNext = nullptr,
-				.srcStageMask = srcStage.stage,
-				.srcAccessMask = srcStage.access,
-
-				.dstStageMask = dstStage.stage,
-				.dstAccessMask = dstStage.access,
-
-				.oldLayout = currentLayout,
-				.newLayout = newLayout,
-
+				.srcStageMask = srcStage,
+				.srcAccessMask = GetBarrierAccess(srcStage, true),
+				.dstStageMask = dstStage,
+				.dstAccessMask = GetBarrierAccess(dstStage, false),
+				.oldLayout = image->_vkCurrentImageLayout,
+				.newLayout = image->_vkCurrentImageLayout,
 				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-
-				.image = _gxCtx->getTextureImage(source),
-				.subresourceRange = vkinfo::CreateImageSubresourceRange(vkutil::AspectMaskFromFormat(_gxCtx->getTextureFormat(source)))
-		};
-		VkDependencyInfo dependency_i = {
+				.image = image->_vkImage,
+				.subresourceRange = vkinfo::CreateImageSubresourceRange(vkutil::AspectMaskFromFormat(image->_vkFormat))
+		});
+	}
+	void CommandBuffer::cmdFlushBarriers() {
+		if (_pendingImageBarriers.empty() && _pendingBufferBarriers.empty()) {
+			return;
+		}
+		ASSERT_MSG(!_isRendering, "Barriers can not be recorded inside of a render pass!");
+		const VkDependencyInfo dependency_i = {
 				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
 				.pNext = nullptr,
-				.imageMemoryBarrierCount = 1,
-				.pImageMemoryBarriers = &barrier
+				.bufferMemoryBarrierCount = (uint32_t)_pendingBufferBarriers.size(),
+				.pBufferMemoryBarriers = _pendingBufferBarriers.data(),
+				.imageMemoryBarrierCount = (uint32_t)_pendingImageBarriers.size(),
+				.pImageMemoryBarriers = _pendingImageBarriers.data()
 		};
-		vkCmdPipelineBarrier2(_wrapper->_cmdBuf, &dependency_i);
-		// set the texture to its new image layout
-		_gxCtx->_texturePool.get(source)->_vkCurrentImageLayout = newLayout;
+		vkCmdPipelineBarrier2(_vkCmdBuf, &dependency_i);
+		_stats.barriers += (uint32_t)(_pendingImageBarriers.size() + _pendingBufferBarriers.size());
+		_stats.barrierBatches++;
+		_pendingImageBarriers.clear();
+		_pendingBufferBarriers.clear();
 	}
 	void CommandBuffer::cmdBlitImage(InternalTextureHandle source, InternalTextureHandle destination) {
 		if (_gxCtx->getTextureCurrentLayout(source) != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
@@ -276,7 +689,8 @@ namespace Slate {
 		blitInfo.regionCount = 1;
 		blitInfo.pRegions = &blitRegion;
 
-		vkCmdBlitImage2KHR(_wrapper->_cmdBuf, &blitInfo);
+		cmdFlushBarriers();
+		vkCmdBlitImage2KHR(_vkCmdBuf, &blitInfo);
 	}
 	void CommandBuffer::cmdCopyImage(InternalTextureHandle source, InternalTextureHandle destination, VkExtent2D size) {
 		VkImageCopy2 copyRegion = { .sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2, .pNext = nullptr };
@@ -303,20 +717,32 @@ namespace Slate {
 		copyinfo.regionCount = 1;
 		copyinfo.pRegions = &copyRegion;
 
-		vkCmdCopyImage2KHR(_wrapper->_cmdBuf, &copyinfo);
+		cmdFlushBarriers();
+		vkCmdCopyImage2KHR(_vkCmdBuf, &copyinfo);
 	}
 	void CommandBuffer::cmdSetDepthBiasEnable(bool enable) {
-		vkCmdSetDepthBiasEnable(_wrapper->_cmdBuf, enable ? VK_TRUE : VK_FALSE);
+		if (_shadow(StateCommand::DepthBiasEnable, _dynamic.depthBiasEnable, enable, _dynamic.hasDepthBiasEnable)) {
+			vkCmdSetDepthBiasEnable(_vkCmdBuf, enable ? VK_TRUE : VK_FALSE);
+		}
 	}
 	void CommandBuffer::cmdSetDepthBias(float constantFactor, float slopeFactor, float clamp) {
-		vkCmdSetDepthBias(_wrapper->_cmdBuf, constantFactor, clamp, slopeFactor);
+		if (_shadow(StateCommand::DepthBias, _dynamic.depthBias, glm::vec3{constantFactor, slopeFactor, clamp}, _dynamic.hasDepthBias)) {
+			vkCmdSetDepthBias(_vkCmdBuf, constantFactor, clamp, slopeFactor);
+		}
 	}
 	void CommandBuffer::cmdBindDepthState(const DepthState& state) {
 		// https://github.com/corporateshark/lightweightvk/blob/master/lvk/vulkan/VulkanClasses.cpp#L2458
 		const VkCompareOp op = toVulkan(state.compareOp);
-		vkCmdSetDepthWriteEnable(_wrapper->_cmdBuf, state.isDepthWriteEnabled ? VK_TRUE : VK_FALSE);
-		vkCmdSetDepthTestEnable(_wrapper->_cmdBuf, (op != VK_COMPARE_OP_ALWAYS || state.isDepthWriteEnabled) ? VK_TRUE : VK_FALSE);
-		vkCmdSetDepthCompareOp(_wrapper->_cmdBuf, op);
+		const bool depthTest = op != VK_COMPARE_OP_ALWAYS || state.isDepthWriteEnabled;
+		if (_shadow(StateCommand::DepthWrite, _dynamic.depthWrite, state.isDepthWriteEnabled, _dynamic.hasDepthWrite)) {
+			vkCmdSetDepthWriteEnable(_vkCmdBuf, state.isDepthWriteEnabled ? VK_TRUE : VK_FALSE);
+		}
+		if (_shadow(StateCommand::DepthTest, _dynamic.depthTest, depthTest, _dynamic.hasDepthTest)) {
+			vkCmdSetDepthTestEnable(_vkCmdBuf, depthTest ? VK_TRUE : VK_FALSE);
+		}
+		if (_shadow(StateCommand::DepthCompareOp, _dynamic.depthCompareOp, op, _dynamic.hasDepthCompareOp)) {
+			vkCmdSetDepthCompareOp(_vkCmdBuf, op);
+		}
 	}
 
 	void CommandBuffer::cmdPushConstants(const void* data, uint32_t size, uint32_t offset) {
@@ -326,31 +752,100 @@ namespace Slate {
 			LOG_USER(LogType::Error, "Push constants size exceeded %u (max %u bytes)", size + offset, limits.maxPushConstantsSize);
 		}
 
-		if (_currentPipeline.empty()) {
-			LOG_USER(LogType::Warning, "No pipeline currently bound, cannot perform push constants!");
-			return;
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkShaderStageFlags stages = kGraphicsPushConstantStages;
+		if (_lastBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE) {
+			if (_currentComputePipeline.empty()) {
+				LOG_USER(LogType::Warning, "No compute pipeline currently bound, cannot perform push constants!");
+				return;
+			}
+			layout = _gxCtx->_computePipelinePool.get(_currentComputePipeline)->_vkPipelineLayout;
+			stages = VK_SHADER_STAGE_COMPUTE_BIT;
+		} else {
+			if (_isPipelinePending) {
+				return;
+			}
+			if (_currentPipeline.empty()) {
+				LOG_USER(LogType::Warning, "No pipeline currently bound, cannot perform push constants!");
+				return;
+			}
+			layout = _gxCtx->getPipelineObject(_currentPipeline)._vkPipelineLayout;
 		}
 
-		const RenderPipeline& pipeline = _gxCtx->getPipelineObject(_currentPipeline);
-		vkCmdPushConstants(_wrapper->_cmdBuf, pipeline._vkPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, offset, size, data);
+		if (_isPushConstantRedundant(layout, data, size, offset)) {
+			_stats.filtered[(size_t)StateCommand::PushConstants]++;
+			return;
+		}
+		_stats.issued[(size_t)StateCommand::PushConstants]++;
+		vkCmdPushConstants(_vkCmdBuf, layout, stages, offset, size, data);
+	}
+	void CommandBuffer::_invalidateBoundState() {
+		_lastBoundPipeline = VK_NULL_HANDLE;
+		_currentPipeline = {};
+		_isPipelinePending = false;
+		_currentIndexBuffer = VK_NULL_HANDLE;
+		_lastBoundComputePipeline = VK_NULL_HANDLE;
+		_currentComputePipeline = {};
+		_dynamic = {};
+		_pushValidWords = 0;
+		_lastPushLayout = VK_NULL_HANDLE;
+	}
+	bool CommandBuffer::_isPushConstantRedundant(VkPipelineLayout layout, const void* data, uint32_t size, uint32_t offset) {
+		// only shadow what fits, bigger ranges are always recorded
+		if (size == 0 || offset + size > kMaxPushConstantBytes) {
+			return false;
+		}
+		// a different layout does not promise to keep the old values around
+		if (layout != _lastPushLayout) {
+			_lastPushLayout = layout;
+			_pushValidWords = 0;
+		}
+		const uint32_t firstWord = offset / 4;
+		const uint32_t numWords = (size + 3) / 4;
+		const uint64_t rangeMask = (numWords >= 64 ? ~0ull : ((1ull << numWords) - 1)) << firstWord;
+		if ((_pushValidWords & rangeMask) == rangeMask && std::memcmp(_pushShadow + offset, data, size) == 0) {
+			return true;
+		}
+		std::memcpy(_pushShadow + offset, data, size);
+		_pushValidWords |= rangeMask;
+		return false;
 	}
 
 	void CommandBuffer::cmdTransitionSwapchainLayout(VkImageLayout newLayout) {
-		VkImageMemoryBarrier2 barrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr };
-		barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-		barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
-		barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-		barrier.dstAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_MEMORY_READ_BIT;
-		barrier.oldLayout = _gxCtx->_swapchain->getCurrentImageLayout();
-		barrier.newLayout = newLayout;
-		barrier.subresourceRange = vkinfo::CreateImageSubresourceRange(vkutil::AspectMaskFromAttachmentLayout(newLayout));
-		barrier.image = _gxCtx->_swapchain->getCurrentImage();
-		VkDependencyInfo info = { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr };
-		info.imageMemoryBarrierCount = 1;
-		info.pImageMemoryBarriers = &barrier;
-		vkCmdPipelineBarrier2(_wrapper->_cmdBuf, &info);
-
-		_gxCtx->_swapchain->_vkCurrentImageLayout = newLayout;
+		VulkanSwapchain& swapchain = *_gxCtx->_swapchain;
+		const bool isHeadless = swapchain.isHeadless();
+		if (isHeadless && newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+			newLayout = swapchain.getPresentLayout();
+		}
+		const VkImageLayout oldLayout = swapchain.getCurrentImageLayout();
+		vkutil::StageAccess src = vkutil::getPipelineStageAccess(oldLayout);
+		vkutil::StageAccess dst = vkutil::getPipelineStageAccess(newLayout);
+		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED || oldLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+			// the acquire semaphore is waited on at all commands, chaining onto it from the stage we need is enough
+			src = { .stage = dst.stage, .access = VK_ACCESS_2_NONE };
+		}
+		if (isHeadless) {
+			// offscreen images keep their layout so captures and the next frame know what they are in
+			swapchain._getCurrentTexture()._setLayout(newLayout);
+		} else if (newLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+			// presenting waits on the submit semaphore, nothing in this command buffer reads it afterwards
+			dst = { .stage = VK_PIPELINE_STAGE_2_NONE, .access = VK_ACCESS_2_NONE };
+		}
+		_queueImageBarrier({
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.pNext = nullptr,
+				.srcStageMask = src.stage,
+				.srcAccessMask = src.access,
+				.dstStageMask = dst.stage,
+				.dstAccessMask = dst.access,
+				.oldLayout = oldLayout,
+				.newLayout = newLayout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = swapchain.getCurrentImage(),
+				.subresourceRange = vkinfo::CreateImageSubresourceRange(vkutil::AspectMaskFromAttachmentLayout(newLayout))
+		});
+		swapchain._vkCurrentImageLayout = newLayout;
 	}
 	void CommandBuffer::cmdBlitToSwapchain(InternalTextureHandle source) {
 		VkImageBlit2 blitRegion = { .sType = VK_STRUCTURE_TYPE_IMAGE_BLIT_2, .pNext = nullptr };
@@ -382,61 +877,72 @@ namespace Slate {
 		blitInfo.regionCount = 1;
 		blitInfo.pRegions = &blitRegion;
 
-		vkCmdBlitImage2KHR(_wrapper->_cmdBuf, &blitInfo);
+		cmdFlushBarriers();
+		vkCmdBlitImage2KHR(_vkCmdBuf, &blitInfo);
 	}
 	void CommandBuffer::cmdBindRenderPipeline(InternalPipelineHandle handle) {
 		if (handle.empty()) {
 			LOG_USER(LogType::Warning, "Binded render pipeline was empty/invalid!");
 			return;
 		}
+		_lastBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		const RenderPipeline* pipeline = nullptr;
+		{
+			// resolving can create pipelines, secondaries are recorded from several threads at once
+			std::unique_lock<std::mutex> lock(_gxCtx->_recordingMutex, std::defer_lock);
+			if (_isSecondary) lock.lock();
+			pipeline = _gxCtx->resolveRenderPipeline(handle);
+			// pipeline is still compiling in the background, try the fallback it named
+			if (pipeline && pipeline->_vkPipeline == VK_NULL_HANDLE && pipeline->_spec.fallback.valid()) {
+				handle = pipeline->_spec.fallback;
+				pipeline = _gxCtx->resolveRenderPipeline(handle);
+			}
+		}
+		// nothing usable yet, drop the draws until it lands
+		if (!pipeline || pipeline->_vkPipeline == VK_NULL_HANDLE) {
+			_currentPipeline = {};
+			_isPipelinePending = true;
+			return;
+		}
+		_isPipelinePending = false;
 		// use _currentPipeline
 		_currentPipeline = handle;
 
-		const RenderPipeline* pipeline = _gxCtx->resolveRenderPipeline(_currentPipeline);
-
 		if (_lastBoundPipeline != pipeline->_vkPipeline) {
 			_lastBoundPipeline = pipeline->_vkPipeline;
-			vkCmdBindPipeline(_wrapper->_cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->_vkPipeline);
-			_gxCtx->bindDefaultDescriptorSets(_wrapper->_cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->_vkPipelineLayout);
+			_stats.issued[(size_t)StateCommand::BindPipeline]++;
+			vkCmdBindPipeline(_vkCmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->_vkPipeline);
+			_gxCtx->bindDefaultDescriptorSets(_vkCmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->_vkPipelineLayout);
+		} else {
+			_stats.filtered[(size_t)StateCommand::BindPipeline]++;
 		}
 	}
-	void CommandBuffer::bufferBarrier(InternalBufferHandle bufhandle, VkPipelineStageFlags2 srcStage, VkPipelineStageFlags2 dstStage) {
-		AllocatedBuffer* buf = _gxCtx->_bufferPool.get(bufhandle);
-
-		VkBufferMemoryBarrier2 barrier = {
-				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
-				.srcStageMask = srcStage,
-				.srcAccessMask = 0,
-				.dstStageMask = dstStage,
-				.dstAccessMask = 0,
-				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-				.buffer = buf->_vkBuffer,
-				.offset = 0,
-				.size = VK_WHOLE_SIZE,
-		};
-		if (srcStage & VK_PIPELINE_STAGE_2_TRANSFER_BIT) {
-			barrier.srcAccessMask |= VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
-		} else {
-			barrier.srcAccessMask |= VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+	void CommandBuffer::cmdBindComputePipeline(InternalComputePipelineHandle handle) {
+		if (handle.empty()) {
+			LOG_USER(LogType::Warning, "Binded compute pipeline was empty/invalid!");
+			return;
 		}
-		if (dstStage & VK_PIPELINE_STAGE_2_TRANSFER_BIT) {
-			barrier.dstAccessMask |= VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
-		} else {
-			barrier.dstAccessMask |= VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+		_lastBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+		const ComputePipeline* pipeline = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(_gxCtx->_recordingMutex, std::defer_lock);
+			if (_isSecondary) lock.lock();
+			pipeline = _gxCtx->resolveComputePipeline(handle);
 		}
-		if (dstStage & VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT) {
-			barrier.dstAccessMask |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+		if (!pipeline) {
+			_currentComputePipeline = {};
+			return;
 		}
-		if (buf->_vkUsageFlags & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
-			barrier.dstAccessMask |= VK_ACCESS_2_INDEX_READ_BIT;
+		_currentComputePipeline = handle;
+
+		if (_lastBoundComputePipeline != pipeline->_vkPipeline) {
+			_lastBoundComputePipeline = pipeline->_vkPipeline;
+			_stats.issued[(size_t)StateCommand::BindPipeline]++;
+			vkCmdBindPipeline(_vkCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->_vkPipeline);
+			_gxCtx->bindDefaultDescriptorSets(_vkCmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->_vkPipelineLayout);
+		} else {
+			_stats.filtered[(size_t)StateCommand::BindPipeline]++;
 		}
-		const VkDependencyInfo depInfo = {
-				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-				.bufferMemoryBarrierCount = 1,
-				.pBufferMemoryBarriers = &barrier,
-		};
-		vkCmdPipelineBarrier2(_wrapper->_cmdBuf, &depInfo);
 	}
 	// current issues with host buffer
 	void CommandBuffer::cmdUpdateBuffer(InternalBufferHandle bufhandle, size_t offset, size_t size, const void* data) {
@@ -450,15 +956,31 @@ namespace Slate {
 			return;
 		}
 
-		bufferBarrier(bufhandle, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		cmdBufferBarrier(bufhandle, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		cmdFlushBarriers();
 
-		vkCmdUpdateBuffer(_wrapper->_cmdBuf, buf->_vkBuffer, offset, size, data);
+		vkCmdUpdateBuffer(_vkCmdBuf, buf->_vkBuffer, offset, size, data);
 
-		VkPipelineStageFlags2 dstStage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+		VkPipelineStageFlags2 dstStage = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
 		if (buf->_vkUsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
 			dstStage |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
 		}
-		bufferBarrier(bufhandle, VK_PIPELINE_STAGE_2_TRANSFER_BIT, dstStage);
+		if (buf->_vkUsageFlags & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+			dstStage |= VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+		}
+		cmdBufferBarrier(bufhandle, VK_PIPELINE_STAGE_2_TRANSFER_BIT, dstStage);
+	}
+	void CommandBuffer::cmdFillBuffer(InternalBufferHandle bufhandle, size_t offset, size_t size, uint32_t value) {
+		ASSERT_MSG(!_isRendering, "Buffers can not be filled inside of a render pass!");
+		ASSERT(offset % 4 == 0);
+		ASSERT(size % 4 == 0);
+		const AllocatedBuffer* buf = _gxCtx->_bufferPool.get(bufhandle);
+		ASSERT_MSG(buf && (buf->_vkUsageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT), "Filling needs a device buffer or one created with BufferUsageBits_Storage!");
+		if (size == 0) {
+			return;
+		}
+		cmdFlushBarriers();
+		vkCmdFillBuffer(_vkCmdBuf, buf->_vkBuffer, offset, size, value);
 	}
 	void CommandBuffer::cmdCopyImageToBuffer(InternalTextureHandle source, InternalBufferHandle destination, const VkBufferImageCopy& region) {
 		VkImageLayout currentLayout = _gxCtx->getTextureCurrentLayout(source);
@@ -466,7 +988,8 @@ namespace Slate {
 			cmdTransitionLayout(source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 		}
 		VkImageLayout properLayout = _gxCtx->getTextureCurrentLayout(source);
-		vkCmdCopyImageToBuffer(_wrapper->_cmdBuf, _gxCtx->getTextureImage(source), properLayout, _gxCtx->getAllocatedBuffer(destination)->_vkBuffer, 1, &region);
+		cmdFlushBarriers();
+		vkCmdCopyImageToBuffer(_vkCmdBuf, _gxCtx->getTextureImage(source), properLayout, _gxCtx->getAllocatedBuffer(destination)->_vkBuffer, 1, &region);
 	}
 }
 
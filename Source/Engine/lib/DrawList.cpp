@@ -0,0 +1,291 @@
+#include "Slate/DrawList.h"
+
+#include <algorithm>
+
+#include "Slate/CommandBuffer.h"
+#include "Slate/Common/HelperMacros.h"
+#include "Slate/GX.h"
+
+namespace Slate {
+	// extra push constants start here, DrawListPushConstants is exactly 16 bytes
+	constexpr uint32_t kExtraPushOffset = sizeof(GPU::DrawListPushConstants);
+	// numthreads of both culling entry points
+	constexpr uint32_t kCullWorkgroupSize = 64;
+
+	template<class Handle>
+	static bool IsSameHandle(const Handle& a, const Handle& b) {
+		return a.index() == b.index() && a.gen() == b.gen();
+	}
+	template<class Handle>
+	static bool IsHandleLess(const Handle& a, const Handle& b) {
+		return a.index() != b.index() ? a.index() < b.index() : a.gen() < b.gen();
+	}
+
+	DrawList::DrawList(GX& gx, uint32_t initialCapacity) : _gx(gx) {
+		_ensureCapacity(std::max(initialCapacity, 1u));
+	}
+	DrawList::~DrawList() {
+		_destroyFrameBuffers();
+	}
+
+	void DrawList::reset() {
+		_draws.clear();
+		_batches.clear();
+		_commandScratch.clear();
+	}
+	void DrawList::add(InternalPipelineHandle pipeline, const MeshData& mesh, const glm::mat4& modelMatrix, uint32_t id) {
+		const GeometryAllocation* alloc = _gx.getGeometryAllocation(mesh);
+		ASSERT_MSG(alloc && mesh.isIndexed(), "Draw lists only take indexed meshes from the geometry arena!");
+		_draws.push_back({
+				.pipeline = pipeline,
+				.geometry = mesh.getGeometryHandle(),
+				.indexCount = alloc->indexCount,
+				.firstIndex = alloc->firstIndex,
+				.vertexBufferAddress = _gx.meshVertexAddress(mesh),
+				.bounds = alloc->bounds,
+				.instance = {
+						.modelMatrix = modelMatrix,
+						.id = id,
+				},
+		});
+	}
+	void DrawList::upload() {
+		_batches.clear();
+		_commandScratch.clear();
+		if (_draws.empty()) {
+			return;
+		}
+		// stable so instances of a mesh keep the order they were added in
+		std::stable_sort(_draws.begin(), _draws.end(), [](const PendingDraw& a, const PendingDraw& b) {
+			if (!IsSameHandle(a.pipeline, b.pipeline)) return IsHandleLess(a.pipeline, b.pipeline);
+			return IsHandleLess(a.geometry, b.geometry);
+		});
+		_dataScratch.clear();
+		_instanceScratch.clear();
+		_cullScratch.clear();
+		_instanceCommandScratch.clear();
+		const bool isCulling = isCullingEnabled();
+		for (uint32_t i = 0; i < _draws.size(); i++) {
+			const PendingDraw& draw = _draws[i];
+			const bool newPipeline = _batches.empty() || !IsSameHandle(_batches.back().pipeline, draw.pipeline);
+			if (newPipeline) {
+				_batches.push_back({ .pipeline = draw.pipeline, .firstCommand = (uint32_t)_commandScratch.size() });
+			}
+			if (newPipeline || !IsSameHandle(_draws[i - 1].geometry, draw.geometry)) {
+				// firstInstance stays 0 in the command, the shader offsets by DrawData::firstInstance itself
+				_commandScratch.push_back({
+						.indexCount = draw.indexCount,
+						.instanceCount = 0,
+						.firstIndex = draw.firstIndex,
+						.vertexOffset = 0, // the vertex address in DrawData already points at the mesh
+						.firstInstance = 0,
+				});
+				_dataScratch.push_back({
+						.vertexBufferAddress = draw.vertexBufferAddress,
+						.firstInstance = i,
+				});
+				if (isCulling) {
+					_cullScratch.push_back({
+							.bounds = draw.bounds,
+							.vertexBufferAddress = draw.vertexBufferAddress,
+							.indexCount = draw.indexCount,
+							.firstIndex = draw.firstIndex,
+							.firstInstance = i,
+							.batch = (uint32_t)_batches.size() - 1,
+							.batchFirstCommand = _batches.back().firstCommand,
+					});
+				}
+				_batches.back().numCommands++;
+			}
+			_commandScratch.back().instanceCount++;
+			_instanceScratch.push_back(draw.instance);
+			if (isCulling) {
+				_instanceCommandScratch.push_back((uint32_t)_commandScratch.size() - 1);
+			}
+		}
+
+		// there are never more commands than instances, so one capacity covers all three buffers
+		_ensureCapacity((uint32_t)_draws.size());
+		_currentFrame = (_currentFrame + 1) % kNumFrameBuffers;
+		FrameBuffers& frame = _frames[_currentFrame];
+		// only blocks when the cpu is more than kNumFrameBuffers frames ahead
+		if (!frame.lastUse.empty()) {
+			_gx._imm->wait(frame.lastUse);
+		}
+		_gx.upload(frame.commands, _commandScratch.data(), sizeof(VkDrawIndexedIndirectCommand) * _commandScratch.size());
+		_gx.upload(frame.drawData, _dataScratch.data(), sizeof(GPU::DrawData) * _dataScratch.size());
+		_gx.upload(frame.instanceData, _instanceScratch.data(), sizeof(GPU::InstanceData) * _instanceScratch.size());
+		if (isCulling) {
+			_gx.upload(frame.cullCommands, _cullScratch.data(), sizeof(GPU::CullCommand) * _cullScratch.size());
+			_gx.upload(frame.instanceCommands, _instanceCommandScratch.data(), sizeof(uint32_t) * _instanceCommandScratch.size());
+		}
+		frame.lastUse = _gx._imm->getNextSubmitHandle();
+	}
+	void DrawList::setCulling(InternalComputePipelineHandle cullInstances, InternalComputePipelineHandle compactDraws) {
+		const bool wasCulling = isCullingEnabled();
+		_cullInstancesPipeline = cullInstances;
+		_compactDrawsPipeline = compactDraws;
+		if (!wasCulling && isCullingEnabled()) {
+			// the culling buffers are only made while it is enabled, recreate the frame buffers with them
+			const uint32_t capacity = _capacity;
+			_capacity = 0;
+			_ensureCapacity(capacity);
+		}
+	}
+	void DrawList::cull(CommandBuffer& cmd) const {
+		if (!isCullingEnabled() || _batches.empty()) {
+			return;
+		}
+		const FrameBuffers& frame = _frames[_currentFrame];
+		const uint32_t numBatches = getNumBatches();
+		const uint32_t numCommands = getNumCommands();
+		const uint32_t numInstances = getNumInstances();
+		const GPU::CullPushConstants constants = {
+				.cullCommandAddress = _gx.gpuAddress(frame.cullCommands),
+				.instanceDataAddress = _gx.gpuAddress(frame.instanceData),
+				.instanceCommandAddress = _gx.gpuAddress(frame.instanceCommands),
+				.culledCommandAddress = _gx.gpuAddress(frame.culledCommands),
+				.culledDrawDataAddress = _gx.gpuAddress(frame.culledDrawData),
+				.culledInstanceAddress = _gx.gpuAddress(frame.culledInstances),
+				.countAddress = _gx.gpuAddress(frame.counts),
+				.numInstances = numInstances,
+				.numCommands = numCommands,
+				.numBatches = numBatches,
+		};
+		cmd.cmdBeginScope("Draw List Culling");
+		cmd.cmdFillBuffer(frame.counts, 0, sizeof(uint32_t) * (numBatches + numCommands), 0);
+		cmd.cmdBufferBarrier(frame.counts, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		if (!_gx.isDrawIndirectCountSupported()) {
+			// without a gpu count every command of a batch is drawn, the ones compaction leaves untouched stay empty draws
+			cmd.cmdFillBuffer(frame.culledCommands, 0, sizeof(VkDrawIndexedIndirectCommand) * numCommands, 0);
+			cmd.cmdBufferBarrier(frame.culledCommands, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+		}
+
+		// every visible instance takes the next slot of its command
+		cmd.cmdBindComputePipeline(_cullInstancesPipeline);
+		cmd.cmdPushConstants(constants);
+		cmd.cmdDispatch((numInstances + kCullWorkgroupSize - 1) / kCullWorkgroupSize);
+		cmd.cmdBufferBarrier(frame.counts, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+
+		// commands left with any instances are packed to the front of their batch
+		cmd.cmdBindComputePipeline(_compactDrawsPipeline);
+		cmd.cmdPushConstants(constants);
+		cmd.cmdDispatch((numCommands + kCullWorkgroupSize - 1) / kCullWorkgroupSize);
+
+		cmd.cmdBufferBarrier(frame.culledCommands, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+		cmd.cmdBufferBarrier(frame.counts, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT);
+		cmd.cmdBufferBarrier(frame.culledDrawData, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+		cmd.cmdBufferBarrier(frame.culledInstances, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+		cmd.cmdEndScope();
+	}
+	void DrawList::submit(CommandBuffer& cmd, const void* extraPushData, uint32_t extraPushSize) const {
+		if (_batches.empty()) {
+			return;
+		}
+		const FrameBuffers& frame = _frames[_currentFrame];
+		const bool isCulling = isCullingEnabled();
+		cmd.cmdBindGeometryIndexBuffer();
+		for (uint32_t i = 0; i < _batches.size(); i++) {
+			const Batch& batch = _batches[i];
+			// SV_DrawIndex restarts at zero for every indirect call, so each batch gets its own base address
+			const GPU::DrawListPushConstants constants = {
+					.drawDataAddress = _gx.gpuAddress(isCulling ? frame.culledDrawData : frame.drawData, sizeof(GPU::DrawData) * batch.firstCommand),
+					.instanceDataAddress = _gx.gpuAddress(isCulling ? frame.culledInstances : frame.instanceData),
+			};
+			cmd.cmdBindRenderPipeline(batch.pipeline);
+			cmd.cmdPushConstants(constants);
+			if (extraPushData) {
+				cmd.cmdPushConstants(extraPushData, extraPushSize, kExtraPushOffset);
+			}
+			if (isCulling && _gx.isDrawIndirectCountSupported()) {
+				cmd.cmdDrawIndexedIndirectCount(frame.culledCommands, sizeof(VkDrawIndexedIndirectCommand) * batch.firstCommand, frame.counts, sizeof(uint32_t) * i, batch.numCommands);
+			} else {
+				cmd.cmdDrawIndexedIndirect(isCulling ? frame.culledCommands : frame.commands, sizeof(VkDrawIndexedIndirectCommand) * batch.firstCommand, batch.numCommands);
+			}
+		}
+	}
+
+	void DrawList::_ensureCapacity(uint32_t numDraws) {
+		if (numDraws <= _capacity) {
+			return;
+		}
+		const uint32_t newCapacity = std::max(_capacity * 2, numDraws);
+		// destroy is deferred, frames still in flight keep reading the old buffers
+		_destroyFrameBuffers();
+		for (FrameBuffers& frame : _frames) {
+			frame.commands = _gx.createBuffer({
+					.size = sizeof(VkDrawIndexedIndirectCommand) * newCapacity,
+					.usage = BufferUsageBits::BufferUsageBits_Indirect,
+					.storage = StorageType::HostVisible,
+					.debugName = "Draw List Commands"
+			});
+			frame.drawData = _gx.createBuffer({
+					.size = sizeof(GPU::DrawData) * newCapacity,
+					.usage = BufferUsageBits::BufferUsageBits_Storage,
+					.storage = StorageType::HostVisible,
+					.debugName = "Draw List Data"
+			});
+			frame.instanceData = _gx.createBuffer({
+					.size = sizeof(GPU::InstanceData) * newCapacity,
+					.usage = BufferUsageBits::BufferUsageBits_Storage,
+					.storage = StorageType::HostVisible,
+					.debugName = "Draw List Instances"
+			});
+			if (isCullingEnabled()) {
+				frame.cullCommands = _gx.createBuffer({
+						.size = sizeof(GPU::CullCommand) * newCapacity,
+						.usage = BufferUsageBits::BufferUsageBits_Storage,
+						.storage = StorageType::HostVisible,
+						.debugName = "Draw List Cull Commands"
+				});
+				frame.instanceCommands = _gx.createBuffer({
+						.size = sizeof(uint32_t) * newCapacity,
+						.usage = BufferUsageBits::BufferUsageBits_Storage,
+						.storage = StorageType::HostVisible,
+						.debugName = "Draw List Instance Commands"
+				});
+				frame.culledCommands = _gx.createBuffer({
+						.size = sizeof(VkDrawIndexedIndirectCommand) * newCapacity,
+						.usage = BufferUsageBits::BufferUsageBits_Indirect | BufferUsageBits::BufferUsageBits_Storage,
+						.storage = StorageType::Device,
+						.debugName = "Draw List Culled Commands"
+				});
+				frame.culledDrawData = _gx.createBuffer({
+						.size = sizeof(GPU::DrawData) * newCapacity,
+						.usage = BufferUsageBits::BufferUsageBits_Storage,
+						.storage = StorageType::Device,
+						.debugName = "Draw List Culled Data"
+				});
+				frame.culledInstances = _gx.createBuffer({
+						.size = sizeof(GPU::InstanceData) * newCapacity,
+						.usage = BufferUsageBits::BufferUsageBits_Storage,
+						.storage = StorageType::Device,
+						.debugName = "Draw List Culled Instances"
+				});
+				// batches never outnumber commands, so twice the capacity fits both kinds of counters
+				frame.counts = _gx.createBuffer({
+						.size = sizeof(uint32_t) * newCapacity * 2,
+						.usage = BufferUsageBits::BufferUsageBits_Indirect | BufferUsageBits::BufferUsageBits_Storage,
+						.storage = StorageType::Device,
+						.debugName = "Draw List Counts"
+				});
+			}
+			frame.lastUse = {};
+		}
+		_capacity = newCapacity;
+	}
+	void DrawList::_destroyFrameBuffers() {
+		for (FrameBuffers& frame : _frames) {
+			_gx.destroy(frame.commands);
+			_gx.destroy(frame.drawData);
+			_gx.destroy(frame.instanceData);
+			_gx.destroy(frame.cullCommands);
+			_gx.destroy(frame.instanceCommands);
+			_gx.destroy(frame.culledCommands);
+			_gx.destroy(frame.culledDrawData);
+			_gx.destroy(frame.culledInstances);
+			_gx.destroy(frame.counts);
+			frame = {};
+		}
+	}
+}
@@ -33,12 +33,12 @@ namespace Slate {
 			return;
 		}
 		hierarchy.children.push_back(entity.getHandle());
-		hierarchy.parent = this->_handle;
+		_registry.get<GameEntity::Hierarchy>(entity.getHandle()).parent = this->_handle;
 	}
 	void GameEntity::removeChild(GameEntity entity) {
 		GameEntity::Hierarchy& hierarchy = _registry.get<GameEntity::Hierarchy>(_handle);
 		hierarchy.children.erase_value(entity.getHandle());
-		hierarchy.parent = entt::null;
+		_registry.get<GameEntity::Hierarchy>(entity.getHandle()).parent = entt::null;
 	}
 
 	GameEntity GameEntity::getParent() {
@@ -0,0 +1,474 @@
+#include "Slate/FrameGraph.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "Slate/CommandBuffer.h"
+#include "Slate/Common/HelperMacros.h"
+#include "Slate/GX.h"
+#include "Slate/VK/vkinfo.h"
+#include "Slate/VK/vkutil.h"
+
+namespace Slate {
+	static constexpr uint64_t kBufferKeyBit = 1ull << 63;
+
+	template<class Handle>
+	static uint64_t ResourceKey(const Handle& handle, bool isBuffer) {
+		const uint64_t key = (uint64_t)handle.gen() << 32 | handle.index();
+		return isBuffer ? key | kBufferKeyBit : key & ~kBufferKeyBit;
+	}
+
+	struct AccessInfo {
+		VkImageLayout layout;
+		VkPipelineStageFlags2 stage;
+		VkAccessFlags2 readAccess;
+		VkAccessFlags2 writeAccess;
+	};
+	static AccessInfo GetTextureAccessInfo(TextureAccess access) {
+		switch (access) {
+			case TextureAccess::ColorAttachment:
+				return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+						 VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT };
+			case TextureAccess::DepthAttachment:
+				return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+						 VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+			case TextureAccess::Sampled:
+				return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+						 VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_NONE };
+			case TextureAccess::Storage:
+				return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+						 VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT };
+			case TextureAccess::TransferSrc:
+				return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+						 VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE };
+			case TextureAccess::TransferDst:
+				return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+						 VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT };
+		}
+		return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT };
+	}
+	static AccessInfo GetBufferAccessInfo(BufferAccess access) {
+		// buffers are reached through device addresses from any shader stage
+		constexpr VkPipelineStageFlags2 kShaderStages = VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		switch (access) {
+			case BufferAccess::Uniform:
+				return { VK_IMAGE_LAYOUT_UNDEFINED, kShaderStages, VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_NONE };
+			case BufferAccess::Storage:
+				return { VK_IMAGE_LAYOUT_UNDEFINED, kShaderStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT };
+			case BufferAccess::Index:
+				return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_ACCESS_2_NONE };
+			case BufferAccess::Indirect:
+				return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_ACCESS_2_NONE };
+			case BufferAccess::TransferSrc:
+				return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE };
+			case BufferAccess::TransferDst:
+				return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT };
+		}
+		return { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT };
+	}
+
+	// PASS DECLARATION //
+	FrameGraph::Pass& FrameGraph::Pass::read(InternalTextureHandle texture, TextureAccess access) {
+		_use({ .key = ResourceKey(texture, false), .texture = texture, .access = (uint8_t)access, .isRead = true });
+		return *this;
+	}
+	FrameGraph::Pass& FrameGraph::Pass::write(InternalTextureHandle texture, TextureAccess access) {
+		_use({ .key = ResourceKey(texture, false), .texture = texture, .access = (uint8_t)access, .isWrite = true });
+		return *this;
+	}
+	FrameGraph::Pass& FrameGraph::Pass::read(InternalBufferHandle buffer, BufferAccess access) {
+		_use({ .key = ResourceKey(buffer, true), .buffer = buffer, .access = (uint8_t)access, .isRead = true });
+		return *this;
+	}
+	FrameGraph::Pass& FrameGraph::Pass::write(InternalBufferHandle buffer, BufferAccess access) {
+		_use({ .key = ResourceKey(buffer, true), .buffer = buffer, .access = (uint8_t)access, .isWrite = true });
+		return *this;
+	}
+	FrameGraph::Pass& FrameGraph::Pass::setRenderPass(const RenderPassBuilder& builder, RenderingContents contents) {
+		_renderingContents = contents;
+		_renderPass = builder.getRenderPass();
+		_hasRenderPass = true;
+		for (uint32_t i = 0; i < builder.getNumColorAttachments(); i++) {
+			const RenderPass::ColorAttachmentDesc& color = _renderPass.color[i];
+			_use({ .key = ResourceKey(color.texture, false), .texture = color.texture, .access = (uint8_t)TextureAccess::ColorAttachment,
+				   .isRead = color.loadOp == LoadOperation::LOAD, .isWrite = true });
+			if (color.resolveTexture.valid()) {
+				write(color.resolveTexture, TextureAccess::ColorAttachment);
+			}
+		}
+		if (builder.hasDepthAttachment()) {
+			const RenderPass::DepthAttachmentDesc& depth = _renderPass.depth;
+			_use({ .key = ResourceKey(depth.texture, false), .texture = depth.texture, .access = (uint8_t)TextureAccess::DepthAttachment,
+				   .isRead = depth.loadOp == LoadOperation::LOAD, .isWrite = true });
+			if (depth.resolveTexture.valid()) {
+				_use({ .key = ResourceKey(depth.resolveTexture, false), .texture = depth.resolveTexture, .access = (uint8_t)TextureAccess::DepthAttachment,
+					   .isWrite = true, .isResolve = true });
+			}
+		}
+		return *this;
+	}
+	FrameGraph::Pass& FrameGraph::Pass::setSideEffect() {
+		_hasSideEffect = true;
+		return *this;
+	}
+	FrameGraph::Pass& FrameGraph::Pass::setExecute(ExecuteFn fn) {
+		_execute = std::move(fn);
+		return *this;
+	}
+	void FrameGraph::Pass::_use(const Use& use) {
+		// a pass touches each resource once, declaring it again just widens read/write
+		for (Use& existing : _uses) {
+			if (existing.key != use.key) continue;
+			ASSERT_MSG(existing.access == use.access, "Pass '{}' uses the same resource in two different ways!", _name);
+			existing.isRead |= use.isRead;
+			existing.isWrite |= use.isWrite;
+			existing.isResolve |= use.isResolve;
+			return;
+		}
+		_uses.push_back(use);
+	}
+
+	// GRAPH //
+	void FrameGraph::reset() {
+		_passes.clear();
+		_outputs.clear();
+		_transients.clear();
+		_order.clear();
+		_isCompiled = false;
+	}
+	FrameGraph::Pass& FrameGraph::addPass(const char* name) {
+		_isCompiled = false;
+		Pass& pass = _passes.emplace_back();
+		pass._name = name;
+		return pass;
+	}
+	void FrameGraph::markOutput(InternalTextureHandle texture, TextureAccess finalAccess) {
+		_outputs.push_back({ texture, finalAccess, true });
+	}
+	void FrameGraph::markOutput(InternalTextureHandle texture) {
+		_outputs.push_back({ texture, TextureAccess::Sampled, false });
+	}
+	void FrameGraph::markTransient(InternalTextureHandle texture) {
+		_transients.push_back(texture);
+	}
+
+	void FrameGraph::compile() {
+		_cull();
+		_computeLevels();
+		_isCompiled = true;
+	}
+	void FrameGraph::_cull() {
+		// walk backwards, a pass survives if a surviving pass (or the outside world) consumes something it writes
+		std::unordered_set<uint64_t> needed;
+		for (const Output& output : _outputs) {
+			needed.insert(ResourceKey(output.texture, false));
+		}
+		_stats = { .declaredPasses = (uint32_t)_passes.size() };
+		for (int32_t i = (int32_t)_passes.size() - 1; i >= 0; i--) {
+			Pass& pass = _passes[i];
+			pass._isAlive = pass._hasSideEffect;
+			for (const Pass::Use& use : pass._uses) {
+				if (use.isWrite && needed.contains(use.key)) {
+					pass._isAlive = true;
+					break;
+				}
+			}
+			if (!pass._isAlive) {
+				_stats.culledPasses++;
+				continue;
+			}
+			for (const Pass::Use& use : pass._uses) {
+				// a full overwrite means nothing written before it is needed anymore
+				if (use.isWrite && !use.isRead) {
+					needed.erase(use.key);
+				}
+			}
+			for (const Pass::Use& use : pass._uses) {
+				if (use.isRead) {
+					needed.insert(use.key);
+				}
+			}
+		}
+	}
+	void FrameGraph::_computeLevels() {
+		// a pass sits one level after the deepest pass it depends on, passes sharing a level never touch
+		// the same resource in conflicting ways so their barriers can go out together
+		struct Tracker {
+			int32_t lastWriter = -1;
+			std::vector<std::pair<uint32_t, uint8_t>> readers; // pass, access
+		};
+		std::unordered_map<uint64_t, Tracker> trackers;
+		std::vector<std::vector<uint32_t>> dependents(_passes.size());
+		_order.clear();
+		for (uint32_t i = 0; i < _passes.size(); i++) {
+			Pass& pass = _passes[i];
+			if (!pass._isAlive) continue;
+			uint32_t level = 0;
+			const auto dependOn = [&](uint32_t other) {
+				level = std::max(level, _passes[other]._level + 1);
+				dependents[other].push_back(i);
+			};
+			for (const Pass::Use& use : pass._uses) {
+				Tracker& tracker = trackers[use.key];
+				if (tracker.lastWriter >= 0) {
+					dependOn(tracker.lastWriter);
+				}
+				const bool isBuffer = use.key & kBufferKeyBit;
+				for (const auto& [reader, access] : tracker.readers) {
+					// reads only conflict with each other when they want a different image layout
+					if (use.isWrite || (!isBuffer && access != use.access)) {
+						dependOn(reader);
+					}
+				}
+			}
+			pass._level = level;
+			for (const Pass::Use& use : pass._uses) {
+				Tracker& tracker = trackers[use.key];
+				if (use.isWrite) {
+					tracker.lastWriter = (int32_t)i;
+					tracker.readers.clear();
+				} else {
+					tracker.readers.emplace_back(i, use.access);
+				}
+			}
+			_order.push_back(i);
+		}
+		// then push every pass as late as its consumers allow, whatever it writes is alive for fewer levels
+		// and transient textures get more chances to share memory, see computeAliasGroups
+		uint32_t maxLevel = 0;
+		for (uint32_t index : _order) {
+			maxLevel = std::max(maxLevel, _passes[index]._level);
+		}
+		for (auto it = _order.rbegin(); it != _order.rend(); ++it) {
+			uint32_t level = maxLevel;
+			for (uint32_t dependent : dependents[*it]) {
+				level = std::min(level, _passes[dependent]._level - 1);
+			}
+			_passes[*it]._level = level;
+		}
+		std::stable_sort(_order.begin(), _order.end(), [this](uint32_t a, uint32_t b) {
+			return _passes[a]._level < _passes[b]._level;
+		});
+	}
+
+	FrameGraph::ResourceState& FrameGraph::_getState(const Pass::Use& use) {
+		const bool isBuffer = use.key & kBufferKeyBit;
+		auto [it, inserted] = _states.try_emplace(use.key);
+		ResourceState& state = it->second;
+		if (isBuffer) {
+			if (inserted) {
+				// whatever touched it last frame or from the host, wait on all of it once
+				state = { .stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_WRITE_BIT, .isWrite = true };
+			}
+			return state;
+		}
+		ASSERT_MSG(_gx._texturePool.get(use.texture)->isLayoutUniform(), "Texture '{}' needs to be in a single layout before the graph can track it!", _gx._texturePool.get(use.texture)->_debugName);
+		// a pass may have transitioned the texture itself, trust the tracked layout over ours
+		const VkImageLayout currentLayout = _gx.getTextureCurrentLayout(use.texture);
+		if (const auto transient = _transientGroups.find(use.key); inserted && transient != _transientGroups.end()) {
+			// nothing from before is needed, only whoever used the memory last has to be done with it
+			const vkutil::StageAccess previous = vkutil::getPipelineStageAccess(currentLayout);
+			state = { .layout = VK_IMAGE_LAYOUT_UNDEFINED, .stage = previous.stage, .access = previous.access, .isWrite = true };
+			if (transient->second) {
+				const auto occupant = _groupOccupants.find(transient->second);
+				if (occupant != _groupOccupants.end()) {
+					const ResourceState& other = _states.at(occupant->second);
+					state.stage = other.stage;
+					state.access = other.isWrite ? other.access : VK_ACCESS_2_NONE;
+				} else {
+					// the last member to use it was in an earlier frame, no telling which
+					state.stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+					state.access = VK_ACCESS_2_MEMORY_WRITE_BIT;
+				}
+			}
+			return state;
+		}
+		if (inserted || state.layout != currentLayout) {
+			const vkutil::StageAccess previous = vkutil::getPipelineStageAccess(currentLayout);
+			state = { .layout = currentLayout, .stage = previous.stage, .access = previous.access, .isWrite = true };
+		}
+		return state;
+	}
+	void FrameGraph::_requireAccess(const Pass::Use& use) {
+		const bool isBuffer = use.key & kBufferKeyBit;
+		AccessInfo info = isBuffer ? GetBufferAccessInfo((BufferAccess)use.access) : GetTextureAccessInfo((TextureAccess)use.access);
+		if (use.isResolve) {
+			// https://registry.khronos.org/vulkan/specs/latest/html/vkspec.html#renderpass-resolve-operations
+			info.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			info.writeAccess |= VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		}
+		const VkAccessFlags2 access = (use.isRead || !use.isWrite ? info.readAccess : 0) | (use.isWrite ? info.writeAccess : 0);
+
+		ResourceState& state = _getState(use);
+		const bool layoutChange = !isBuffer && state.layout != info.layout;
+		const auto batched = _batchedBarriers.find(use.key);
+		if (!layoutChange && !state.isWrite && !use.isWrite) {
+			// read after read, nothing to wait on but a barrier already queued this batch has to cover us too
+			if (batched != _batchedBarriers.end()) {
+				if (isBuffer) {
+					_bufferBarriers[batched->second].dstStageMask |= info.stage;
+					_bufferBarriers[batched->second].dstAccessMask |= access;
+				} else {
+					_imageBarriers[batched->second].dstStageMask |= info.stage;
+					_imageBarriers[batched->second].dstAccessMask |= access;
+				}
+			}
+			state.stage |= info.stage;
+			state.access |= access;
+			return;
+		}
+		ASSERT_MSG(batched == _batchedBarriers.end(), "Resource needs two barriers in one batch, pass levels are wrong!");
+		// write after read only needs the execution dependency
+		const VkAccessFlags2 srcAccess = state.isWrite ? state.access : VK_ACCESS_2_NONE;
+		if (isBuffer) {
+			_batchedBarriers[use.key] = (uint32_t)_bufferBarriers.size();
+			_bufferBarriers.push_back({
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					.srcStageMask = state.stage,
+					.srcAccessMask = srcAccess,
+					.dstStageMask = info.stage,
+					.dstAccessMask = access,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.buffer = _gx.getAllocatedBuffer(use.buffer)->_vkBuffer,
+					.offset = 0,
+					.size = VK_WHOLE_SIZE
+			});
+		} else {
+			_batchedBarriers[use.key] = (uint32_t)_imageBarriers.size();
+			_imageBarriers.push_back({
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = state.stage,
+					.srcAccessMask = srcAccess,
+					.dstStageMask = info.stage,
+					.dstAccessMask = access,
+					.oldLayout = state.layout,
+					.newLayout = info.layout,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = _gx.getTextureImage(use.texture),
+					.subresourceRange = vkinfo::CreateImageSubresourceRange(vkutil::AspectMaskFromFormat(_gx.getTextureFormat(use.texture)))
+			});
+			_gx._texturePool.get(use.texture)->_setLayout(info.layout);
+		}
+		if (const auto transient = _transientGroups.find(use.key); transient != _transientGroups.end() && transient->second) {
+			_groupOccupants[transient->second] = use.key;
+		}
+		state = { .layout = info.layout, .stage = info.stage, .access = access, .isWrite = use.isWrite };
+	}
+	void FrameGraph::_flushBarriers(CommandBuffer& cmd) {
+		if (!_imageBarriers.empty() || !_bufferBarriers.empty()) {
+			// the command buffer records them right before the next pass needs them, together with whatever that pass queues itself
+			cmd.cmdPipelineBarrier(_imageBarriers, _bufferBarriers);
+			_stats.barrierBatches++;
+			_stats.imageBarriers += (uint32_t)_imageBarriers.size();
+			_stats.bufferBarriers += (uint32_t)_bufferBarriers.size();
+		}
+		_imageBarriers.clear();
+		_bufferBarriers.clear();
+		_batchedBarriers.clear();
+	}
+
+	void FrameGraph::execute(CommandBuffer& cmd) {
+		if (!_isCompiled) {
+			compile();
+		}
+		_states.clear();
+		_transientGroups.clear();
+		_groupOccupants.clear();
+		for (InternalTextureHandle texture : _transients) {
+			_transientGroups[ResourceKey(texture, false)] = _gx.getTextureAliasGroup(texture);
+		}
+		_stats.barrierBatches = 0;
+		_stats.imageBarriers = 0;
+		_stats.bufferBarriers = 0;
+		for (uint32_t first = 0; first < _order.size();) {
+			// every pass of a level gets its barriers in one go before the first of them runs
+			const uint32_t level = _passes[_order[first]]._level;
+			uint32_t last = first;
+			while (last < _order.size() && _passes[_order[last]]._level == level) {
+				for (const Pass::Use& use : _passes[_order[last]]._uses) {
+					_requireAccess(use);
+				}
+				last++;
+			}
+			_flushBarriers(cmd);
+			for (uint32_t i = first; i < last; i++) {
+				const Pass& pass = _passes[_order[i]];
+				// render passes open their gpu scope themselves, everything else gets one named after the pass
+				if (pass._hasRenderPass) {
+					RenderPass renderPass = pass._renderPass;
+					renderPass.debugName = pass._name.c_str();
+					cmd.cmdBeginRendering(renderPass, {}, pass._renderingContents);
+				} else {
+					cmd.cmdBeginScope(pass._name.c_str());
+				}
+				if (pass._execute) {
+					pass._execute(cmd);
+				}
+				if (pass._hasRenderPass) {
+					cmd.cmdEndRendering();
+				} else {
+					cmd.cmdEndScope();
+				}
+			}
+			first = last;
+		}
+		for (const Output& output : _outputs) {
+			if (!output.hasFinalAccess) continue;
+			_requireAccess({ .key = ResourceKey(output.texture, false), .texture = output.texture, .access = (uint8_t)output.finalAccess, .isRead = true });
+		}
+		_flushBarriers(cmd);
+	}
+	std::vector<std::vector<InternalTextureHandle>> FrameGraph::computeAliasGroups() const {
+		ASSERT_MSG(_isCompiled, "Compile the graph before asking it for alias groups!");
+		struct Lifetime {
+			InternalTextureHandle texture;
+			uint32_t first = UINT32_MAX;
+			uint32_t last = 0;
+		};
+		// in levels not passes, barriers of a whole level go out before any of its passes run
+		std::vector<Lifetime> lifetimes;
+		for (InternalTextureHandle texture : _transients) {
+			Lifetime lifetime = { .texture = texture };
+			const uint64_t key = ResourceKey(texture, false);
+			for (uint32_t index : _order) {
+				const Pass& pass = _passes[index];
+				for (const Pass::Use& use : pass._uses) {
+					if (use.key != key) continue;
+					lifetime.first = std::min(lifetime.first, pass._level);
+					lifetime.last = std::max(lifetime.last, pass._level);
+				}
+			}
+			if (lifetime.first != UINT32_MAX) {
+				lifetimes.push_back(lifetime);
+			}
+		}
+		std::stable_sort(lifetimes.begin(), lifetimes.end(), [](const Lifetime& a, const Lifetime& b) { return a.first < b.first; });
+
+		// first fit, a group takes the next texture once everything in it is done
+		std::vector<std::vector<InternalTextureHandle>> groups;
+		std::vector<uint32_t> groupEnds;
+		for (const Lifetime& lifetime : lifetimes) {
+			size_t group = 0;
+			while (group < groups.size() && groupEnds[group] >= lifetime.first) {
+				group++;
+			}
+			if (group == groups.size()) {
+				groups.emplace_back();
+				groupEnds.push_back(0);
+			}
+			groups[group].push_back(lifetime.texture);
+			groupEnds[group] = lifetime.last;
+		}
+		return groups;
+	}
+	std::vector<const char*> FrameGraph::getExecutionOrder() const {
+		std::vector<const char*> names;
+		names.reserve(_order.size());
+		for (uint32_t index : _order) {
+			names.push_back(_passes[index]._name.c_str());
+		}
+		return names;
+	}
+}
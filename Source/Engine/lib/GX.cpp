@@ -5,6 +5,7 @@
 
 #include "Slate/Common/HelperMacros.h"
 #include "Slate/Common/Logger.h"
+#include "Slate/Filesystem.h"
 #include "Slate/GX.h"
 
 #include "Slate/Resources/MeshResource.h"
@@ -13,11 +14,21 @@
 #include "Slate/VK/vkutil.h"
 
 #include "Slate/CommandBuffer.h"
+#include "Slate/Timer.h"
 #include "Slate/VulkanSwapchain.h"
 
 
 #include <GLFW/glfw3.h>
-
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
 #include <utility>
 
 namespace Slate {
@@ -27,12 +38,62 @@ namespace Slate {
 	enum Bindings {
 		kGlobalBinding = 0,
 
-		kTextureBinding = 0,
+		// only the highest binding may have a variable count, the sampled textures are the array that grows
+		kStorageImageBinding = 0,
 		kSamplerBinding = 1,
-		kStorageImageBinding = 2,
+		kTextureBinding = 2,
 
 		kNumBindlessBindings = 3,
 	};
+	// the same bindless layout is bound at sets 0, 1 and 2, every descriptor counts three times against the pipeline layout limits
+	constexpr uint32_t kNumBindlessSets = 3;
+
+	// most sampled textures one bindless set may declare, every per-stage update after bind limit is shared by all
+	// three sets and the global uniform buffer, next to the fixed sampler and storage image bindings
+	static uint32_t MaxBindlessTextures(const VkPhysicalDeviceVulkan12Properties& props12, uint32_t numSamplers, uint32_t numStorageImages) {
+		const uint32_t maxResources = props12.maxPerStageUpdateAfterBindResources > 1 ? (props12.maxPerStageUpdateAfterBindResources - 1) / kNumBindlessSets : 0;
+		const uint32_t otherResources = numSamplers + numStorageImages;
+		return std::min({props12.maxDescriptorSetUpdateAfterBindSampledImages / kNumBindlessSets,
+						 props12.maxPerStageDescriptorUpdateAfterBindSampledImages / kNumBindlessSets,
+						 maxResources > otherResources ? maxResources - otherResources : 0});
+	}
+
+	// every field of a sampler spec but its name fits in one integer, so equal keys always mean equal samplers
+	static uint64_t SamplerCacheKey(const SamplerSpec& spec) {
+		return (uint64_t)spec.magFilter |
+			   (uint64_t)spec.minFilter << 8 |
+			   (uint64_t)spec.wrapU << 16 |
+			   (uint64_t)spec.wrapV << 24 |
+			   (uint64_t)spec.wrapW << 32 |
+			   (uint64_t)spec.mipMap << 40 |
+			   (uint64_t)spec.anistrophic << 48;
+	}
+	static void HashCombine(size_t& seed, size_t value) {
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+	static size_t HashPipelineSpec(const PipelineSpec& spec) {
+		size_t seed = 0;
+		HashCombine(seed, (size_t)spec.topology);
+		HashCombine(seed, (size_t)spec.polygon);
+		HashCombine(seed, (size_t)spec.blend);
+		HashCombine(seed, (size_t)spec.cull);
+		HashCombine(seed, (size_t)spec.multisample);
+		for (VkFormat format : spec.formats.colorFormats) {
+			HashCombine(seed, (size_t)format);
+		}
+		HashCombine(seed, (size_t)spec.formats.depthFormat);
+		HashCombine(seed, ((size_t)spec.shaderhandle.index() << 32) | spec.shaderhandle.gen());
+		HashCombine(seed, ((size_t)spec.fallback.index() << 32) | spec.fallback.gen());
+		return seed;
+	}
+	// hashes can collide, only share a pipeline when the specs are actually the same
+	static bool IsSamePipelineSpec(const PipelineSpec& a, const PipelineSpec& b) {
+		return a.topology == b.topology && a.polygon == b.polygon && a.blend == b.blend && a.cull == b.cull &&
+			   a.multisample == b.multisample &&
+			   a.formats.colorFormats == b.formats.colorFormats && a.formats.depthFormat == b.formats.depthFormat &&
+			   a.shaderhandle.index() == b.shaderhandle.index() && a.shaderhandle.gen() == b.shaderhandle.gen() &&
+			   a.fallback.index() == b.fallback.index() && a.fallback.gen() == b.fallback.gen();
+	}
 
 	VkMemoryPropertyFlags StorageTypeToVkMemoryPropertyFlags(StorageType storage) {
 		VkMemoryPropertyFlags memFlags{0};
@@ -49,6 +110,19 @@ namespace Slate {
 		}
 		return memFlags;
 	}
+	// prefixed to the raw VkPipelineCache blob on disk, the driver validates its own header
+	// but not the driver version, so a driver update could otherwise feed it stale data
+	struct PipelineCacheFileHeader
+	{
+		uint32_t magic;
+		uint32_t dataSize;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t uuid[VK_UUID_SIZE];
+	};
+	constexpr uint32_t kPipelineCacheMagic = 0x534C5043; // "SLPC"
+
 	VkSemaphore CreateTimelineSemaphore(VkDevice device, unsigned int numImages) {
 		const VkSemaphoreTypeCreateInfo smeaphore_type_ci = {
 				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
@@ -67,9 +141,19 @@ namespace Slate {
 	// if glfwWindow is nullptr than we run headless
 	void GX::create(VulkanInstanceInfo info, GLFWwindow* glfWwindow) {
 		_backend.initialize(glfWwindow, info);
+		_createPipelineCache(info.pipeline_cache_path);
+		{
+			const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+			const uint32_t numThreads = info.pipeline_compile_threads ? info.pipeline_compile_threads : hardwareThreads - 1;
+			_pipelineCompiler = CreateUniquePtr<PipelineCompiler>(_backend.getDevice(), _vkPipelineCache, numThreads);
+			_isAsyncPipelineCompilation = info.async_pipeline_compilation;
+		}
 		// always initialize right after backend
 		_imm = CreateUniquePtr<VulkanImmediateCommands>(_backend.getDevice(), _backend.getGraphicsQueueFamilyIndex());
 		_staging = CreateUniquePtr<VulkanStagingDevice>(*this);
+		_readback = CreateUniquePtr<VulkanReadbackDevice>(*this);
+		_profiler = CreateUniquePtr<VulkanProfiler>(*this);
+		_profiler->setEnabled(info.gpu_profiling);
 		// default textures
 		{
 			// pattern xor
@@ -93,9 +177,12 @@ namespace Slate {
 		// ALWAYS initialize swapchain after dummy textures, as swapcahin creates texture handles of its own!!
 		if (glfWwindow) {
 			_swapchain = CreateUniquePtr<VulkanSwapchain>(*this);
-			// timeline semaphore is closely kept to vulkan swapchain
-			_timelineSemaphore = CreateTimelineSemaphore(_backend.getDevice(), _swapchain->getNumOfSwapchainImages() - 1);
+		} else {
+			_swapchain = CreateUniquePtr<VulkanSwapchain>(*this, (uint16_t)info.headless_extent.width, (uint16_t)info.headless_extent.height);
+			LOG_USER(LogType::Info, "Running headless at {}x{}", info.headless_extent.width, info.headless_extent.height);
 		}
+		// timeline semaphore is closely kept to vulkan swapchain
+		_timelineSemaphore = CreateTimelineSemaphore(_backend.getDevice(), _swapchain->getNumOfSwapchainImages() - 1);
 		// default samplers
 		{
 			_linearSamplerHandle = this->createSampler({
@@ -134,7 +221,7 @@ namespace Slate {
 						.binding = 0,
 						.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
 						.descriptorCount = 1,
-						.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+						.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
 				};
 				VkDescriptorSetLayoutCreateInfo dsl_ci = {
 						.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -185,19 +272,45 @@ namespace Slate {
 			}
 		}
 
+		// GEOMETRY ARENA
+		_createGeometryArena(info.geometry_vertex_capacity, info.geometry_index_capacity);
+
+		if (info.preallocate_bindless) {
+			const VkPhysicalDeviceVulkan12Properties props12 = _backend.getPhysDevicePropertiesV12();
+			const uint32_t maxTextures = std::min({props12.maxDescriptorSetUpdateAfterBindSampledImages,
+												   props12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+												   props12.maxDescriptorSetUpdateAfterBindStorageImages,
+												   props12.maxPerStageDescriptorUpdateAfterBindStorageImages}) / kNumBindlessSets;
+			const uint32_t maxSamplers = std::min({props12.maxDescriptorSetUpdateAfterBindSamplers,
+												   props12.maxPerStageDescriptorUpdateAfterBindSamplers}) / kNumBindlessSets;
+			_currentMaxSamplerCount = static_cast<uint16_t>(std::min({info.max_bindless_samplers, maxSamplers, (uint32_t)UINT16_MAX}));
+			// every texture takes a sampled and a storage slot, both count against the per-stage resource limit
+			const uint32_t maxResources = props12.maxPerStageUpdateAfterBindResources > 1 ? (props12.maxPerStageUpdateAfterBindResources - 1) / kNumBindlessSets : 0;
+			const uint32_t maxTexturesByResources = maxResources > _currentMaxSamplerCount ? (maxResources - _currentMaxSamplerCount) / 2 : 0;
+			_currentMaxTextureCount = std::min({info.max_bindless_textures, maxTextures, maxTexturesByResources});
+			_isBindlessPreallocated = true;
+			LOG_USER(LogType::Info, "Preallocated bindless capacity: {} textures, {} samplers", _currentMaxTextureCount, _currentMaxSamplerCount);
+		}
 		growDescriptorPool(_currentMaxTextureCount, _currentMaxSamplerCount);
 
 	}
 	void GX::destroy() {
 		VK_CHECK(vkDeviceWaitIdle(_backend.getDevice()));
-		// more like awaitingDestruction :0
-		_awaitingCreation = true;
 
+		// let in-flight compiles land in the pool so the leak pass below frees them
+		_pipelineCompiler->waitIdle();
+		_collectCompiledPipelines();
+		_pipelineCompiler.reset(nullptr);
+
+		_profiler.reset(nullptr);
+		_readback.reset(nullptr);
 		_staging.reset(nullptr);
 		_swapchain.reset(nullptr);
 		vkDestroySemaphore(_backend.getDevice(), _timelineSemaphore, nullptr);
 		destroy(_dummyTextureHandle);
 		destroy(_globalBufferHandle);
+		destroy(_geometryVertexBuffer);
+		destroy(_geometryIndexBuffer);
 		destroy(_linearSamplerHandle);
 		destroy(_nearestSamplerHandle);
 
@@ -212,14 +325,27 @@ namespace Slate {
 		if (_pipelinePool.numObjects()) {
 			LOG_USER(LogType::Warning, "Leaked {} render pipelines", _pipelinePool.numObjects());
 			for (int i = 0; i < _pipelinePool._objects.size(); i++) {
-				destroy(_pipelinePool.getHandle(_pipelinePool.findObject(&_pipelinePool._objects[i]._obj).index()));
+				// shared handles need one destroy per reference
+				const InternalPipelineHandle handle = _pipelinePool.getHandle(_pipelinePool.findObject(&_pipelinePool._objects[i]._obj).index());
+				while (_pipelinePool.get(handle)) {
+					destroy(handle);
+				}
+			}
+		}
+		if (_computePipelinePool.numObjects()) {
+			LOG_USER(LogType::Warning, "Leaked {} compute pipelines", _computePipelinePool.numObjects());
+			for (int i = 0; i < _computePipelinePool._objects.size(); i++) {
+				destroy(_computePipelinePool.getHandle(_computePipelinePool.findObject(&_computePipelinePool._objects[i]._obj).index()));
 			}
 		}
 		if (_samplerPool.numObjects() > 1) {
 			// the dummy value is owned by the context
 			LOG_USER(LogType::Warning, "Leaked {} samplers", _samplerPool.numObjects() - 1);
 			for (int i = 0; i < _samplerPool._objects.size(); i++) {
-				destroy(_samplerPool.getHandle(_samplerPool.findObject(&_samplerPool._objects[i]._obj).index()));
+				const InternalSamplerHandle handle = _samplerPool.getHandle(_samplerPool.findObject(&_samplerPool._objects[i]._obj).index());
+				while (_samplerPool.get(handle)) {
+					destroy(handle);
+				}
 			}
 		}
 		if (_texturePool.numObjects()) {
@@ -240,6 +366,19 @@ namespace Slate {
 		_samplerPool.clear();
 		_shaderPool.clear();
 		_pipelinePool.clear();
+		_computePipelinePool.clear();
+		_geometryPool.clear();
+		_samplerLookup.clear();
+		_pipelineLookup.clear();
+		// layouts still referenced here belonged to pipelines that were never destroyed
+		for (const auto& [key, cached] : _pipelineLayoutCache) {
+			vkDestroyPipelineLayout(_backend.getDevice(), cached.layout, nullptr);
+		}
+		_pipelineLayoutCache.clear();
+		for (const CachedPipelineLayout& cached : _retiredPipelineLayouts) {
+			vkDestroyPipelineLayout(_backend.getDevice(), cached.layout, nullptr);
+		}
+		_retiredPipelineLayouts.clear();
 
 		waitDeferredTasks();
 
@@ -250,6 +389,10 @@ namespace Slate {
 		vkDestroyDescriptorSetLayout(_backend.getDevice(), _vkDSL, nullptr);
 		vkDestroyDescriptorPool(_backend.getDevice(), _vkDPool, nullptr);
 
+		_savePipelineCache();
+		vkDestroyPipelineCache(_backend.getDevice(), _vkPipelineCache, nullptr);
+		_vkPipelineCache = VK_NULL_HANDLE;
+
 		_backend.terminate();
 	}
 	VkDeviceAddress GX::gpuAddress(InternalBufferHandle handle, size_t offset) {
@@ -260,7 +403,9 @@ namespace Slate {
 	CommandBuffer& GX::acquireCommand() {
 		ASSERT_MSG(!_currentCommandBuffer._gxCtx, "Cannot acquireSwap more than 1 Command Buffer simultaneously!");
 
+		_collectCompiledPipelines();
 		_currentCommandBuffer = CommandBuffer(this);
+		_profiler->beginCommandBuffer(_currentCommandBuffer._vkCmdBuf);
 		return _currentCommandBuffer;
 	}
 	void GX::submitCommand(CommandBuffer& cmd, InternalTextureHandle texture) {
@@ -275,11 +420,17 @@ namespace Slate {
 			_swapchain->_timelineWaitValues[_swapchain->_currentImageIndex] = signalValue;
 			_imm->signalSemaphore(_timelineSemaphore, signalValue);
 		}
+		cmd.cmdFlushBarriers();
+		ASSERT_MSG(cmd._profileScopes.empty(), "Command Buffer was submitted with {} GPU scopes still open!", cmd._profileScopes.size());
 		cmd._lastSubmitHandle = _imm->submit(*cmd._wrapper);
+		_lastCommandStats = cmd._stats;
+		_profiler->onSubmit(cmd._lastSubmitHandle, itspresenttime);
 		if (itspresenttime) {
 			_swapchain->present();
 		}
 		processDeferredTasks();
+		_readback->process();
+		_profiler->process();
 		SubmitHandle handle = cmd._lastSubmitHandle;
 		// reset
 		_currentCommandBuffer = {};
@@ -314,7 +465,6 @@ namespace Slate {
 		if (spec.data) {
 			upload(handle, spec.data, spec.size);
 		}
-		_awaitingCreation = true;
 		return {handle};
 	}
 	AllocatedBuffer GX::createBufferImpl(VkDeviceSize bufferSize, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memFlags) {
@@ -440,8 +590,8 @@ namespace Slate {
 		AllocatedImage obj = createTextureImpl(usage_flags, mem_flags, extent3D, spec.format, _imagetype, _imageviewtype, 1, _numLayers, sample_bits, _imageCreateFlags);
 		snprintf(obj._debugName, sizeof(obj._debugName) - 1, "%s", spec.debugName);
 		InternalTextureHandle handle = _texturePool.create(std::move(obj));
+		_textureSlots.markDirty(handle.index());
 		// if we have some data we want to upload, do that
-		_awaitingCreation = true;
 		if (spec.data) {
 			ASSERT(spec.dataNumMipLevels <= spec.numMipLevels);
 			ASSERT(spec.type == TextureType::Type_2D || spec.type == TextureType::Type_Cube);
@@ -471,25 +621,72 @@ namespace Slate {
 		image->generateMipmap(wrapper._cmdBuf);
 		_imm->submit(wrapper);
 	}
+	VkImageLayout AllocatedImage::getSubresourceLayout(uint32_t level, uint32_t layer) const {
+		return _subresourceLayouts.empty() ? _vkCurrentImageLayout : _subresourceLayouts[level * _numLayers + layer];
+	}
+	void AllocatedImage::_setLayout(VkImageLayout layout) {
+		_vkCurrentImageLayout = layout;
+		_subresourceLayouts.clear();
+	}
+	void AllocatedImage::_setSubresourceLayout(const VkImageSubresourceRange& range, VkImageLayout layout) {
+		const uint32_t numLevels = (range.levelCount == VK_REMAINING_MIP_LEVELS) ? _numLevels - range.baseMipLevel : range.levelCount;
+		const uint32_t numLayers = (range.layerCount == VK_REMAINING_ARRAY_LAYERS) ? _numLayers - range.baseArrayLayer : range.layerCount;
+		if (range.baseMipLevel == 0 && numLevels == _numLevels && range.baseArrayLayer == 0 && numLayers == _numLayers) {
+			_setLayout(layout);
+			return;
+		}
+		if (_subresourceLayouts.empty()) {
+			_subresourceLayouts.assign(_numLevels * _numLayers, _vkCurrentImageLayout);
+		}
+		for (uint32_t level = range.baseMipLevel; level < range.baseMipLevel + numLevels; level++) {
+			for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + numLayers; layer++) {
+				_subresourceLayouts[level * _numLayers + layer] = layout;
+			}
+		}
+		// everything caught up again
+		if (std::all_of(_subresourceLayouts.begin(), _subresourceLayouts.end(), [layout](VkImageLayout other) { return other == layout; })) {
+			_setLayout(layout);
+			return;
+		}
+		_vkCurrentImageLayout = _subresourceLayouts[0];
+	}
 	void AllocatedImage::transitionLayout(VkCommandBuffer cmd, VkImageLayout newImageLayout, const VkImageSubresourceRange& subresourceRange) {
-		const VkImageLayout oldImageLayout = (_vkCurrentImageLayout == VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL)
-						? (isDepthAttachment() ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-						: _vkCurrentImageLayout;
 		if (newImageLayout == VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL) {
 			newImageLayout = isDepthAttachment() ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
-		vkutil::StageAccess src = vkutil::getPipelineStageAccess(oldImageLayout);
-		vkutil::StageAccess dst = vkutil::getPipelineStageAccess(newImageLayout);
-
-		if (isDepthAttachment() && _isResolveAttachment) {
-			// https://registry.khronos.org/vulkan/specs/latest/html/vkspec.html#renderpass-resolve-operations
-			src.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			dst.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			src.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
-			dst.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		const auto transition = [&](VkImageLayout currentLayout, const VkImageSubresourceRange& range) {
+			const VkImageLayout oldImageLayout = (currentLayout == VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL)
+							? (isDepthAttachment() ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+							: currentLayout;
+			vkutil::StageAccess src = vkutil::getPipelineStageAccess(oldImageLayout);
+			vkutil::StageAccess dst = vkutil::getPipelineStageAccess(newImageLayout);
+
+			if (isDepthAttachment() && _isResolveAttachment) {
+				// https://registry.khronos.org/vulkan/specs/latest/html/vkspec.html#renderpass-resolve-operations
+				src.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+				dst.stage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+				src.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+				dst.access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			}
+			vkutil::ImageMemoryBarrier2(cmd, _vkImage, src, dst, oldImageLayout, newImageLayout, range);
+		};
+		if (isLayoutUniform()) {
+			transition(_vkCurrentImageLayout, subresourceRange);
+		} else {
+			// mixed layouts, one barrier per run of layers that share their current layout
+			const uint32_t numLevels = (subresourceRange.levelCount == VK_REMAINING_MIP_LEVELS) ? _numLevels - subresourceRange.baseMipLevel : subresourceRange.levelCount;
+			const uint32_t numLayers = (subresourceRange.layerCount == VK_REMAINING_ARRAY_LAYERS) ? _numLayers - subresourceRange.baseArrayLayer : subresourceRange.layerCount;
+			for (uint32_t level = subresourceRange.baseMipLevel; level < subresourceRange.baseMipLevel + numLevels; level++) {
+				uint32_t first = subresourceRange.baseArrayLayer;
+				for (uint32_t layer = first + 1; layer <= subresourceRange.baseArrayLayer + numLayers; layer++) {
+					const VkImageLayout runLayout = getSubresourceLayout(level, first);
+					if (layer < subresourceRange.baseArrayLayer + numLayers && getSubresourceLayout(level, layer) == runLayout) continue;
+					transition(runLayout, { subresourceRange.aspectMask, level, 1, first, layer - first });
+					first = layer;
+				}
+			}
 		}
-		vkutil::ImageMemoryBarrier2(cmd, _vkImage, src, dst, oldImageLayout, newImageLayout, subresourceRange);
-		_vkCurrentImageLayout = newImageLayout;
+		_setSubresourceLayout(subresourceRange, newImageLayout);
 	}
 	void AllocatedImage::generateMipmap(VkCommandBuffer cmd) {
 		// Check if device supports downscaling for color or depth/stencil buffer based on image format
@@ -571,6 +768,8 @@ namespace Slate {
 				mipHeight = nextLevelHeight;
 			}
 		}
+		// every level was left as a blit source
+		_setLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 	}
 	AllocatedImage GX::createTextureImpl(VkImageUsageFlags usageFlags,
 										 VkMemoryPropertyFlags memFlags,
@@ -629,6 +828,11 @@ namespace Slate {
 		}
 
 		allocation_ci.usage = (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? VMA_MEMORY_USAGE_CPU_TO_GPU : VMA_MEMORY_USAGE_AUTO;
+		// desktop gpus usually have no lazily allocated memory, memoryless images just end up in regular device memory there
+		const bool isLazilyAllocated = (memFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) && _supportsLazilyAllocatedMemory();
+		if (isLazilyAllocated) {
+			allocation_ci.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+		}
 
 		AllocatedImage obj = {};
 		VK_CHECK(vmaCreateImage(_backend.getAllocator(), &image_ci, &allocation_ci, &obj._vkImage, &obj._vmaAllocation, nullptr));
@@ -639,36 +843,60 @@ namespace Slate {
 		obj._vkFormat = format;
 		obj._numLayers = numLayers;
 		obj._numLevels = numLevels;
+		obj._isLazilyAllocated = isLazilyAllocated;
+		if (isLazilyAllocated) {
+			_transientMemoryStats.lazilyAllocatedBytes += getImageMemoryRequirements(obj._vkImage).size;
+		}
 		vkGetPhysicalDeviceFormatProperties(_backend.getPhysicalDevice(), obj._vkFormat, &obj._vkFormatProperties);
 
 		// if memory is manually managed on host
 		if (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
 			vmaMapMemory(_backend.getAllocator(), obj._vmaAllocation, &obj._mappedPtr);
 		}
-		// create image views
-		const VkImageAspectFlags aspectMask = vkutil::AspectMaskFromFormat(obj._vkFormat);
+		_createImageViews(obj, imageViewtype);
+		return obj;
+	}
+	void GX::_createImageViews(AllocatedImage& image, VkImageViewType viewType) const {
+		const VkImageAspectFlags aspectMask = vkutil::AspectMaskFromFormat(image._vkFormat);
 		const VkImageViewCreateInfo image_view_ci = {
 				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 				.pNext = nullptr,
-				.image = obj._vkImage,
-				.viewType = imageViewtype,
-				.format = format,
+				.image = image._vkImage,
+				.viewType = viewType,
+				.format = image._vkFormat,
 				.subresourceRange = {
 						.aspectMask = aspectMask,
 						.baseMipLevel = 0,
 						.levelCount = VK_REMAINING_MIP_LEVELS,
 						.baseArrayLayer = 0,
-						.layerCount = numLayers
+						.layerCount = image._numLayers
 				}
 		};
-		VK_CHECK(vkCreateImageView(_backend.getDevice(), &image_view_ci, nullptr, &obj._vkImageView));
-		if (obj._vkUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) {
-			VK_CHECK(vkCreateImageView(_backend.getDevice(), &image_view_ci, nullptr, &obj._vkImageViewStorage));
+		VK_CHECK(vkCreateImageView(_backend.getDevice(), &image_view_ci, nullptr, &image._vkImageView));
+		if (image._vkUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) {
+			VK_CHECK(vkCreateImageView(_backend.getDevice(), &image_view_ci, nullptr, &image._vkImageViewStorage));
 		}
-		return obj;
+	}
+	bool GX::_supportsLazilyAllocatedMemory() const {
+		const VkPhysicalDeviceMemoryProperties* properties = nullptr;
+		vmaGetMemoryProperties(_backend.getAllocator(), &properties);
+		for (uint32_t i = 0; i < properties->memoryTypeCount; i++) {
+			if (properties->memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+				return true;
+			}
+		}
+		return false;
 	}
 
 	InternalSamplerHandle GX::createSampler(SamplerSpec spec) {
+		const uint64_t key = SamplerCacheKey(spec);
+		if (auto it = _samplerLookup.find(key); it != _samplerLookup.end()) {
+			_samplerPool.get(it->second)->_refCount++;
+			_stateCacheStats.samplerHits++;
+			return it->second;
+		}
+		_stateCacheStats.samplerMisses++;
+
 		VkFilter minfilter = toVulkan(spec.minFilter);
 		VkFilter magfilter = toVulkan(spec.magFilter);
 		VkSamplerAddressMode addressU = toVulkan(spec.wrapU);
@@ -697,8 +925,10 @@ namespace Slate {
 		AllocatedSampler obj = {};
 		vkCreateSampler(_backend.getDevice(), &info, nullptr, &obj._vkSampler);
 		snprintf(obj.debugName, sizeof(obj.debugName) - 1, "%s", spec.debugName);
+		obj._cacheKey = key;
 		InternalSamplerHandle handle = _samplerPool.create(std::move(obj));
-		_awaitingCreation = true;
+		_samplerLookup.emplace(key, handle);
+		_samplerSlots.markDirty(handle.index());
 		return {handle};
 	}
 	void GX::destroy(InternalBufferHandle handle) {
@@ -721,32 +951,67 @@ namespace Slate {
 		if (!image) {
 			return;
 		}
-		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), imageView = image->_vkImageView]() {
+		_retireImage(*image);
+		// in flight work may still sample the slot, it is not handed out again before that retires
+		_texturePool.retire(handle);
+		_textureSlots.markFreed(handle.index(), _imm->getNextSubmitHandle());
+	}
+	void GX::_retireImage(const AllocatedImage& image) {
+		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), imageView = image._vkImageView]() {
 			vkDestroyImageView(device, imageView, nullptr);
 		}));
-		if (image->_vkImageViewStorage) {
-			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), imageView = image->_vkImageViewStorage]() {
+		if (image._vkImageViewStorage) {
+			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), imageView = image._vkImageViewStorage]() {
 				vkDestroyImageView(device, imageView, nullptr);
 			}));
 		}
 		// necessary for swapchain imges which swapchain is created from
-		if (!image->_isOwning) {
-			_texturePool.destroy(handle);
-			_awaitingCreation = true;
+		if (!image._isOwning) {
 			return;
 		}
-		if (image->_mappedPtr) {
-			vmaUnmapMemory(_backend.getAllocator(), image->_vmaAllocation);
+		if (image._mappedPtr) {
+			vmaUnmapMemory(_backend.getAllocator(), image._vmaAllocation);
+		}
+		if (image._isLazilyAllocated) {
+			_transientMemoryStats.lazilyAllocatedBytes -= getImageMemoryRequirements(image._vkImage).size;
+		}
+		if (image._aliasGroup) {
+			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), image = image._vkImage]() {
+				vkDestroyImage(device, image, nullptr);
+			}));
+			// the last texture of a group frees the memory
+			AliasedMemory& memory = _aliasedMemory.at(image._vmaAllocation);
+			_transientMemoryStats.numAliasedTextures--;
+			if (--memory.numTextures > 0) {
+				return;
+			}
+			_transientMemoryStats.aliasedRequestedBytes -= memory.requestedSize;
+			_transientMemoryStats.aliasedCommittedBytes -= memory.size;
+			_transientMemoryStats.numAliasGroups--;
+			_aliasedMemory.erase(image._vmaAllocation);
+			deferredTask(std::packaged_task<void()>([vma = _backend.getAllocator(), allocation = image._vmaAllocation]() {
+				vmaFreeMemory(vma, allocation);
+			}));
+			return;
 		}
-		deferredTask(std::packaged_task<void()>([vma = _backend.getAllocator(), image = image->_vkImage, allocation = image->_vmaAllocation]() {
+		deferredTask(std::packaged_task<void()>([vma = _backend.getAllocator(), image = image._vkImage, allocation = image._vmaAllocation]() {
 			vmaDestroyImage(vma, image, allocation);
 		}));
-		_texturePool.destroy(handle);
-		_awaitingCreation = true;
 	}
 	void GX::destroy(InternalSamplerHandle handle) {
-		AllocatedSampler sampler = *_samplerPool.get(handle);
-		_samplerPool.destroy(handle);
+		AllocatedSampler* cached = _samplerPool.get(handle);
+		if (!cached) {
+			return;
+		}
+		if (--cached->_refCount > 0) {
+			return;
+		}
+		if (auto it = _samplerLookup.find(cached->_cacheKey); it != _samplerLookup.end() && it->second.index() == handle.index()) {
+			_samplerLookup.erase(it);
+		}
+		AllocatedSampler sampler = *cached;
+		_samplerPool.retire(handle);
+		_samplerSlots.markFreed(handle.index(), _imm->getNextSubmitHandle());
 		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), sampler = sampler._vkSampler]() {
 			vkDestroySampler(device, sampler, nullptr);
 		}));
@@ -756,38 +1021,226 @@ namespace Slate {
 		vkDestroyShaderModule(_backend.getDevice(), module, nullptr);
 		_shaderPool.destroy(handle);
 	}
+	// centered on the bounding box, not the tightest sphere but good enough to cull with
+	static glm::vec4 ComputeBoundingSphere(const std::vector<Vertex>& vertices) {
+		glm::vec3 min = vertices[0].position;
+		glm::vec3 max = vertices[0].position;
+		for (const Vertex& vertex : vertices) {
+			min = glm::min(min, vertex.position);
+			max = glm::max(max, vertex.position);
+		}
+		const glm::vec3 center = (min + max) * 0.5f;
+		float radiusSq = 0.f;
+		for (const Vertex& vertex : vertices) {
+			const glm::vec3 offset = vertex.position - center;
+			radiusSq = std::max(radiusSq, glm::dot(offset, offset));
+		}
+		return { center, std::sqrt(radiusSq) };
+	}
 	MeshData GX::createMesh(const std::vector<Vertex>& vertices) {
-		InternalBufferHandle vertexHandle = this->createBuffer({
-				.size = sizeof(Vertex) * vertices.size(),
-				.usage = BufferUsageBits::BufferUsageBits_Storage,
-				.storage = StorageType::Device,
-				.data = vertices.data(),
-		});
+		ASSERT_MSG(!vertices.empty(), "Cannot create a mesh without vertices!");
+		GeometryAllocation alloc = _allocateGeometry((uint32_t)vertices.size(), 0);
+		alloc.bounds = ComputeBoundingSphere(vertices);
+		upload(_geometryVertexBuffer, vertices.data(), sizeof(Vertex) * vertices.size(), sizeof(Vertex) * alloc.vertexOffset);
+
 		MeshData mesh = {};
-		mesh._vertexBuffer = vertexHandle;
+		mesh._geometry = _geometryPool.create(GeometryAllocation(alloc));
 		mesh._vertexCount = vertices.size();
 		return mesh;
 	}
 
 	MeshData GX::createMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
-		InternalBufferHandle vertexHandle = this->createBuffer({
-				.size = sizeof(Vertex) * vertices.size(),
+		ASSERT_MSG(!vertices.empty(), "Cannot create a mesh without vertices!");
+		GeometryAllocation alloc = _allocateGeometry((uint32_t)vertices.size(), (uint32_t)indices.size());
+		alloc.bounds = ComputeBoundingSphere(vertices);
+		upload(_geometryVertexBuffer, vertices.data(), sizeof(Vertex) * vertices.size(), sizeof(Vertex) * alloc.vertexOffset);
+		if (!indices.empty()) {
+			upload(_geometryIndexBuffer, indices.data(), sizeof(uint32_t) * indices.size(), sizeof(uint32_t) * alloc.firstIndex);
+		}
+
+		MeshData mesh = {};
+		mesh._geometry = _geometryPool.create(GeometryAllocation(alloc));
+		mesh._vertexCount = vertices.size();
+		mesh._indexCount = indices.size();
+		return mesh;
+	}
+	void GX::destroy(const MeshData& mesh) {
+		const GeometryAllocation* alloc = _geometryPool.get(mesh._geometry);
+		if (!alloc) {
+			return;
+		}
+		// in-flight frames may still draw from these ranges, only hand them back once that work is done
+		deferredTask(std::packaged_task<void()>([this, alloc = *alloc, generation = _geometryArenaGeneration]() {
+			// a rebuild since then already dropped this range
+			if (generation != _geometryArenaGeneration) {
+				return;
+			}
+			_geometryVertexAllocator.free(alloc.vertexOffset, alloc.vertexCount);
+			_geometryIndexAllocator.free(alloc.firstIndex, alloc.indexCount);
+		}));
+		_geometryPool.destroy(mesh._geometry);
+	}
+	VkDeviceAddress GX::meshVertexAddress(const MeshData& mesh) {
+		const GeometryAllocation* alloc = _geometryPool.get(mesh._geometry);
+		ASSERT_MSG(alloc, "Mesh does not live in the geometry arena!");
+		return gpuAddress(_geometryVertexBuffer, sizeof(Vertex) * alloc->vertexOffset);
+	}
+	void GX::defragmentGeometry() {
+		_rebuildGeometryArena(_geometryVertexAllocator.getCapacity(), _geometryIndexAllocator.getCapacity());
+	}
+	GeometryArenaStats GX::getGeometryArenaStats() const {
+		return {
+				.vertexCapacity = _geometryVertexAllocator.getCapacity(),
+				.verticesUsed = _geometryVertexAllocator.getUsed(),
+				.indexCapacity = _geometryIndexAllocator.getCapacity(),
+				.indicesUsed = _geometryIndexAllocator.getUsed(),
+				.numFreeRanges = _geometryVertexAllocator.getNumFreeRanges() + _geometryIndexAllocator.getNumFreeRanges(),
+				.numRebuilds = _numGeometryRebuilds,
+		};
+	}
+	DeviceMemoryStats GX::getDeviceMemoryStats() const {
+		const VkPhysicalDeviceMemoryProperties* properties = nullptr;
+		vmaGetMemoryProperties(_backend.getAllocator(), &properties);
+		std::vector<VmaBudget> budgets(properties->memoryHeapCount);
+		vmaGetHeapBudgets(_backend.getAllocator(), budgets.data());
+
+		DeviceMemoryStats stats = {};
+		for (const VmaBudget& budget : budgets) {
+			stats.allocatedBytes += budget.statistics.allocationBytes;
+			stats.blockBytes += budget.statistics.blockBytes;
+			stats.usageBytes += budget.usage;
+			stats.budgetBytes += budget.budget;
+			stats.numAllocations += budget.statistics.allocationCount;
+			stats.numBlocks += budget.statistics.blockCount;
+		}
+		return stats;
+	}
+	void GX::_createGeometryArena(uint32_t vertexCapacity, uint32_t indexCapacity) {
+		_geometryVertexBuffer = this->createBuffer({
+				.size = sizeof(Vertex) * vertexCapacity,
 				.usage = BufferUsageBits::BufferUsageBits_Storage,
 				.storage = StorageType::Device,
-				.data = vertices.data()
+				.debugName = "Geometry Vertex Arena"
 		});
-		InternalBufferHandle indexHandle = this->createBuffer({
-				.size = sizeof(uint32_t) * indices.size(),
+		_geometryIndexBuffer = this->createBuffer({
+				.size = sizeof(uint32_t) * indexCapacity,
 				.usage = BufferUsageBits::BufferUsageBits_Index,
 				.storage = StorageType::Device,
-				.data = indices.data()
+				.debugName = "Geometry Index Arena"
 		});
-		MeshData mesh = {};
-		mesh._vertexBuffer = vertexHandle;
-		mesh._vertexCount = vertices.size();
-		mesh._indexBuffer = indexHandle;
-		mesh._indexCount = indices.size();
-		return mesh;
+		_geometryVertexAllocator.reset(vertexCapacity);
+		_geometryIndexAllocator.reset(indexCapacity);
+	}
+	GeometryAllocation GX::_allocateGeometry(uint32_t vertexCount, uint32_t indexCount) {
+		uint32_t vertexOffset = _geometryVertexAllocator.allocate(vertexCount);
+		uint32_t firstIndex = indexCount ? _geometryIndexAllocator.allocate(indexCount) : 0;
+		if (vertexOffset == OffsetAllocator::kInvalidOffset || firstIndex == OffsetAllocator::kInvalidOffset) {
+			if (vertexOffset != OffsetAllocator::kInvalidOffset) {
+				_geometryVertexAllocator.free(vertexOffset, vertexCount);
+			}
+			if (indexCount && firstIndex != OffsetAllocator::kInvalidOffset) {
+				_geometryIndexAllocator.free(firstIndex, indexCount);
+			}
+			// rebuilding packs everything to the front, so if the arena was only fragmented the capacity stays the same
+			uint32_t newVertexCapacity = _geometryVertexAllocator.getCapacity();
+			while (newVertexCapacity - _geometryVertexAllocator.getUsed() < vertexCount) {
+				newVertexCapacity *= 2;
+			}
+			uint32_t newIndexCapacity = _geometryIndexAllocator.getCapacity();
+			while (newIndexCapacity - _geometryIndexAllocator.getUsed() < indexCount) {
+				newIndexCapacity *= 2;
+			}
+			_rebuildGeometryArena(newVertexCapacity, newIndexCapacity);
+
+			vertexOffset = _geometryVertexAllocator.allocate(vertexCount);
+			firstIndex = indexCount ? _geometryIndexAllocator.allocate(indexCount) : 0;
+			ASSERT_MSG(vertexOffset != OffsetAllocator::kInvalidOffset && firstIndex != OffsetAllocator::kInvalidOffset, "Geometry arena allocation failed after rebuilding!");
+		}
+		return {
+				.vertexOffset = vertexOffset,
+				.vertexCount = vertexCount,
+				.firstIndex = firstIndex,
+				.indexCount = indexCount,
+		};
+	}
+	void GX::_rebuildGeometryArena(uint32_t vertexCapacity, uint32_t indexCapacity) {
+		AllocatedBuffer* vertexArena = _bufferPool.get(_geometryVertexBuffer);
+		AllocatedBuffer* indexArena = _bufferPool.get(_geometryIndexBuffer);
+		ASSERT(vertexArena && indexArena);
+
+		AllocatedBuffer newVertexArena = createBufferImpl(sizeof(Vertex) * vertexCapacity, vertexArena->_vkUsageFlags, vertexArena->_vkMemoryPropertyFlags);
+		AllocatedBuffer newIndexArena = createBufferImpl(sizeof(uint32_t) * indexCapacity, indexArena->_vkUsageFlags, indexArena->_vkMemoryPropertyFlags);
+		snprintf(newVertexArena._debugName, sizeof(newVertexArena._debugName) - 1, "%s", vertexArena->_debugName);
+		snprintf(newIndexArena._debugName, sizeof(newIndexArena._debugName) - 1, "%s", indexArena->_debugName);
+
+		// repack every live mesh, a fresh allocator hands out ranges back to back
+		_geometryVertexAllocator.reset(vertexCapacity);
+		_geometryIndexAllocator.reset(indexCapacity);
+		std::vector<VkBufferCopy> vertexCopies;
+		std::vector<VkBufferCopy> indexCopies;
+		for (auto& entry : _geometryPool._objects) {
+			GeometryAllocation& alloc = entry._obj;
+			// destroyed slots are reset to an empty allocation
+			if (alloc.vertexCount == 0) {
+				continue;
+			}
+			const uint32_t vertexOffset = _geometryVertexAllocator.allocate(alloc.vertexCount);
+			ASSERT_MSG(vertexOffset != OffsetAllocator::kInvalidOffset, "Geometry arena too small to hold its own meshes!");
+			vertexCopies.push_back({
+					.srcOffset = sizeof(Vertex) * alloc.vertexOffset,
+					.dstOffset = sizeof(Vertex) * vertexOffset,
+					.size = sizeof(Vertex) * alloc.vertexCount,
+			});
+			alloc.vertexOffset = vertexOffset;
+
+			if (alloc.indexCount) {
+				const uint32_t firstIndex = _geometryIndexAllocator.allocate(alloc.indexCount);
+				ASSERT_MSG(firstIndex != OffsetAllocator::kInvalidOffset, "Geometry arena too small to hold its own meshes!");
+				indexCopies.push_back({
+						.srcOffset = sizeof(uint32_t) * alloc.firstIndex,
+						.dstOffset = sizeof(uint32_t) * firstIndex,
+						.size = sizeof(uint32_t) * alloc.indexCount,
+				});
+				alloc.firstIndex = firstIndex;
+			}
+		}
+
+		// taken before acquiring our own command buffer, it is the frame being recorded (or the last one submitted)
+		// submits are chained, so once it completes nothing can reference the old arena anymore
+		const SubmitHandle lastArenaUse = _imm->getNextSubmitHandle();
+		const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _imm->acquire();
+		// uploads into the old arena were submitted earlier and have to land before we copy out of it
+		VkMemoryBarrier barrier = {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+				.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+		};
+		vkCmdPipelineBarrier(wrapper._cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VkDependencyFlags{}, 1, &barrier, 0, nullptr, 0, nullptr);
+		if (!vertexCopies.empty()) {
+			vkCmdCopyBuffer(wrapper._cmdBuf, vertexArena->_vkBuffer, newVertexArena._vkBuffer, (uint32_t)vertexCopies.size(), vertexCopies.data());
+		}
+		if (!indexCopies.empty()) {
+			vkCmdCopyBuffer(wrapper._cmdBuf, indexArena->_vkBuffer, newIndexArena._vkBuffer, (uint32_t)indexCopies.size(), indexCopies.data());
+		}
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+		vkCmdPipelineBarrier(wrapper._cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkDependencyFlags{}, 1, &barrier, 0, nullptr, 0, nullptr);
+		// the barrier above only covers this queue, uploads on the transfer queue may still be writing the old arena
+		_staging->orderAfterUploads(*_imm);
+		_imm->wait(_imm->submit(wrapper));
+
+		// swap the buffers in place so the arena handles stay valid, the old ones may still be bound by in-flight frames
+		deferredTask(std::packaged_task<void()>([vma = _backend.getAllocator(), buffer = vertexArena->_vkBuffer, allocation = vertexArena->_vmaAllocation]() {
+			vmaDestroyBuffer(vma, buffer, allocation);
+		}), lastArenaUse);
+		deferredTask(std::packaged_task<void()>([vma = _backend.getAllocator(), buffer = indexArena->_vkBuffer, allocation = indexArena->_vmaAllocation]() {
+			vmaDestroyBuffer(vma, buffer, allocation);
+		}), lastArenaUse);
+		*vertexArena = newVertexArena;
+		*indexArena = newIndexArena;
+
+		_geometryArenaGeneration++;
+		_numGeometryRebuilds++;
+		LOG_USER(LogType::Info, "Rebuilt geometry arena: {} / {} vertices, {} / {} indices", _geometryVertexAllocator.getUsed(), vertexCapacity, _geometryIndexAllocator.getUsed(), indexCapacity);
 	}
 
 	InternalShaderHandle GX::createShader(ShaderSpec spec) {
@@ -803,10 +1256,38 @@ namespace Slate {
 		shader.pushConstantSize = spec.pushConstantSize;
 		return _shaderPool.create(std::move(shader));
 	}
+	// gathers the dirty slots that are safe to rewrite, anything still read by in-flight work stays dirty for a later frame
+	// freed slots are written back to the dummy and handed out in outFreedSlots, their pool may reuse them from then on
+	static void ConsumeDirtySlots(DescriptorSlotTracker& tracker, uint32_t numSlots, const VulkanImmediateCommands& imm, std::vector<uint32_t>& outSlots, std::vector<uint32_t>& outFreedSlots) {
+		std::sort(tracker.dirty.begin(), tracker.dirty.end());
+		tracker.dirty.erase(std::unique(tracker.dirty.begin(), tracker.dirty.end()), tracker.dirty.end());
+
+		uint32_t numKept = 0;
+		for (uint32_t slot : tracker.dirty) {
+			if (slot >= numSlots) {
+				continue;
+			}
+			if (slot < tracker.retireHandles.size() && !tracker.retireHandles[slot].empty()) {
+				if (!imm.isReady(tracker.retireHandles[slot])) {
+					tracker.dirty[numKept++] = slot;
+					continue;
+				}
+				tracker.retireHandles[slot] = {};
+			}
+			if (slot < tracker.isFreed.size() && tracker.isFreed[slot]) {
+				tracker.isFreed[slot] = false;
+				outFreedSlots.push_back(slot);
+			}
+			outSlots.push_back(slot);
+		}
+		tracker.dirty.resize(numKept);
+	}
 	void GX::checkAndUpdateDescriptorSets() {
-		if (!_awaitingCreation) {
+		if (_textureSlots.dirty.empty() && _samplerSlots.dirty.empty() && !_awaitingNewImmutableSamplers) {
 			return;
 		}
+		const Clock::time_point start = Clock::now();
+
 		uint32_t newMaxTextures = _currentMaxTextureCount;
 		uint32_t newMaxSamplers = _currentMaxSamplerCount;
 
@@ -817,100 +1298,104 @@ namespace Slate {
 			newMaxSamplers *= 2;
 		}
 		if (newMaxTextures != _currentMaxTextureCount || newMaxSamplers != _currentMaxSamplerCount || _awaitingNewImmutableSamplers) {
+			if (_isBindlessPreallocated && !_awaitingNewImmutableSamplers) {
+				LOG_USER(LogType::Warning, "Preallocated bindless capacity exceeded ({} textures, {} samplers), growing will rebuild every pipeline!", _texturePool._objects.size(), _samplerPool._objects.size());
+			}
 			growDescriptorPool(newMaxTextures, newMaxSamplers);
 		}
 
+		std::vector<uint32_t> textureSlots;
+		std::vector<uint32_t> samplerSlots;
+		std::vector<uint32_t> freedTextureSlots;
+		std::vector<uint32_t> freedSamplerSlots;
+		ConsumeDirtySlots(_textureSlots, (uint32_t)_texturePool._objects.size(), *_imm, textureSlots, freedTextureSlots);
+		ConsumeDirtySlots(_samplerSlots, (uint32_t)_samplerPool._objects.size(), *_imm, samplerSlots, freedSamplerSlots);
+		if (textureSlots.empty() && samplerSlots.empty()) {
+			return;
+		}
+
+		// writes point into infos, so it must never reallocate while we fill it
+		std::vector<VkDescriptorImageInfo> infos;
+		std::vector<VkWriteDescriptorSet> writes;
+		infos.reserve(textureSlots.size() * 2 + samplerSlots.size());
+		writes.reserve(textureSlots.size() * 2 + samplerSlots.size());
+
 		// IMAGES //
-		std::vector<VkDescriptorImageInfo> infoSampledImages;
-		std::vector<VkDescriptorImageInfo> infoStorageImages;
-		uint32_t numObjects = _texturePool.numObjects();
-		infoSampledImages.reserve(numObjects);
-		infoStorageImages.reserve(numObjects);
-
-		VkImageView dummyImageView = _texturePool._objects[0]._obj._vkImageView;
-
-		for (const auto& obj : _texturePool._objects) {
-			const AllocatedImage& img = obj._obj;
-			VkImageView view = obj._obj._vkImageView;
-			VkImageView storageView = obj._obj._vkImageViewStorage ? obj._obj._vkImageViewStorage : view;
+		const VkImageView dummyImageView = _texturePool.get(_dummyTextureHandle)->_vkImageView;
+		for (uint32_t slot : textureSlots) {
+			const AllocatedImage& img = _texturePool._objects[slot]._obj;
+			// destroyed slots point back at the dummy so nothing dangles once the old view is freed
+			const bool isAlive = img._vkImageView != VK_NULL_HANDLE;
 			// multisampled images cannot be directly accessed from shaders
-			const bool isTextureAvailable = (img.getSampleCount() & VK_SAMPLE_COUNT_1_BIT) == VK_SAMPLE_COUNT_1_BIT;
+			const bool isTextureAvailable = isAlive && (img.getSampleCount() & VK_SAMPLE_COUNT_1_BIT) == VK_SAMPLE_COUNT_1_BIT;
 			const bool isSampledImage = isTextureAvailable && img.isSampledImage();
 			const bool isStorageImage = isTextureAvailable && img.isStorageImage();
-			infoSampledImages.push_back(VkDescriptorImageInfo{
+			const VkImageView storageView = img._vkImageViewStorage ? img._vkImageViewStorage : img._vkImageView;
+
+			infos.push_back(VkDescriptorImageInfo{
 					.sampler = VK_NULL_HANDLE,
-					.imageView = isSampledImage ? view : dummyImageView,
+					.imageView = isSampledImage ? img._vkImageView : dummyImageView,
 					.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 			});
-			LOG_USER(LogType::Info, "{} - {}", img._debugName, _texturePool.findObject(&obj._obj).index());
-			ASSERT_MSG(infoSampledImages.back().imageView != VK_NULL_HANDLE, "Sampled imageView is null!");
-			infoStorageImages.push_back(VkDescriptorImageInfo{
+			writes.push_back(VkWriteDescriptorSet{
+					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+					.dstSet = _vkDSet,
+					.dstBinding = kTextureBinding,
+					.dstArrayElement = slot,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+					.pImageInfo = &infos.back(),
+			});
+			infos.push_back(VkDescriptorImageInfo{
 					.sampler = VK_NULL_HANDLE,
 					.imageView = isStorageImage ? storageView : dummyImageView,
 					.imageLayout = VK_IMAGE_LAYOUT_GENERAL,
 			});
+			writes.push_back(VkWriteDescriptorSet{
+					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+					.dstSet = _vkDSet,
+					.dstBinding = kStorageImageBinding,
+					.dstArrayElement = slot,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+					.pImageInfo = &infos.back(),
+			});
 		}
 
 		// SAMPLERS //
-		std::vector<VkDescriptorImageInfo> infoSamplers;
-		infoSamplers.reserve(_samplerPool._objects.size());
-
-		VkSampler linearSampler = _samplerPool._objects[0]._obj._vkSampler;
-
-		for (const auto& obj : _samplerPool._objects) {
-			infoSamplers.push_back({
-					.sampler = obj._obj._vkSampler ? obj._obj._vkSampler : linearSampler,
+		const VkSampler linearSampler = _samplerPool.get(_linearSamplerHandle)->_vkSampler;
+		for (uint32_t slot : samplerSlots) {
+			const VkSampler sampler = _samplerPool._objects[slot]._obj._vkSampler;
+			infos.push_back(VkDescriptorImageInfo{
+					.sampler = sampler ? sampler : linearSampler,
 					.imageView = VK_NULL_HANDLE,
 					.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 			});
-		}
-
-		// now write to descriptor set //
-		VkWriteDescriptorSet write[kNumBindlessBindings] = {};
-		uint32_t numWrites = 0;
-
-		if (!infoSampledImages.empty()) {
-			write[numWrites++] = VkWriteDescriptorSet{
-					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-					.dstSet = _vkDSet,
-					.dstBinding = kTextureBinding,
-					.dstArrayElement = 0,
-					.descriptorCount = (uint32_t)infoSampledImages.size(),
-					.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-					.pImageInfo = infoSampledImages.data(),
-			};
-		}
-
-		if (!infoSamplers.empty()) {
-			write[numWrites++] = VkWriteDescriptorSet{
+			writes.push_back(VkWriteDescriptorSet{
 					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 					.dstSet = _vkDSet,
 					.dstBinding = kSamplerBinding,
-					.dstArrayElement = 0,
-					.descriptorCount = (uint32_t)infoSamplers.size(),
+					.dstArrayElement = slot,
+					.descriptorCount = 1,
 					.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
-					.pImageInfo = infoSamplers.data(),
-			};
-		}
-
-		if (!infoStorageImages.empty()) {
-			write[numWrites++] = VkWriteDescriptorSet{
-					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-					.dstSet = _vkDSet,
-					.dstBinding = kStorageImageBinding,
-					.dstArrayElement = 0,
-					.descriptorCount = (uint32_t)infoStorageImages.size(),
-					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-					.pImageInfo = infoStorageImages.data(),
-			};
+					.pImageInfo = &infos.back(),
+			});
 		}
 
 		// update descriptor set
-		if (numWrites) {
-			_imm->wait(_imm->getLastSubmitHandle());
-			vkUpdateDescriptorSets(_backend.getDevice(), numWrites, write, 0, nullptr);
+		// no queue wait, the bindings are UPDATE_AFTER_BIND | UPDATE_UNUSED_WHILE_PENDING and we only touch slots nothing in flight reads
+		vkUpdateDescriptorSets(_backend.getDevice(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+		// the dummy is in place, whatever gets these slots next writes its descriptor on the following update
+		for (uint32_t slot : freedTextureSlots) {
+			_texturePool.release(slot);
+		}
+		for (uint32_t slot : freedSamplerSlots) {
+			_samplerPool.release(slot);
 		}
-		_awaitingCreation = false;
+
+		_descriptorUpdateStats.numUpdates++;
+		_descriptorUpdateStats.numSlotsWritten = (uint32_t)(textureSlots.size() + samplerSlots.size());
+		_descriptorUpdateStats.lastUpdateMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
 	}
 
 	void GX::growDescriptorPool(uint32_t newMaxTextureCount, uint16_t newMaxSamplerCount) {
@@ -918,13 +1403,16 @@ namespace Slate {
 		_currentMaxTextureCount = newMaxTextureCount;
 		_currentMaxSamplerCount = newMaxSamplerCount;
 
-		const uint32_t MAX_TEXTURE_LIMIT = _backend.getPhysDevicePropertiesV12().maxDescriptorSetUpdateAfterBindSampledImages;
-		ASSERT_MSG(newMaxTextureCount <= MAX_TEXTURE_LIMIT, "Max sampled textures exceeded: {}, but maximum of {} is allowed!", newMaxTextureCount, MAX_TEXTURE_LIMIT);
+		// every texture also takes a storage image slot
+		const uint32_t MAX_STORAGE_IMAGE_LIMIT = std::min(_backend.getPhysDevicePropertiesV12().maxDescriptorSetUpdateAfterBindStorageImages,
+														  _backend.getPhysDevicePropertiesV12().maxPerStageDescriptorUpdateAfterBindStorageImages) / kNumBindlessSets;
+		ASSERT_MSG(newMaxTextureCount <= MAX_STORAGE_IMAGE_LIMIT, "Max storage images exceeded: {}, but maximum of {} is allowed!", newMaxTextureCount, MAX_STORAGE_IMAGE_LIMIT);
 
 		const uint32_t MAX_SAMPLER_LIMIT = _backend.getPhysDevicePropertiesV12().maxDescriptorSetUpdateAfterBindSamplers;
 		ASSERT_MSG(newMaxSamplerCount <= MAX_SAMPLER_LIMIT, "Max samplers exceeded: {}, but maximum of {} is allowed!", newMaxSamplerCount, MAX_SAMPLER_LIMIT);
 
 		if (_vkDSL != VK_NULL_HANDLE) {
+			_retirePipelineLayouts(_vkDSL);
 			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), dsl = _vkDSL]() {
 				vkDestroyDescriptorSetLayout(device, dsl, nullptr);
 			}));
@@ -935,17 +1423,24 @@ namespace Slate {
 			}));
 		}
 
-		VkShaderStageFlags stage_flags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		// the texture binding is the variable count one, the layout declares the most the device allows next to
+		// the fixed bindings and the set is allocated with what is actually used
+		const VkPhysicalDeviceVulkan12Properties props12 = _backend.getPhysDevicePropertiesV12();
+		const uint32_t maxTextures = MaxBindlessTextures(props12, newMaxSamplerCount, newMaxTextureCount);
+		ASSERT_MSG(newMaxTextureCount <= maxTextures, "Max sampled textures exceeded: {}, but maximum of {} is allowed next to the samplers and storage images!", newMaxTextureCount, maxTextures);
+
+		VkShaderStageFlags stage_flags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 		const VkDescriptorSetLayoutBinding bindings[kNumBindlessBindings] = {
-				VkDescriptorSetLayoutBinding(kTextureBinding, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, newMaxTextureCount, stage_flags),
-				VkDescriptorSetLayoutBinding(kSamplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER, newMaxSamplerCount, stage_flags),
 				VkDescriptorSetLayoutBinding(kStorageImageBinding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, newMaxTextureCount, stage_flags),
+				VkDescriptorSetLayoutBinding(kSamplerBinding, VK_DESCRIPTOR_TYPE_SAMPLER, newMaxSamplerCount, stage_flags),
+				VkDescriptorSetLayoutBinding(kTextureBinding, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxTextures, stage_flags),
 		};
 		const uint32_t flags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
 		VkDescriptorBindingFlags bindingFlags[kNumBindlessBindings];
 		for (uint32_t& bindingFlag : bindingFlags) {
 			bindingFlag = flags;
 		}
+		bindingFlags[kTextureBinding] |= VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
 		const VkDescriptorSetLayoutBindingFlagsCreateInfo dsl_bf_ci = {
 				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
 				.bindingCount = (uint32_t) kNumBindlessBindings,
@@ -962,9 +1457,9 @@ namespace Slate {
 
 		{
 			const VkDescriptorPoolSize poolSizes[kNumBindlessBindings]{
-					VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, newMaxTextureCount},
-					VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, newMaxSamplerCount},
 					VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, newMaxTextureCount},
+					VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER, newMaxSamplerCount},
+					VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, newMaxTextureCount},
 			};
 			const VkDescriptorPoolCreateInfo dp_ci = {
 					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
@@ -974,8 +1469,14 @@ namespace Slate {
 					.pPoolSizes = poolSizes,
 			};
 			VK_CHECK(vkCreateDescriptorPool(_backend.getDevice(), &dp_ci, nullptr, &_vkDPool));
+			const VkDescriptorSetVariableDescriptorCountAllocateInfo ds_vdc_ai = {
+					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+					.descriptorSetCount = 1,
+					.pDescriptorCounts = &newMaxTextureCount,
+			};
 			const VkDescriptorSetAllocateInfo ds_ai = {
 					.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+					.pNext = &ds_vdc_ai,
 					.descriptorPool = _vkDPool,
 					.descriptorSetCount = 1,
 					.pSetLayouts = &_vkDSL,
@@ -983,12 +1484,35 @@ namespace Slate {
 			VK_CHECK(vkAllocateDescriptorSets(_backend.getDevice(), &ds_ai, &_vkDSet));
 		}
 		_awaitingNewImmutableSamplers = false;
+		// a brand new set has nothing in it and nothing in flight reading it, so every slot gets written right away
+		// freed slots keep their flag and go back to the pool with that first update
+		std::fill(_textureSlots.retireHandles.begin(), _textureSlots.retireHandles.end(), SubmitHandle());
+		std::fill(_samplerSlots.retireHandles.begin(), _samplerSlots.retireHandles.end(), SubmitHandle());
+		_textureSlots.markAll((uint32_t)_texturePool._objects.size());
+		_samplerSlots.markAll((uint32_t)_samplerPool._objects.size());
 	}
 
 	InternalPipelineHandle GX::createPipeline(PipelineSpec spec) {
+		const size_t specHash = HashPipelineSpec(spec);
+		if (auto it = _pipelineLookup.find(specHash); it != _pipelineLookup.end()) {
+			RenderPipeline* existing = _pipelinePool.get(it->second);
+			if (existing && IsSamePipelineSpec(existing->_spec, spec)) {
+				existing->_refCount++;
+				_stateCacheStats.pipelineHits++;
+				return it->second;
+			}
+		}
+		_stateCacheStats.pipelineMisses++;
+
 		RenderPipeline pipeline = {};
 		pipeline._spec = std::move(spec);
+		pipeline._specHash = specHash;
 		InternalPipelineHandle handle = _pipelinePool.create(std::move(pipeline));
+		// on a collision the first spec keeps the slot, this one just doesnt get shared
+		_pipelineLookup.emplace(specHash, handle);
+		if (_isAsyncPipelineCompilation) {
+			_enqueuePipelineCompile(handle);
+		}
 		return {handle};
 	}
 	void GX::destroy(InternalPipelineHandle handle) {
@@ -996,14 +1520,36 @@ namespace Slate {
 		if (!rps) {
 			return;
 		}
+		if (--rps->_refCount > 0) {
+			return;
+		}
+		if (auto it = _pipelineLookup.find(rps->_specHash); it != _pipelineLookup.end() && it->second.index() == handle.index()) {
+			_pipelineLookup.erase(it);
+		}
 		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), pipeline = rps->_vkPipeline]() {
 			vkDestroyPipeline(device, pipeline, nullptr);
 		}));
-		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), layout = rps->_vkPipelineLayout]() {
-			vkDestroyPipelineLayout(device, layout, nullptr);
-		}));
+		_releasePipelineLayout(rps->_vkPipelineLayout);
 		_pipelinePool.destroy(handle);
 	}
+	InternalComputePipelineHandle GX::createComputePipeline(ComputePipelineSpec spec) {
+		ASSERT_MSG(spec.shaderhandle.valid(), "Compute pipelines need a shader!");
+		ASSERT_MSG(!spec.entryPoint.empty(), "Compute pipelines need an entry point!");
+		ComputePipeline pipeline = {};
+		pipeline._spec = std::move(spec);
+		return _computePipelinePool.create(std::move(pipeline));
+	}
+	void GX::destroy(InternalComputePipelineHandle handle) {
+		ComputePipeline* cps = _computePipelinePool.get(handle);
+		if (!cps) {
+			return;
+		}
+		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), pipeline = cps->_vkPipeline]() {
+			vkDestroyPipeline(device, pipeline, nullptr);
+		}));
+		_releasePipelineLayout(cps->_vkPipelineLayout);
+		_computePipelinePool.destroy(handle);
+	}
 	void GX::bindDefaultDescriptorSets(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) {
 		const std::array<VkDescriptorSet, 4> descriptor_sets = {  _vkDSet, _vkDSet, _vkDSet, _vkGlobalDSet };
 		vkCmdBindDescriptorSets(cmd, bindPoint, layout, 0, descriptor_sets.size(), descriptor_sets.data(), 0, nullptr);
@@ -1015,25 +1561,78 @@ namespace Slate {
 			return VK_NULL_HANDLE;
 		}
 		// updating descriptor layout //
-		if (renderPipeline->_vkLastDescriptorSetLayout != _vkDSL) {
-			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), pipeline = renderPipeline->_vkPipeline]() {
-				vkDestroyPipeline(device, pipeline, nullptr);
-			}));
-			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), layout = renderPipeline->_vkPipelineLayout]() {
-				vkDestroyPipelineLayout(device, layout, nullptr);
-			}));
-			renderPipeline->_vkPipeline = VK_NULL_HANDLE;
-			renderPipeline->_vkLastDescriptorSetLayout = _vkDSL;
-		}
+		_releaseStalePipeline(*renderPipeline);
 
 		// RETURN EXISTING PIPELINE //
 		if (renderPipeline->_vkPipeline != VK_NULL_HANDLE) {
 			return renderPipeline;
 		}
+		// or, HAND IT TO THE WORKERS //
+		if (_isAsyncPipelineCompilation) {
+			if (!renderPipeline->_isCompiling) {
+				_enqueuePipelineCompile(handle);
+			}
+			// caller decides between the fallback and skipping, _vkPipeline stays null until collected
+			return renderPipeline;
+		}
 		// or, CREATE NEW PIPELINE //
+		PipelineBuilder builder = _createPipelineBuilder(renderPipeline->_spec);
+		VkPipelineLayout piplineLayout = _acquirePipelineLayout(renderPipeline->_spec.shaderhandle, kGraphicsPushConstantStages);
 
-		PipelineSpec& spec = renderPipeline->_spec;
-
+		bool cacheHit = false;
+		renderPipeline->_vkPipeline = builder.build(_backend.getDevice(), piplineLayout, _vkPipelineCache, &cacheHit);
+		renderPipeline->_vkPipelineLayout = piplineLayout;
+		cacheHit ? _pipelineCacheStats.hits++ : _pipelineCacheStats.misses++;
+		return renderPipeline;
+	}
+	void GX::_releaseStalePipeline(RenderPipeline& renderPipeline) {
+		if (renderPipeline._vkLastDescriptorSetLayout == _vkDSL) {
+			return;
+		}
+		if (renderPipeline._vkPipeline != VK_NULL_HANDLE || renderPipeline._isCompiling) {
+			_numPipelineRebuilds++;
+		}
+		deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), pipeline = renderPipeline._vkPipeline]() {
+			vkDestroyPipeline(device, pipeline, nullptr);
+		}));
+		_releasePipelineLayout(renderPipeline._vkPipelineLayout);
+		renderPipeline._vkPipeline = VK_NULL_HANDLE;
+		renderPipeline._vkPipelineLayout = VK_NULL_HANDLE;
+		renderPipeline._vkLastDescriptorSetLayout = _vkDSL;
+	}
+	ComputePipeline* GX::resolveComputePipeline(InternalComputePipelineHandle handle) {
+		ComputePipeline* computePipeline = _computePipelinePool.get(handle);
+		if (!computePipeline) {
+			LOG_USER(LogType::Warning, "Compute pipeline does not exist, pass in a valid handle!");
+			return nullptr;
+		}
+		// same as render pipelines, a new bindless layout means a new pipeline layout
+		if (computePipeline->_vkLastDescriptorSetLayout != _vkDSL) {
+			if (computePipeline->_vkPipeline != VK_NULL_HANDLE) {
+				_numPipelineRebuilds++;
+			}
+			deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), pipeline = computePipeline->_vkPipeline]() {
+				vkDestroyPipeline(device, pipeline, nullptr);
+			}));
+			_releasePipelineLayout(computePipeline->_vkPipelineLayout);
+			computePipeline->_vkPipeline = VK_NULL_HANDLE;
+			computePipeline->_vkPipelineLayout = VK_NULL_HANDLE;
+			computePipeline->_vkLastDescriptorSetLayout = _vkDSL;
+		}
+		if (computePipeline->_vkPipeline != VK_NULL_HANDLE) {
+			return computePipeline;
+		}
+		const ShaderData* shader = _shaderPool.get(computePipeline->_spec.shaderhandle);
+		ASSERT_MSG(shader && shader->_vkModule, "Shader module not found!");
+		VkPipelineLayout piplineLayout = _acquirePipelineLayout(computePipeline->_spec.shaderhandle, VK_SHADER_STAGE_COMPUTE_BIT);
+
+		bool cacheHit = false;
+		computePipeline->_vkPipeline = BuildComputePipeline(_backend.getDevice(), shader->_vkModule, computePipeline->_spec.entryPoint.c_str(), piplineLayout, _vkPipelineCache, &cacheHit);
+		computePipeline->_vkPipelineLayout = piplineLayout;
+		cacheHit ? _pipelineCacheStats.hits++ : _pipelineCacheStats.misses++;
+		return computePipeline;
+	}
+	PipelineBuilder GX::_createPipelineBuilder(PipelineSpec& spec) const {
 		PipelineBuilder builder = {};
 		builder.set_cull_mode(spec.cull);
 		builder.set_polygon_mode(spec.polygon);
@@ -1047,15 +1646,26 @@ namespace Slate {
 		VkShaderModule module = _shaderPool.get(spec.shaderhandle)->_vkModule;
 		ASSERT_MSG(module, "Shader module not found!");
 		builder.set_module(module);
-
-		size_t pc_size = _shaderPool.get(spec.shaderhandle)->pushConstantSize;
+		return builder;
+	}
+	VkPipelineLayout GX::_acquirePipelineLayout(InternalShaderHandle shader, VkShaderStageFlags pushConstantStages) {
+		size_t pc_size = _shaderPool.get(shader)->pushConstantSize;
 		// PUSH CONSTANTS
 		// use reflection to get the size of push constant from slang
 		uint32_t pushConstantsSize = (pc_size != 0) ? pc_size : sizeof(GPU::PerObjectData); // TODO: push constant size resolving logic is horrible
+
+		const PipelineLayoutKey key = { .dsl = _vkDSL, .pushConstantSize = pushConstantsSize, .pushConstantStages = pushConstantStages };
+		if (auto it = _pipelineLayoutCache.find(key); it != _pipelineLayoutCache.end()) {
+			it->second.refCount++;
+			_stateCacheStats.layoutHits++;
+			return it->second.layout;
+		}
+		_stateCacheStats.layoutMisses++;
+
 		const VkPhysicalDeviceLimits& limits = _backend.getPhysDeviceProperties().limits;
 		ASSERT_MSG(pushConstantsSize <= limits.maxPushConstantsSize, "Push constants size exceeded {} (max {} bytes)", pushConstantsSize, limits.maxPushConstantsSize);
 		VkPushConstantRange range = {
-				.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, // push constant usable in both modules
+				.stageFlags = pushConstantStages,
 				.offset = 0,
 				.size = pushConstantsSize,
 		};
@@ -1071,10 +1681,194 @@ namespace Slate {
 		};
 		VkPipelineLayout piplineLayout = VK_NULL_HANDLE;
 		VK_CHECK(vkCreatePipelineLayout(_backend.getDevice(), &pipeline_layout_info, nullptr, &piplineLayout));
+		_pipelineLayoutCache.emplace(key, CachedPipelineLayout{ .layout = piplineLayout, .refCount = 1 });
+		return piplineLayout;
+	}
+	void GX::_releasePipelineLayout(VkPipelineLayout layout) {
+		if (layout == VK_NULL_HANDLE) {
+			return;
+		}
+		// only a handful of push constant sizes ever exist, a linear search is fine here
+		for (auto it = _pipelineLayoutCache.begin(); it != _pipelineLayoutCache.end(); ++it) {
+			if (it->second.layout != layout) {
+				continue;
+			}
+			if (--it->second.refCount == 0) {
+				deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), layout]() {
+					vkDestroyPipelineLayout(device, layout, nullptr);
+				}));
+				_pipelineLayoutCache.erase(it);
+			}
+			return;
+		}
+		for (auto it = _retiredPipelineLayouts.begin(); it != _retiredPipelineLayouts.end(); ++it) {
+			if (it->layout != layout) {
+				continue;
+			}
+			if (--it->refCount == 0) {
+				deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), layout]() {
+					vkDestroyPipelineLayout(device, layout, nullptr);
+				}));
+				_retiredPipelineLayouts.erase(it);
+			}
+			return;
+		}
+		ASSERT_MSG(false, "Releasing a pipeline layout that isnt in the layout cache!");
+	}
+	void GX::_retirePipelineLayouts(VkDescriptorSetLayout dsl) {
+		for (auto it = _pipelineLayoutCache.begin(); it != _pipelineLayoutCache.end();) {
+			if (it->first.dsl == dsl) {
+				_retiredPipelineLayouts.push_back(it->second);
+				it = _pipelineLayoutCache.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+	void GX::_enqueuePipelineCompile(InternalPipelineHandle handle) {
+		RenderPipeline* renderPipeline = _pipelinePool.get(handle);
+		ASSERT(renderPipeline);
+		// everything touching the pools happens here on the render thread, the worker only sees plain vulkan handles
+		PipelineCompileJob job = {
+				.handle = handle,
+				.builder = _createPipelineBuilder(renderPipeline->_spec),
+				.layout = _acquirePipelineLayout(renderPipeline->_spec.shaderhandle, kGraphicsPushConstantStages),
+				.dsl = _vkDSL,
+		};
+		renderPipeline->_isCompiling = true;
+		renderPipeline->_vkLastDescriptorSetLayout = _vkDSL;
+		_pipelineCompiler->enqueue(std::move(job));
+	}
+	void GX::_collectCompiledPipelines() {
+		if (!_pipelineCompiler) {
+			return;
+		}
+		std::vector<PipelineCompileResult> results;
+		_pipelineCompiler->collect(results);
+		for (const PipelineCompileResult& result : results) {
+			result.cacheHit ? _pipelineCacheStats.hits++ : _pipelineCacheStats.misses++;
+			RenderPipeline* renderPipeline = _pipelinePool.get(result.handle);
+			if (renderPipeline) {
+				renderPipeline->_isCompiling = false;
+			}
+			// the pipeline was destroyed or the bindless layout changed while compiling, throw the result away
+			if (!renderPipeline || result.dsl != _vkDSL || renderPipeline->_vkPipeline != VK_NULL_HANDLE) {
+				deferredTask(std::packaged_task<void()>([device = _backend.getDevice(), pipeline = result.pipeline]() {
+					vkDestroyPipeline(device, pipeline, nullptr);
+				}));
+				_releasePipelineLayout(result.layout);
+				continue;
+			}
+			renderPipeline->_vkPipeline = result.pipeline;
+			renderPipeline->_vkPipelineLayout = result.layout;
+			renderPipeline->_vkLastDescriptorSetLayout = result.dsl;
+		}
+	}
+	void GX::warmPipelines() {
+		// make sure the layout every pipeline gets compiled against is the final one for now
+		checkAndUpdateDescriptorSets();
+		for (uint32_t i = 0; i < _pipelinePool._objects.size(); i++) {
+			InternalPipelineHandle handle = _pipelinePool.getHandle(i);
+			RenderPipeline* renderPipeline = _pipelinePool.get(handle);
+			if (!renderPipeline || renderPipeline->_spec.shaderhandle.empty() || renderPipeline->_isCompiling) {
+				continue;
+			}
+			// a stale pipeline has to go first, the compiled result is thrown away while _vkPipeline is still set
+			_releaseStalePipeline(*renderPipeline);
+			if (renderPipeline->_vkPipeline != VK_NULL_HANDLE) {
+				continue;
+			}
+			_enqueuePipelineCompile(handle);
+		}
+		// compute pipelines are cheap enough to build right here while the workers are busy
+		for (uint32_t i = 0; i < _computePipelinePool._objects.size(); i++) {
+			const InternalComputePipelineHandle handle = _computePipelinePool.getHandle(i);
+			const ComputePipeline* computePipeline = _computePipelinePool.get(handle);
+			// destroyed slots are reset to an empty spec
+			if (!computePipeline || computePipeline->_spec.shaderhandle.empty()) {
+				continue;
+			}
+			resolveComputePipeline(handle);
+		}
+		_pipelineCompiler->waitIdle();
+		_collectCompiledPipelines();
+	}
+	uint32_t GX::getNumPendingPipelines() const {
+		return _pipelineCompiler ? _pipelineCompiler->getNumPending() : 0;
+	}
 
-		renderPipeline->_vkPipeline = builder.build(_backend.getDevice(), piplineLayout);
-		renderPipeline->_vkPipelineLayout = piplineLayout;
-		return renderPipeline;
+	void GX::_createPipelineCache(const char* path) {
+		const VkPhysicalDeviceProperties props = _backend.getPhysDeviceProperties();
+		std::vector<std::byte> blob;
+		if (path) {
+			_pipelineCachePath = path;
+			if (Filesystem::Exists(_pipelineCachePath)) {
+				blob = Filesystem::ReadBinaryFile(_pipelineCachePath);
+			}
+		}
+		// only hand the data to the driver if it was written by this exact device + driver
+		const void* initialData = nullptr;
+		size_t initialSize = 0;
+		if (blob.size() > sizeof(PipelineCacheFileHeader)) {
+			PipelineCacheFileHeader header = {};
+			memcpy(&header, blob.data(), sizeof(header));
+			const bool isValid = header.magic == kPipelineCacheMagic &&
+								 header.dataSize == blob.size() - sizeof(header) &&
+								 header.vendorID == props.vendorID &&
+								 header.deviceID == props.deviceID &&
+								 header.driverVersion == props.driverVersion &&
+								 memcmp(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+			if (isValid) {
+				initialData = blob.data() + sizeof(header);
+				initialSize = header.dataSize;
+			} else {
+				LOG_USER(LogType::Info, "Pipeline cache at '{}' is stale or from another device, starting cold", _pipelineCachePath.string());
+			}
+		}
+		const VkPipelineCacheCreateInfo pipeline_cache_ci = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+				.flags = 0,
+				.initialDataSize = initialSize,
+				.pInitialData = initialData,
+		};
+		VK_CHECK(vkCreatePipelineCache(_backend.getDevice(), &pipeline_cache_ci, nullptr, &_vkPipelineCache));
+		_pipelineCacheStats = {};
+		_pipelineCacheStats.loadedBytes = initialSize;
+	}
+	void GX::_savePipelineCache() {
+		if (_vkPipelineCache == VK_NULL_HANDLE || _pipelineCachePath.empty()) {
+			return;
+		}
+		LOG_USER(LogType::Info, "Pipeline cache: {} hits, {} misses ({} bytes loaded)", _pipelineCacheStats.hits, _pipelineCacheStats.misses, _pipelineCacheStats.loadedBytes);
+		// nothing new was compiled, the file on disk is already up to date
+		if (_pipelineCacheStats.misses == 0) {
+			return;
+		}
+		size_t dataSize = 0;
+		VK_CHECK(vkGetPipelineCacheData(_backend.getDevice(), _vkPipelineCache, &dataSize, nullptr));
+		if (dataSize == 0) {
+			return;
+		}
+		std::vector<std::byte> blob(sizeof(PipelineCacheFileHeader) + dataSize);
+		VK_CHECK(vkGetPipelineCacheData(_backend.getDevice(), _vkPipelineCache, &dataSize, blob.data() + sizeof(PipelineCacheFileHeader)));
+
+		const VkPhysicalDeviceProperties props = _backend.getPhysDeviceProperties();
+		PipelineCacheFileHeader header = {
+				.magic = kPipelineCacheMagic,
+				.dataSize = static_cast<uint32_t>(dataSize),
+				.vendorID = props.vendorID,
+				.deviceID = props.deviceID,
+				.driverVersion = props.driverVersion,
+		};
+		memcpy(header.uuid, props.pipelineCacheUUID, VK_UUID_SIZE);
+		memcpy(blob.data(), &header, sizeof(header));
+
+		std::ofstream file(_pipelineCachePath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			LOG_USER(LogType::Warning, "Failed to write pipeline cache to '{}'", _pipelineCachePath.string());
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(sizeof(header) + dataSize));
 	}
 
 	void GX::deferredTask(std::packaged_task<void()>&& task, SubmitHandle handle) const {
@@ -1129,10 +1923,10 @@ namespace Slate {
 		}
 		return true;
 	}
-	void GX::upload(InternalBufferHandle handle, const void* data, size_t size, size_t offset) {
+	UploadToken GX::upload(InternalBufferHandle handle, const void* data, size_t size, size_t offset) {
 		if (!data) {
 			LOG_USER(LogType::Warning, "Attempting to upload data which is null!");
-			return;
+			return {};
 		}
 		ASSERT_MSG(size > 0, "Size must be greater than 0!");
 
@@ -1140,9 +1934,9 @@ namespace Slate {
 
 		if (offset + size > buffer->_bufferSize) {
 			LOG_USER(LogType::Error, "Buffer request to upload is out of range! (Either the uploaded data size exceeds the size of the actual buffer or its offset is exceeding the total range)");
-			return;
+			return {};
 		}
-		_staging->bufferSubData(*buffer, offset, size, data);
+		return _staging->bufferSubData(*buffer, offset, size, data);
 	}
 	void GX::download(InternalBufferHandle handle, void* data, size_t size, size_t offset) {
 		if (!data) {
@@ -1155,16 +1949,23 @@ namespace Slate {
 			LOG_USER(LogType::Error, "Retrieved buffer is null, handle must have been invalid!");
 			return;
 		}
-		if (offset + size <= buffer->_bufferSize) {
+		if (offset + size > buffer->_bufferSize) {
 			LOG_USER(LogType::Error, "Buffer request to download is out of range!");
 			return;
 		}
-		buffer->getBufferSubData(*this, offset, size, data);
+		if (buffer->isMapped()) {
+			buffer->getBufferSubData(*this, offset, size, data);
+			return;
+		}
+		// device local memory has to come through the readback ring, this one waits for it
+		const ReadbackToken token = _readback->requestBuffer(*buffer, offset, size, nullptr);
+		_readback->wait(token);
+		_readback->fetch(token, data, size);
 	}
-	void GX::upload(InternalTextureHandle handle, const void* data, const TexRange& range) {
+	UploadToken GX::upload(InternalTextureHandle handle, const void* data, const TexRange& range) {
 		if (!data) {
 			LOG_USER(LogType::Warning, "Attempting to upload data which is null!");
-			return;
+			return {};
 		}
 		AllocatedImage* image = _texturePool.get(handle);
 		ASSERT_MSG(image, "Attempting to use texture via invalid handle!");
@@ -1173,7 +1974,7 @@ namespace Slate {
 		}
 		// why is this here
 		if (image->_vkImageType == VK_IMAGE_TYPE_3D) {
-			_staging->imageData3D(
+			return _staging->imageData3D(
 					*image,
 					VkOffset3D{range.offset.x, range.offset.y, range.offset.z},
 					VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
@@ -1184,9 +1985,15 @@ namespace Slate {
 					.offset = {.x = range.offset.x, .y = range.offset.y},
 					.extent = {.width = range.dimensions.width, .height = range.dimensions.height},
 			};
-			_staging->imageData2D(*image, image_region, range.mipLevel, range.numMipLevels, range.layer, range.numLayers, image->_vkFormat, data);
+			return _staging->imageData2D(*image, image_region, range.mipLevel, range.numMipLevels, range.layer, range.numLayers, image->_vkFormat, data);
 		}
 	}
+	bool GX::isUploadComplete(UploadToken token) const {
+		return _staging->isReady(token);
+	}
+	void GX::waitUpload(UploadToken token) {
+		_staging->wait(token);
+	}
 	void GX::download(InternalTextureHandle handle, void* data, const TexRange &range) {
 		if (!data) {
 			LOG_USER(LogType::Warning, "Data is null.");
@@ -1214,6 +2021,112 @@ namespace Slate {
 							   image->_vkFormat,
 							   data);
 	}
+	ReadbackToken GX::requestDownload(InternalBufferHandle handle, size_t size, size_t offset, ReadbackCallback callback) {
+		AllocatedBuffer* buffer = _bufferPool.get(handle);
+		if (!buffer) {
+			LOG_USER(LogType::Error, "Retrieved buffer is null, handle must have been invalid!");
+			return {};
+		}
+		if (offset + size > buffer->_bufferSize) {
+			LOG_USER(LogType::Error, "Buffer request to download is out of range!");
+			return {};
+		}
+		return _readback->requestBuffer(*buffer, offset, size, std::move(callback));
+	}
+	ReadbackToken GX::requestDownload(InternalTextureHandle handle, const TexRange& range, ReadbackCallback callback) {
+		AllocatedImage* image = _texturePool.get(handle);
+		if (!image) {
+			LOG_USER(LogType::Error, "Retrieved image is null, handle must have been invalid!");
+			return {};
+		}
+		if (!ValidateRange(image->_vkExtent, image->_numLevels, range)) {
+			LOG_USER(LogType::Warning, "Image validation failed!");
+			return {};
+		}
+		return _readback->requestImage(*image,
+									   VkOffset3D{range.offset.x, range.offset.y, range.offset.z},
+									   VkExtent3D{range.dimensions.width, range.dimensions.height, range.dimensions.depth},
+									   VkImageSubresourceRange{
+											   .aspectMask = vkutil::AspectMaskFromFormat(image->_vkFormat),
+											   .baseMipLevel = range.mipLevel,
+											   .levelCount = range.numMipLevels,
+											   .baseArrayLayer = range.layer,
+											   .layerCount = range.numLayers,
+									   },
+									   image->_vkFormat,
+									   std::move(callback));
+	}
+	bool GX::isDownloadComplete(ReadbackToken token) const {
+		return _readback->isReady(token);
+	}
+	bool GX::fetchDownload(ReadbackToken token, void* data, size_t size) {
+		return _readback->fetch(token, data, size);
+	}
+	void GX::waitDownload(ReadbackToken token) {
+		_readback->wait(token);
+	}
+
+	static bool WriteCapture(const std::filesystem::path& path, VkFormat format, uint32_t width, uint32_t height, std::span<const uint8_t> data) {
+		const uint32_t numPixels = width * height;
+		switch (format) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+				return stbi_write_png(path.string().c_str(), (int)width, (int)height, 4, data.data(), (int)width * 4) != 0;
+			case VK_FORMAT_B8G8R8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_SRGB: {
+				std::vector<uint8_t> pixels(data.begin(), data.begin() + numPixels * 4);
+				for (uint32_t i = 0; i < numPixels; i++) {
+					std::swap(pixels[i * 4 + 0], pixels[i * 4 + 2]);
+				}
+				return stbi_write_png(path.string().c_str(), (int)width, (int)height, 4, pixels.data(), (int)width * 4) != 0;
+			}
+			case VK_FORMAT_R16G16B16A16_SFLOAT: {
+				std::vector<float> pixels(numPixels * 4);
+				const uint16_t* halfs = reinterpret_cast<const uint16_t*>(data.data());
+				for (uint32_t i = 0; i < numPixels * 4; i++) {
+					pixels[i] = glm::unpackHalf1x16(halfs[i]);
+				}
+				return stbi_write_hdr(path.string().c_str(), (int)width, (int)height, 4, pixels.data()) != 0;
+			}
+			case VK_FORMAT_R32G32B32A32_SFLOAT:
+				return stbi_write_hdr(path.string().c_str(), (int)width, (int)height, 4, reinterpret_cast<const float*>(data.data())) != 0;
+			default:
+				return false;
+		}
+	}
+	ReadbackToken GX::captureTexture(InternalTextureHandle handle, const std::filesystem::path& path) {
+		const AllocatedImage* image = _texturePool.get(handle);
+		if (!image) {
+			LOG_USER(LogType::Error, "Retrieved image is null, handle must have been invalid!");
+			return {};
+		}
+		if (image->_isSwapchainImage && !_swapchain->isHeadless()) {
+			LOG_USER(LogType::Error, "Swapchain images belong to the presentation engine once submitted, only headless ones can be captured!");
+			return {};
+		}
+		const VkFormat format = image->_vkFormat;
+		switch (format) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+			case VK_FORMAT_R32G32B32A32_SFLOAT:
+				break;
+			default:
+				LOG_USER(LogType::Error, "Capturing textures in format {} is not supported!", (int)format);
+				return {};
+		}
+		const uint32_t width = image->_vkExtent.width;
+		const uint32_t height = image->_vkExtent.height;
+		return requestDownload(handle, TexRange{ .dimensions = {width, height, 1} }, [path, format, width, height](std::span<const uint8_t> data) {
+			if (WriteCapture(path, format, width, height, data)) {
+				LOG_USER(LogType::Info, "Captured {}x{} frame to '{}'", width, height, path.string());
+			} else {
+				LOG_USER(LogType::Warning, "Failed to write capture to '{}'", path.string());
+			}
+		});
+	}
 
 
 	void AllocatedBuffer::bufferSubData(const GX& ctx, size_t offset, size_t size, const void* data) {
@@ -1369,6 +2282,88 @@ namespace Slate {
 		}
 		throw std::runtime_error("Failed to find suitable memory type.");
 	}
+	void GX::aliasTextures(const std::vector<std::vector<InternalTextureHandle>>& groups) {
+		for (const std::vector<InternalTextureHandle>& group : groups) {
+			// lazily allocated memory costs next to nothing already, and memory only shares once
+			std::vector<InternalTextureHandle> members;
+			std::vector<VkDeviceSize> sizes;
+			VkMemoryRequirements combined = { .size = 0, .alignment = 1, .memoryTypeBits = ~0u };
+			for (InternalTextureHandle handle : group) {
+				const AllocatedImage* image = _texturePool.get(handle);
+				if (!image || !image->_isOwning || image->_isLazilyAllocated || image->_mappedPtr) continue;
+				ASSERT_MSG(image->_vkImageType == VK_IMAGE_TYPE_2D && image->_numLayers == 1, "Only single layer 2D textures can be aliased, '{}' is not!", image->_debugName);
+				const VkMemoryRequirements requirements = getImageMemoryRequirements(image->_vkImage);
+				if (!(combined.memoryTypeBits & requirements.memoryTypeBits)) {
+					LOG_USER(LogType::Warning, "'{}' has no memory type in common with the rest of its alias group, it keeps its own memory", image->_debugName);
+					continue;
+				}
+				combined.size = std::max(combined.size, requirements.size);
+				combined.alignment = std::max(combined.alignment, requirements.alignment);
+				combined.memoryTypeBits &= requirements.memoryTypeBits;
+				members.push_back(handle);
+				sizes.push_back(requirements.size);
+			}
+			if (members.empty()) continue;
+			const AllocatedImage* first = _texturePool.get(members[0]);
+			const bool isSharingAlready = first->_aliasGroup && _aliasedMemory.at(first->_vmaAllocation).numTextures == members.size() &&
+					std::all_of(members.begin(), members.end(), [&](InternalTextureHandle handle) { return _texturePool.get(handle)->_vmaAllocation == first->_vmaAllocation; });
+			if (isSharingAlready) continue;
+			// a lone texture only moves when it still shares memory with textures its lifetime may overlap now
+			if (members.size() < 2 && (!first->_aliasGroup || _aliasedMemory.at(first->_vmaAllocation).numTextures < 2)) continue;
+
+			const VmaAllocationCreateInfo allocation_ci = { .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+			VmaAllocation allocation = nullptr;
+			VK_CHECK(vmaAllocateMemory(_backend.getAllocator(), &combined, &allocation_ci, &allocation, nullptr));
+			AliasedMemory memory = { .group = _nextAliasGroup++, .numTextures = (uint32_t)members.size(), .size = combined.size };
+
+			for (size_t i = 0; i < members.size(); i++) {
+				AllocatedImage* image = _texturePool.get(members[i]);
+				const VkImageCreateInfo image_ci = {
+						.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+						.pNext = nullptr,
+						.flags = 0,
+						.imageType = image->_vkImageType,
+						.format = image->_vkFormat,
+						.extent = image->_vkExtent,
+						.mipLevels = image->_numLevels,
+						.arrayLayers = image->_numLayers,
+						.samples = image->_vkSampleCountFlagBits,
+						.tiling = VK_IMAGE_TILING_OPTIMAL,
+						.usage = image->_vkUsageFlags,
+						.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+						.queueFamilyIndexCount = 0,
+						.pQueueFamilyIndices = nullptr,
+						.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+				};
+				// the old image may still be in flight
+				_retireImage(*image);
+				VK_CHECK(vmaCreateAliasingImage(_backend.getAllocator(), allocation, &image_ci, &image->_vkImage));
+				image->_vmaAllocation = allocation;
+				image->_aliasGroup = memory.group;
+				image->_setLayout(VK_IMAGE_LAYOUT_UNDEFINED);
+				image->_vkImageView = VK_NULL_HANDLE;
+				image->_vkImageViewStorage = VK_NULL_HANDLE;
+				_createImageViews(*image, VK_IMAGE_VIEW_TYPE_2D);
+				// the frame submitted last may still sample the old view
+				_textureSlots.markRetired(members[i].index(), _imm->getLastSubmitHandle());
+				memory.requestedSize += sizes[i];
+			}
+			_aliasedMemory[allocation] = memory;
+			_transientMemoryStats.aliasedRequestedBytes += memory.requestedSize;
+			_transientMemoryStats.aliasedCommittedBytes += memory.size;
+			_transientMemoryStats.numAliasedTextures += memory.numTextures;
+			_transientMemoryStats.numAliasGroups++;
+		}
+	}
+	uint32_t GX::getTextureAliasGroup(InternalTextureHandle handle) const {
+		const AllocatedImage* image = _texturePool.get(handle);
+		return image ? image->_aliasGroup : 0;
+	}
+	VkDeviceSize GX::getTextureMemorySize(InternalTextureHandle handle) const {
+		const AllocatedImage* image = _texturePool.get(handle);
+		return (image && image->_isOwning) ? getImageMemoryRequirements(image->_vkImage).size : 0;
+	}
+
 	VmaAllocationInfo GX::getImageAllocInfo(InternalTextureHandle handle) {
 		VmaAllocationInfo allocInfo;
 		vmaGetAllocationInfo(_backend.getAllocator(), _texturePool.get(handle)->_vmaAllocation, &allocInfo);
@@ -192,6 +192,18 @@ namespace Slate {
 
 		vkb::PhysicalDevice& vkbphysdevice = physical_result.value();
 		_vkPhysicalDevice = vkbphysdevice.physical_device;
+		// optional, only the gpu profiler wants it
+		{
+			VkPhysicalDeviceFeatures statistics_features = {};
+			statistics_features.pipelineStatisticsQuery = true;
+			_hasPipelineStatistics = vkbphysdevice.enable_features_if_present(statistics_features);
+		}
+		// optional, moltenvk and some mobile drivers lack it, DrawList falls back to plain indirect draws
+		{
+			VkPhysicalDeviceVulkan12Features indirect_count_features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+			indirect_count_features.drawIndirectCount = true;
+			_hasDrawIndirectCount = vkbphysdevice.enable_extension_features_if_present(indirect_count_features);
+		}
 		_vkPhysDeviceProperties = vkbphysdevice.properties;
 
 		// get properties we can query later in case we need to
@@ -283,6 +295,17 @@ namespace Slate {
 		ASSERT_MSG(graphics_queue_index_result.has_value(), "Failed to get graphics queue index/family. Error: {}", graphics_queue_index_result.error().message().c_str());
 		_queues.graphicsQueueFamilyIndex = graphics_queue_index_result.value();
 
+		// transfer queue, only a family without graphics or compute is worth it, it maps to the copy engines
+		auto transfer_queue_result = vkb_device.get_dedicated_queue(vkb::QueueType::transfer);
+		auto transfer_queue_index_result = vkb_device.get_dedicated_queue_index(vkb::QueueType::transfer);
+		if (transfer_queue_result.has_value() && transfer_queue_index_result.has_value()) {
+			_queues.vkTransferQueue = transfer_queue_result.value();
+			_queues.transferQueueFamilyIndex = transfer_queue_index_result.value();
+		} else {
+			_queues.vkTransferQueue = _queues.vkGraphicsQueue;
+			_queues.transferQueueFamilyIndex = _queues.graphicsQueueFamilyIndex;
+		}
+
 		if (!_hasSurface) return;
 
 		// present queue
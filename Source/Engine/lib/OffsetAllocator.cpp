@@ -0,0 +1,71 @@
+//
+// Created by Hayden Rivas on 6/4/25.
+//
+#include "Slate/OffsetAllocator.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "Slate/Common/HelperMacros.h"
+
+namespace Slate {
+	uint32_t OffsetAllocator::allocate(uint32_t size) {
+		if (size == 0) {
+			return kInvalidOffset;
+		}
+		// first fit, lower offsets are preferred so live data naturally packs towards the front
+		for (auto it = _freeRanges.begin(); it != _freeRanges.end(); ++it) {
+			if (it->second < size) {
+				continue;
+			}
+			const uint32_t offset = it->first;
+			const uint32_t remaining = it->second - size;
+			_freeRanges.erase(it);
+			if (remaining) {
+				_freeRanges.emplace(offset + size, remaining);
+			}
+			_used += size;
+			return offset;
+		}
+		return kInvalidOffset;
+	}
+	void OffsetAllocator::free(uint32_t offset, uint32_t size) {
+		if (size == 0 || offset == kInvalidOffset) {
+			return;
+		}
+		ASSERT_MSG(offset + size <= _capacity, "Freeing a range outside of the allocator!");
+		ASSERT_MSG(size <= _used, "Freeing more than was ever allocated!");
+		_used -= size;
+
+		auto next = _freeRanges.lower_bound(offset);
+		// merge with the range right after
+		if (next != _freeRanges.end() && offset + size == next->first) {
+			size += next->second;
+			next = _freeRanges.erase(next);
+		}
+		// merge with the range right before
+		if (next != _freeRanges.begin()) {
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset) {
+				prev->second += size;
+				return;
+			}
+		}
+		_freeRanges.emplace(offset, size);
+	}
+	void OffsetAllocator::reset(uint32_t capacity) {
+		_freeRanges.clear();
+		_capacity = capacity;
+		_used = 0;
+		if (capacity) {
+			_freeRanges.emplace(0, capacity);
+		}
+	}
+	uint32_t OffsetAllocator::getLargestFreeRange() const {
+		uint32_t largest = 0;
+		for (const auto& [offset, size] : _freeRanges) {
+			largest = std::max(largest, size);
+		}
+		return largest;
+	}
+}
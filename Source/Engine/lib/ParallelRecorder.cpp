@@ -0,0 +1,138 @@
+#include "Slate/ParallelRecorder.h"
+
+#include "Slate/Common/HelperMacros.h"
+#include "Slate/GX.h"
+
+namespace Slate {
+	ParallelRecorder::ParallelRecorder(GX& gx, uint32_t numThreads) : _gx(gx) {
+		const VkCommandPoolCreateInfo command_pool_ci = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = _gx._backend.getGraphicsQueueFamilyIndex(),
+		};
+		for (std::vector<ThreadPool>& slot : _pools) {
+			slot.resize(numThreads + 1);
+			for (ThreadPool& pool : slot) {
+				VK_CHECK(vkCreateCommandPool(_gx._backend.getDevice(), &command_pool_ci, nullptr, &pool.pool));
+			}
+		}
+		_workers.reserve(numThreads);
+		for (uint32_t i = 0; i < numThreads; i++) {
+			_workers.emplace_back(&ParallelRecorder::_workerLoop, this, i + 1);
+		}
+	}
+	ParallelRecorder::~ParallelRecorder() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_isStopping = true;
+		}
+		_jobAvailable.notify_all();
+		for (std::thread& worker : _workers) {
+			worker.join();
+		}
+		for (uint32_t i = 0; i < kNumFrameSlots; i++) {
+			if (!_slotSubmits[i].empty()) {
+				_gx._imm->wait(_slotSubmits[i]);
+			}
+			// destroying the pool frees its buffers
+			for (ThreadPool& pool : _pools[i]) {
+				vkDestroyCommandPool(_gx._backend.getDevice(), pool.pool, nullptr);
+			}
+		}
+	}
+
+	void ParallelRecorder::record(CommandBuffer& primary, uint32_t numTasks, const RecordFn& fn) {
+		ASSERT_MSG(primary._isRendering && primary._renderingContents == RenderingContents::Secondary, "Primary has to be rendering with RenderingContents::Secondary!");
+		if (numTasks == 0) {
+			return;
+		}
+		_advanceSlot(primary);
+
+		std::vector<CommandBuffer> secondaries(numTasks);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_fn = &fn;
+			_primary = &primary;
+			_secondaries = &secondaries;
+			_numTasks = numTasks;
+			_nextTask.store(0, std::memory_order_relaxed);
+			_numBusy = static_cast<uint32_t>(_workers.size());
+			_jobId++;
+		}
+		_jobAvailable.notify_all();
+		_recordTasks(0);
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobFinished.wait(lock, [this]() { return _numBusy == 0; });
+			_fn = nullptr;
+			_primary = nullptr;
+			_secondaries = nullptr;
+		}
+		primary.cmdExecuteCommands(secondaries);
+	}
+
+	void ParallelRecorder::_workerLoop(uint32_t thread) {
+		uint64_t lastJob = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_jobAvailable.wait(lock, [this, lastJob]() { return _isStopping || _jobId != lastJob; });
+				if (_isStopping) {
+					return;
+				}
+				lastJob = _jobId;
+			}
+			_recordTasks(thread);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_numBusy--;
+			}
+			_jobFinished.notify_one();
+		}
+	}
+	void ParallelRecorder::_recordTasks(uint32_t thread) {
+		while (true) {
+			const uint32_t task = _nextTask.fetch_add(1, std::memory_order_relaxed);
+			if (task >= _numTasks) {
+				return;
+			}
+			CommandBuffer& cmd = (*_secondaries)[task];
+			cmd._beginSecondary(&_gx, _acquireSecondary(thread), *_primary);
+			(*_fn)(cmd, task);
+			cmd._endSecondary();
+		}
+	}
+	void ParallelRecorder::_advanceSlot(const CommandBuffer& primary) {
+		// every pass recorded into the same primary shares a slot
+		const uint64_t submit = primary._wrapper->_handle.handle();
+		if (submit == _currentSubmit) {
+			return;
+		}
+		_currentSubmit = submit;
+		_slot = (_slot + 1) % kNumFrameSlots;
+		if (!_slotSubmits[_slot].empty()) {
+			_gx._imm->wait(_slotSubmits[_slot]);
+		}
+		_slotSubmits[_slot] = primary._wrapper->_handle;
+		for (ThreadPool& pool : _pools[_slot]) {
+			VK_CHECK(vkResetCommandPool(_gx._backend.getDevice(), pool.pool, 0));
+			pool.numUsed = 0;
+		}
+	}
+	VkCommandBuffer ParallelRecorder::_acquireSecondary(uint32_t thread) {
+		ThreadPool& pool = _pools[_slot][thread];
+		if (pool.numUsed == pool.buffers.size()) {
+			const VkCommandBufferAllocateInfo command_buffer_ai = {
+					.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+					.commandPool = pool.pool,
+					.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+					.commandBufferCount = 1,
+			};
+			VkCommandBuffer buffer = VK_NULL_HANDLE;
+			VK_CHECK(vkAllocateCommandBuffers(_gx._backend.getDevice(), &command_buffer_ai, &buffer));
+			pool.buffers.push_back(buffer);
+		}
+		return pool.buffers[pool.numUsed++];
+	}
+}
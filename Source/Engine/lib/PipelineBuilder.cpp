@@ -33,7 +33,7 @@ namespace Slate {
 		_shaderStages.clear();
 	}
 	// build() needs to be the last function called on the builder!
-	VkPipeline PipelineBuilder::build(VkDevice device, VkPipelineLayout layout) {
+	VkPipeline PipelineBuilder::build(VkDevice device, VkPipelineLayout layout, VkPipelineCache cache, bool* outCacheHit) {
 		// the create info for the pipeline we are building
 		VkGraphicsPipelineCreateInfo graphics_pipeline_ci = { .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO, .pNext = nullptr };
 
@@ -81,21 +81,58 @@ namespace Slate {
 		viewportState.scissorCount = 1;
 		graphics_pipeline_ci.pViewportState = &viewportState;
 
+		// ------ creation feedback, tells us if the pipeline cache was able to skip compilation ------ //
+		VkPipelineCreationFeedback feedback = {};
+		VkPipelineCreationFeedbackCreateInfo feedback_ci = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+				.pNext = &_renderInfo,
+				.pPipelineCreationFeedback = &feedback,
+				.pipelineStageCreationFeedbackCount = 0,
+				.pPipelineStageCreationFeedbacks = nullptr,
+		};
+
 		// everything else that doesnt need configuring on build()
-		graphics_pipeline_ci.pNext = &_renderInfo;
+		graphics_pipeline_ci.pNext = &feedback_ci;
 		graphics_pipeline_ci.pInputAssemblyState = &_inputAssembly;
 		graphics_pipeline_ci.pRasterizationState = &_rasterizer;
 		graphics_pipeline_ci.pMultisampleState = &_multisampling;
 		graphics_pipeline_ci.pDepthStencilState = &_depthStencil; // for setncil operations which are not dynamic
 
 		graphics_pipeline_ci.layout = layout; // just the user given layout
+		// point at our own copy of the formats, the span given to set_color_formats may not outlive a copied builder
+		_renderInfo.pColorAttachmentFormats = _colorAttachmentFormats.data();
 
 		// -- actual creation -- //
 		VkPipeline newPipeline = VK_NULL_HANDLE;
-		VK_CHECK(vkCreateGraphicsPipelines(device, nullptr, 1, &graphics_pipeline_ci, nullptr, &newPipeline));
+		VK_CHECK(vkCreateGraphicsPipelines(device, cache, 1, &graphics_pipeline_ci, nullptr, &newPipeline));
+		if (outCacheHit) {
+			*outCacheHit = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) && (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT);
+		}
 		this->Clear(); // clear the entire pipeline struct to reuse the PipelineBuilder
 		return newPipeline;
 	}
+	VkPipeline BuildComputePipeline(VkDevice device, VkShaderModule module, const char* entryPoint, VkPipelineLayout layout, VkPipelineCache cache, bool* outCacheHit) {
+		VkPipelineCreationFeedback feedback = {};
+		VkPipelineCreationFeedbackCreateInfo feedback_ci = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+				.pNext = nullptr,
+				.pPipelineCreationFeedback = &feedback,
+				.pipelineStageCreationFeedbackCount = 0,
+				.pPipelineStageCreationFeedbacks = nullptr,
+		};
+		const VkComputePipelineCreateInfo compute_pipeline_ci = {
+				.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+				.pNext = &feedback_ci,
+				.stage = vkinfo::CreatePipelineShaderStageInfo(VK_SHADER_STAGE_COMPUTE_BIT, module, entryPoint),
+				.layout = layout,
+		};
+		VkPipeline newPipeline = VK_NULL_HANDLE;
+		VK_CHECK(vkCreateComputePipelines(device, cache, 1, &compute_pipeline_ci, nullptr, &newPipeline));
+		if (outCacheHit) {
+			*outCacheHit = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) && (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT);
+		}
+		return newPipeline;
+	}
 	PipelineBuilder& PipelineBuilder::set_moduleEXT(const VkShaderModule& vertModule, const VkShaderModule& fragModule) {
 		_shaderStages.clear();
 		_shaderStages.push_back(vkinfo::CreatePipelineShaderStageInfo(VK_SHADER_STAGE_VERTEX_BIT, vertModule, "main"));
@@ -0,0 +1,83 @@
+//
+// Created by Hayden Rivas on 6/2/25.
+//
+#include "Slate/PipelineCompiler.h"
+
+#include "Slate/Common/HelperMacros.h"
+
+namespace Slate {
+	PipelineCompiler::PipelineCompiler(VkDevice device, VkPipelineCache cache, uint32_t numThreads) : _vkDevice(device), _vkPipelineCache(cache) {
+		ASSERT_MSG(numThreads > 0, "Pipeline compiler needs at least one worker thread!");
+		_workers.reserve(numThreads);
+		for (uint32_t i = 0; i < numThreads; i++) {
+			_workers.emplace_back(&PipelineCompiler::_workerLoop, this);
+		}
+	}
+	PipelineCompiler::~PipelineCompiler() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_isStopping = true;
+		}
+		_jobAvailable.notify_all();
+		for (std::thread& worker : _workers) {
+			worker.join();
+		}
+		// anything nobody collected is still ours to free, layouts belong to the GX layout cache
+		for (const PipelineCompileResult& result : _results) {
+			vkDestroyPipeline(_vkDevice, result.pipeline, nullptr);
+		}
+	}
+
+	void PipelineCompiler::enqueue(PipelineCompileJob&& job) {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_jobs.push_back(std::move(job));
+		}
+		_jobAvailable.notify_one();
+	}
+	void PipelineCompiler::collect(std::vector<PipelineCompileResult>& out) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_results.empty()) {
+			return;
+		}
+		out.insert(out.end(), _results.begin(), _results.end());
+		_results.clear();
+	}
+	void PipelineCompiler::waitIdle() {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_jobFinished.wait(lock, [this]() { return _jobs.empty() && _numInFlight == 0; });
+	}
+	uint32_t PipelineCompiler::getNumPending() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return static_cast<uint32_t>(_jobs.size()) + _numInFlight;
+	}
+
+	void PipelineCompiler::_workerLoop() {
+		while (true) {
+			PipelineCompileJob job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_jobAvailable.wait(lock, [this]() { return _isStopping || !_jobs.empty(); });
+				if (_isStopping) {
+					return;
+				}
+				job = std::move(_jobs.front());
+				_jobs.pop_front();
+				_numInFlight++;
+			}
+			// pipeline caches are internally synchronized unless created EXTERNALLY_SYNCHRONIZED, so every worker can share one
+			PipelineCompileResult result = {
+					.handle = job.handle,
+					.layout = job.layout,
+					.dsl = job.dsl,
+			};
+			result.pipeline = job.builder.build(_vkDevice, job.layout, _vkPipelineCache, &result.cacheHit);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_results.push_back(result);
+				_numInFlight--;
+			}
+			_jobFinished.notify_all();
+		}
+	}
+}
@@ -2,7 +2,58 @@
 // Created by Hayden Rivas on 5/11/25.
 //
 #include "Slate/RenderPassBuilder.h"
+#include "Slate/Common/HelperMacros.h"
 
 namespace Slate {
+	RenderPassBuilder& RenderPassBuilder::addColorAttachment(InternalTextureHandle texture, LoadOperation loadOp, StoreOperation storeOp, Optional<RGBA> clear) {
+		return addMultisampledColorAttachment(texture, {}, loadOp, storeOp, ResolveMode::AVERAGE, clear);
+	}
+	RenderPassBuilder& RenderPassBuilder::addDepthStencilAttachment(InternalTextureHandle texture, LoadOperation loadOp, StoreOperation storeOp, Optional<float> clear) {
+		return addMultisampledDepthStencilAttachment(texture, {}, loadOp, storeOp, ResolveMode::SAMPLE_ZERO, clear);
+	}
+	RenderPassBuilder& RenderPassBuilder::addMultisampledColorAttachment(InternalTextureHandle texture, InternalTextureHandle resolveTexture, LoadOperation loadOp, StoreOperation storeOp,
+																		 ResolveMode resolveMode, Optional<RGBA> clear) {
+		ASSERT_MSG(_numColorAttachments < kMaxColorAttachments, "Render pass has too many color attachments!");
+		_pass.color[_numColorAttachments++] = {
+				.texture = texture,
+				.resolveTexture = resolveTexture,
+				.resolveMode = resolveMode,
+				.loadOp = loadOp,
+				.storeOp = storeOp,
+				// clear values mean nothing unless we actually clear
+				.clear = loadOp == LoadOperation::CLEAR ? clear : std::nullopt
+		};
+		return *this;
+	}
+	RenderPassBuilder& RenderPassBuilder::addMultisampledDepthStencilAttachment(InternalTextureHandle texture, InternalTextureHandle resolveTexture, LoadOperation loadOp, StoreOperation storeOp,
+																				ResolveMode resolveMode, Optional<float> clear) {
+		ASSERT_MSG(!_pass.depth.texture.valid(), "Render pass already has a depth attachment!");
+		_pass.depth = {
+				.texture = texture,
+				.resolveTexture = resolveTexture,
+				.resolveMode = resolveMode,
+				.loadOp = loadOp,
+				.storeOp = storeOp,
+				.clear = loadOp == LoadOperation::CLEAR ? clear : std::nullopt
+		};
+		return *this;
+	}
 
-}
\ No newline at end of file
+	RenderPassBuilder& RenderPassBuilder::addColorAttachment(const ColorAttachment& attachment) {
+		return addColorAttachment(attachment.texture, attachment.loadOp, attachment.storeOp, attachment.clear);
+	}
+	RenderPassBuilder& RenderPassBuilder::addDepthStencilAttachment(const DepthStencilAttachment& attachment) {
+		return addDepthStencilAttachment(attachment.texture, attachment.loadOp, attachment.storeOp, attachment.clear);
+	}
+	RenderPassBuilder& RenderPassBuilder::addMultisampledColorAttachment(const MultisampledColorAttachment& attachment, InternalTextureHandle resolveTexture) {
+		return addMultisampledColorAttachment(attachment.texture, resolveTexture, attachment.loadOp, attachment.storeOp, attachment.resolveMode, attachment.clear);
+	}
+	RenderPassBuilder& RenderPassBuilder::addMultisampledDepthStencilAttachment(const MultisampledDepthStencilAttachment& attachment, InternalTextureHandle resolveTexture) {
+		return addMultisampledDepthStencilAttachment(attachment.texture, resolveTexture, attachment.loadOp, attachment.storeOp, attachment.resolveMode, attachment.clear);
+	}
+
+	void RenderPassBuilder::Clear() {
+		_pass = {};
+		_numColorAttachments = 0;
+	}
+}
@@ -7,6 +7,8 @@
 #include "Slate/VK/vkinfo.h"
 #include "Slate/Common/Logger.h"
 
+#include <algorithm>
+
 namespace Slate {
 	VulkanImmediateCommands::VulkanImmediateCommands(VkDevice device, uint32_t queueFamilyIndex) : _vkDevice(device), _queueFamilyIndex(queueFamilyIndex) {
 		// just use the family index to get our queue vulkan object
@@ -20,6 +22,18 @@ namespace Slate {
 		};
 		VK_CHECK(vkCreateCommandPool(device, &command_pool_ci, nullptr, &_vkCommandPool));
 
+		// create submit timeline
+		const VkSemaphoreTypeCreateInfo semaphore_type_ci = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+				.initialValue = 0,
+		};
+		const VkSemaphoreCreateInfo timeline_ci = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+				.pNext = &semaphore_type_ci,
+		};
+		VK_CHECK(vkCreateSemaphore(_vkDevice, &timeline_ci, nullptr, &_vkSubmitTimeline));
+
 		// create command buffers
 		const VkCommandBufferAllocateInfo command_buffer_ai = {
 				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -53,6 +67,7 @@ namespace Slate {
 			vkDestroyFence(_vkDevice, buf._fence, nullptr);
 			vkDestroySemaphore(_vkDevice, buf._semaphore, nullptr);
 		}
+		vkDestroySemaphore(_vkDevice, _vkSubmitTimeline, nullptr);
 		vkDestroyCommandPool(_vkDevice, _vkCommandPool, nullptr);
 	}
 
@@ -132,11 +147,14 @@ namespace Slate {
 		ASSERT_MSG(wrapper._isEncoding, "Command buffer must be encoding!");
 		VK_CHECK(vkEndCommandBuffer(wrapper._cmdBuf));
 
-		VkSemaphoreSubmitInfo waitSemaphores[] = {{}, {}};
+		VkSemaphoreSubmitInfo waitSemaphores[] = {{}, {}, {}};
 		uint32_t numWaitSemaphores = 0;
 		if (_waitSemaphore.semaphore) {
 			waitSemaphores[numWaitSemaphores++] = _waitSemaphore;
 		}
+		if (_waitTimelineSemaphore.semaphore) {
+			waitSemaphores[numWaitSemaphores++] = _waitTimelineSemaphore;
+		}
 		if (_lastSubmitSemaphore.semaphore) {
 			waitSemaphores[numWaitSemaphores++] = _lastSubmitSemaphore;
 		}
@@ -145,9 +163,14 @@ namespace Slate {
 						.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
 						.semaphore = wrapper._semaphore,
 						.stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT},
+				VkSemaphoreSubmitInfo{
+						.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+						.semaphore = _vkSubmitTimeline,
+						.value = ++_submitTimelineValue,
+						.stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT},
 				{},
 		};
-		uint32_t numSignalSemaphores = 1;
+		uint32_t numSignalSemaphores = 2;
 		if (_signalSemaphore.semaphore) {
 			signalSemaphores[numSignalSemaphores++] = _signalSemaphore;
 		}
@@ -170,6 +193,7 @@ namespace Slate {
 		_lastSubmitSemaphore.semaphore = wrapper._semaphore;
 		_lastSubmitHandle = wrapper._handle;
 		_waitSemaphore.semaphore = VK_NULL_HANDLE;
+		_waitTimelineSemaphore.semaphore = VK_NULL_HANDLE;
 		_signalSemaphore.semaphore = VK_NULL_HANDLE;
 
 		// reset
@@ -191,6 +215,12 @@ namespace Slate {
 		_signalSemaphore.semaphore = semaphore;
 		_signalSemaphore.value = signalValue;
 	}
+	void VulkanImmediateCommands::waitTimelineSemaphore(VkSemaphore semaphore, uint64_t waitValue) {
+		ASSERT_MSG(_waitTimelineSemaphore.semaphore == VK_NULL_HANDLE || _waitTimelineSemaphore.semaphore == semaphore, "Only one timeline semaphore can be waited on per submit!");
+		// waiting on a later value of the same timeline covers the earlier one
+		_waitTimelineSemaphore.value = _waitTimelineSemaphore.semaphore ? std::max(_waitTimelineSemaphore.value, waitValue) : waitValue;
+		_waitTimelineSemaphore.semaphore = semaphore;
+	}
 	VkFence VulkanImmediateCommands::getVkFence(SubmitHandle handle) const {
 		if (handle.empty()) {
 			return VK_NULL_HANDLE;
@@ -0,0 +1,231 @@
+#include "Slate/VulkanProfiler.h"
+
+#include "Slate/GX.h"
+#include "Slate/Common/Logger.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace Slate {
+	// results come back in bit order, see _resolve
+	static constexpr VkQueryPipelineStatisticFlags kStatisticFlags =
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+	static constexpr uint32_t kNumStatisticValues = 4;
+
+	VulkanProfiler::VulkanProfiler(GX& ctx) : _gx(ctx) {
+		const VkPhysicalDevice physicalDevice = _gx._backend.getPhysicalDevice();
+		uint32_t numFamilies = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &numFamilies, nullptr);
+		std::vector<VkQueueFamilyProperties> families(numFamilies);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &numFamilies, families.data());
+		_timestampValidBits = families[_gx._backend.getGraphicsQueueFamilyIndex()].timestampValidBits;
+		_timestampPeriod = (double)_gx._backend.getPhysDeviceProperties().limits.timestampPeriod;
+		_hasStatistics = _gx._backend.hasPipelineStatistics();
+		if (!isSupported()) {
+			LOG_USER(LogType::Warning, "Graphics queue does not support timestamps, GPU profiling is unavailable");
+			return;
+		}
+
+		const VkDevice device = _gx._backend.getDevice();
+		for (Frame& frame : _frames) {
+			const VkQueryPoolCreateInfo timestamp_ci = {
+					.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+					.pNext = nullptr,
+					.flags = 0,
+					.queryType = VK_QUERY_TYPE_TIMESTAMP,
+					.queryCount = kMaxTimestamps,
+					.pipelineStatistics = 0
+			};
+			VK_CHECK(vkCreateQueryPool(device, &timestamp_ci, nullptr, &frame.timestampPool));
+			if (_hasStatistics) {
+				const VkQueryPoolCreateInfo statistics_ci = {
+						.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+						.pNext = nullptr,
+						.flags = 0,
+						.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+						.queryCount = kMaxStatistics,
+						.pipelineStatistics = kStatisticFlags
+				};
+				VK_CHECK(vkCreateQueryPool(device, &statistics_ci, nullptr, &frame.statisticsPool));
+			}
+		}
+		_results.resize(std::max(kMaxTimestamps, kMaxStatistics * kNumStatisticValues));
+	}
+	VulkanProfiler::~VulkanProfiler() {
+		const VkDevice device = _gx._backend.getDevice();
+		for (Frame& frame : _frames) {
+			if (frame.isPending) {
+				_gx._imm->wait(frame.handle_);
+			}
+			vkDestroyQueryPool(device, frame.timestampPool, nullptr);
+			vkDestroyQueryPool(device, frame.statisticsPool, nullptr);
+		}
+	}
+
+	void VulkanProfiler::beginCommandBuffer(VkCommandBuffer cmd) {
+		if (!_isEnabled) return;
+		Frame& frame = _frames[_current];
+		if (frame.isReset) return;
+		// wrapped around onto a frame the gpu still has, only happens when we run more than kNumFrames ahead
+		if (frame.isPending) {
+			if (!_gx._imm->isReady(frame.handle_)) {
+				_numStalls++;
+				_gx._imm->wait(frame.handle_);
+			}
+			_resolve(frame);
+		}
+		vkCmdResetQueryPool(cmd, frame.timestampPool, 0, kMaxTimestamps);
+		if (frame.statisticsPool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(cmd, frame.statisticsPool, 0, kMaxStatistics);
+		}
+		frame.scopes.clear();
+		frame.numTimestamps = 0;
+		frame.numStatistics = 0;
+		frame.frameNum = _frameNum;
+		frame.handle_ = {};
+		frame.isReset = true;
+	}
+	uint32_t VulkanProfiler::beginScope(VkCommandBuffer cmd, const char* name, bool collectStatistics) {
+		Frame& frame = _frames[_current];
+		if (!frame.isReset) return kInvalidScope;
+		if (frame.numTimestamps + 2 > kMaxTimestamps) {
+			if (!_hasWarnedOverflow) {
+				LOG_USER(LogType::Warning, "GPU profiler ran out of timestamp queries, scopes past {} per frame are dropped", kMaxTimestamps / 2);
+				_hasWarnedOverflow = true;
+			}
+			return kInvalidScope;
+		}
+		Scope scope = {
+				.name = name,
+				.depth = _numOpenScopes,
+				.beginQuery = frame.numTimestamps,
+				.endQuery = frame.numTimestamps + 1,
+		};
+		frame.numTimestamps += 2;
+		vkCmdWriteTimestamp2KHR(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.timestampPool, scope.beginQuery);
+		if (collectStatistics && frame.statisticsPool != VK_NULL_HANDLE && frame.numStatistics < kMaxStatistics) {
+			scope.statisticsQuery = frame.numStatistics++;
+			vkCmdBeginQuery(cmd, frame.statisticsPool, scope.statisticsQuery, 0);
+		}
+		frame.scopes.push_back(std::move(scope));
+		_numOpenScopes++;
+		return (uint32_t)frame.scopes.size() - 1;
+	}
+	void VulkanProfiler::endScope(VkCommandBuffer cmd, uint32_t scope) {
+		if (scope == kInvalidScope) return;
+		Frame& frame = _frames[_current];
+		ASSERT_MSG(frame.isReset && scope < frame.scopes.size() && frame.scopes[scope].isOpen, "Ending a GPU scope that is not open!");
+		Scope& s = frame.scopes[scope];
+		if (s.statisticsQuery != kInvalidScope) {
+			vkCmdEndQuery(cmd, frame.statisticsPool, s.statisticsQuery);
+		}
+		vkCmdWriteTimestamp2KHR(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, frame.timestampPool, s.endQuery);
+		s.isOpen = false;
+		_numOpenScopes--;
+	}
+	void VulkanProfiler::onSubmit(SubmitHandle handle, bool isEndOfFrame) {
+		Frame& frame = _frames[_current];
+		if (frame.isReset) {
+			frame.handle_ = handle;
+		}
+		if (!isEndOfFrame) return;
+		ASSERT_MSG(_numOpenScopes == 0, "{} GPU scopes are still open at the end of the frame!", _numOpenScopes);
+		if (frame.isReset) {
+			frame.isReset = false;
+			frame.isPending = true;
+			_current = (_current + 1) % kNumFrames;
+		}
+		_frameNum++;
+	}
+	void VulkanProfiler::process() {
+		// oldest first so the history stays in order
+		for (uint32_t i = 1; i <= kNumFrames; i++) {
+			Frame& frame = _frames[(_current + i) % kNumFrames];
+			if (!frame.isPending) continue;
+			if (!_gx._imm->isReady(frame.handle_, true) || !_resolve(frame)) break;
+		}
+	}
+
+	bool VulkanProfiler::_resolve(Frame& frame) {
+		const VkDevice device = _gx._backend.getDevice();
+		if (frame.numTimestamps > 0) {
+			const VkResult result = vkGetQueryPoolResults(device, frame.timestampPool, 0, frame.numTimestamps,
+														  frame.numTimestamps * sizeof(uint64_t), _results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+			if (result == VK_NOT_READY) return false;
+			VK_CHECK(result);
+		}
+		GPUFrameTimings timings = {
+				.frameNum = frame.frameNum,
+		};
+		const uint64_t mask = _timestampValidBits >= 64 ? UINT64_MAX : ((1ull << _timestampValidBits) - 1);
+		const auto ticksToMs = [&](uint64_t begin, uint64_t end) {
+			return (double)((end - begin) & mask) * _timestampPeriod / 1e6;
+		};
+		uint64_t first = UINT64_MAX;
+		uint64_t last = 0;
+		timings.scopes.reserve(frame.scopes.size());
+		for (const Scope& scope : frame.scopes) {
+			const uint64_t begin = _results[scope.beginQuery] & mask;
+			const uint64_t end = _results[scope.endQuery] & mask;
+			first = std::min(first, begin);
+			last = std::max(last, end);
+			timings.scopes.push_back({
+					.name = scope.name,
+					.depth = scope.depth,
+					.milliseconds = ticksToMs(begin, end),
+			});
+		}
+		timings.milliseconds = frame.scopes.empty() ? 0.0 : ticksToMs(first, last);
+
+		if (frame.numStatistics > 0) {
+			const VkResult result = vkGetQueryPoolResults(device, frame.statisticsPool, 0, frame.numStatistics,
+														  frame.numStatistics * kNumStatisticValues * sizeof(uint64_t), _results.data(),
+														  kNumStatisticValues * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+			if (result == VK_NOT_READY) return false;
+			VK_CHECK(result);
+			for (size_t i = 0; i < frame.scopes.size(); i++) {
+				const uint32_t query = frame.scopes[i].statisticsQuery;
+				if (query == kInvalidScope) continue;
+				const uint64_t* values = &_results[query * kNumStatisticValues];
+				GPUScopeTiming& scope = timings.scopes[i];
+				scope.hasStatistics = true;
+				scope.primitives = values[0];
+				scope.vertexInvocations = values[1];
+				scope.clippedPrimitives = values[2];
+				scope.fragmentInvocations = values[3];
+			}
+		}
+		frame.isPending = false;
+
+		_history.push_back(std::move(timings));
+		if (_history.size() > kMaxHistory) {
+			_history.pop_front();
+		}
+		return true;
+	}
+
+	bool VulkanProfiler::writeHistory(const std::filesystem::path& path) const {
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open()) {
+			LOG_USER(LogType::Warning, "Failed to write GPU timings to '{}'", path.string());
+			return false;
+		}
+		file << "frame,scope,depth,ms,primitives,vertex_invocations,clipped_primitives,fragment_invocations\n";
+		for (const GPUFrameTimings& frame : _history) {
+			file << frame.frameNum << ",Frame,0," << frame.milliseconds << ",,,,\n";
+			for (const GPUScopeTiming& scope : frame.scopes) {
+				file << frame.frameNum << ",\"" << scope.name << "\"," << scope.depth + 1 << "," << scope.milliseconds << ",";
+				if (scope.hasStatistics) {
+					file << scope.primitives << "," << scope.vertexInvocations << "," << scope.clippedPrimitives << "," << scope.fragmentInvocations;
+				} else {
+					file << ",,,";
+				}
+				file << "\n";
+			}
+		}
+		return true;
+	}
+}
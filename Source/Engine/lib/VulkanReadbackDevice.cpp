@@ -0,0 +1,285 @@
+#include "Slate/VulkanReadbackDevice.h"
+
+#include "Slate/GX.h"
+#include "Slate/VK/vkutil.h"
+#include "Slate/Common/Logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Slate {
+	static void BufferMemoryBarrier2(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, vkutil::StageAccess src, vkutil::StageAccess dst) {
+		const VkBufferMemoryBarrier2 barrier = {
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.pNext = nullptr,
+				.srcStageMask = src.stage,
+				.srcAccessMask = src.access,
+				.dstStageMask = dst.stage,
+				.dstAccessMask = dst.access,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = buffer,
+				.offset = offset,
+				.size = size,
+		};
+		const VkDependencyInfo di = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.pNext = nullptr,
+				.bufferMemoryBarrierCount = 1,
+				.pBufferMemoryBarriers = &barrier,
+		};
+		vkCmdPipelineBarrier2KHR(cmd, &di);
+	}
+
+	VulkanReadbackDevice::VulkanReadbackDevice(GX& ctx) : _gx(ctx) {
+		const VkPhysicalDeviceLimits& limits = _gx._backend.getPhysDeviceProperties().limits;
+		// same cap as the staging buffer, readbacks are far rarer so the ring starts small
+		_maxBufferSize = std::min(limits.maxStorageBufferRange, 128u * 1024u * 1024u);
+		ASSERT_MSG(_minBufferSize <= _maxBufferSize, "Min buffer size MUST BE smaller than or equal to max buffer size!");
+	}
+	VulkanReadbackDevice::~VulkanReadbackDevice() {
+		// nobody is left to hand the bytes to, just make sure the gpu is done writing into the ring
+		if (!_inFlight.empty()) {
+			_gx._imm->wait(_inFlight.back().handle_);
+		}
+		_inFlight.clear();
+		_unclaimed.clear();
+		_finished.clear();
+	}
+
+	ReadbackToken VulkanReadbackDevice::requestBuffer(AllocatedBuffer& buffer, size_t offset, size_t size, ReadbackCallback callback) {
+		ASSERT(offset + size <= buffer._bufferSize);
+		ASSERT_MSG(buffer._vkUsageFlags & VK_BUFFER_USAGE_TRANSFER_SRC_BIT, "Only device buffers can be read back, host buffers are read directly!");
+		ASSERT_MSG(size <= _maxBufferSize, "Readback of {} bytes does not fit the {} byte readback ring!", size, _maxBufferSize);
+
+		const uint32_t dataSize = (uint32_t)size;
+		const uint32_t alignedSize = vkutil::GetAlignedSize(dataSize, kReadbackAlignment);
+		const uint32_t ringOffset = _allocate(alignedSize);
+		AllocatedBuffer* readbackBuffer = _gx._bufferPool.get(_readbackBuffer);
+
+		const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _gx._imm->acquire();
+		// anything submitted earlier may still be writing the buffer
+		BufferMemoryBarrier2(wrapper._cmdBuf,
+							 buffer._vkBuffer,
+							 offset,
+							 size,
+							 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_WRITE_BIT},
+							 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT});
+		const VkBufferCopy copy = {
+				.srcOffset = offset,
+				.dstOffset = ringOffset,
+				.size = size,
+		};
+		vkCmdCopyBuffer(wrapper._cmdBuf, buffer._vkBuffer, readbackBuffer->_vkBuffer, 1, &copy);
+		BufferMemoryBarrier2(wrapper._cmdBuf,
+							 readbackBuffer->_vkBuffer,
+							 ringOffset,
+							 alignedSize,
+							 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT},
+							 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_HOST_BIT, .access = VK_ACCESS_2_HOST_READ_BIT});
+
+		return _push(ringOffset, alignedSize, dataSize, _gx._imm->submit(wrapper), std::move(callback));
+	}
+	ReadbackToken VulkanReadbackDevice::requestImage(AllocatedImage& image,
+													 const VkOffset3D& offset,
+													 const VkExtent3D& extent,
+													 VkImageSubresourceRange range,
+													 VkFormat format,
+													 ReadbackCallback callback) {
+		ASSERT(image.getLayout() != VK_IMAGE_LAYOUT_UNDEFINED);
+		ASSERT(range.layerCount == 1 && range.levelCount == 1);
+
+		const size_t size = (size_t)extent.width * extent.height * extent.depth * vkutil::GetBytesPerPixel(format);
+		ASSERT_MSG(size <= _maxBufferSize, "Readback of {} bytes does not fit the {} byte readback ring!", size, _maxBufferSize);
+
+		const uint32_t dataSize = (uint32_t)size;
+		const uint32_t alignedSize = vkutil::GetAlignedSize(dataSize, kReadbackAlignment);
+		const uint32_t ringOffset = _allocate(alignedSize);
+		AllocatedBuffer* readbackBuffer = _gx._bufferPool.get(_readbackBuffer);
+		const VkImageLayout layout = image.getLayout();
+
+		const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _gx._imm->acquire();
+
+		// 1. Transition to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+		vkutil::ImageMemoryBarrier2(
+				wrapper._cmdBuf,
+				image._vkImage,
+				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT},
+				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT},
+				layout,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				range);
+
+		// 2. Copy the pixel data from the image into the ring
+		const VkBufferImageCopy copy = {
+				.bufferOffset = ringOffset,
+				.bufferRowLength = 0,
+				.bufferImageHeight = 0,
+				.imageSubresource =
+						VkImageSubresourceLayers{
+								.aspectMask = range.aspectMask,
+								.mipLevel = range.baseMipLevel,
+								.baseArrayLayer = range.baseArrayLayer,
+								.layerCount = range.layerCount,
+						},
+				.imageOffset = offset,
+				.imageExtent = extent,
+		};
+		vkCmdCopyImageToBuffer(wrapper._cmdBuf, image._vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer->_vkBuffer, 1, &copy);
+
+		// 3. Transition back to the layout the image had, the host read waits on the ring write
+		vkutil::ImageMemoryBarrier2(
+				wrapper._cmdBuf,
+				image._vkImage,
+				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT},
+				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT},
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				layout,
+				range);
+		BufferMemoryBarrier2(wrapper._cmdBuf,
+							 readbackBuffer->_vkBuffer,
+							 ringOffset,
+							 alignedSize,
+							 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT},
+							 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_HOST_BIT, .access = VK_ACCESS_2_HOST_READ_BIT});
+
+		return _push(ringOffset, alignedSize, dataSize, _gx._imm->submit(wrapper), std::move(callback));
+	}
+
+	void VulkanReadbackDevice::process() {
+		// submits on one queue finish in order, the first one still running means everything after it is too
+		while (!_inFlight.empty() && _gx._imm->isReady(_inFlight.front().handle_)) {
+			_completeOldest();
+		}
+		_runCallbacks();
+	}
+	bool VulkanReadbackDevice::isReady(ReadbackToken token) const {
+		if (token.empty() || token.id <= _lastCompletedId) {
+			return true;
+		}
+		// ids are handed out one after the other, so the position in the ring is known without searching
+		const uint64_t index = token.id - _inFlight.front().id;
+		ASSERT(index < _inFlight.size());
+		return _gx._imm->isReady(_inFlight[index].handle_);
+	}
+	bool VulkanReadbackDevice::fetch(ReadbackToken token, void* outData, size_t size) {
+		if (token.id > _lastCompletedId) {
+			if (!isReady(token)) {
+				return false;
+			}
+			process();
+		}
+		auto it = _unclaimed.find(token.id);
+		if (it == _unclaimed.end()) {
+			LOG_USER(LogType::Warning, "Readback {} has a callback or was fetched already!", token.id);
+			return false;
+		}
+		ASSERT_MSG(size <= it->second.size(), "Fetching {} bytes from a readback of {} bytes!", size, it->second.size());
+		memcpy(outData, it->second.data(), size);
+		_unclaimed.erase(it);
+		return true;
+	}
+	void VulkanReadbackDevice::wait(ReadbackToken token) {
+		while (token.id > _lastCompletedId) {
+			_completeOldest();
+		}
+		_runCallbacks();
+	}
+
+	uint32_t VulkanReadbackDevice::_allocate(uint32_t alignedSize) {
+		_ensureBufferSize(alignedSize);
+		while (true) {
+			if (_inFlight.empty()) {
+				_head = 0;
+				break;
+			}
+			// the ring runs from the oldest readback up to the head, free space is whatever is outside of that
+			const uint32_t tail = _inFlight.front().offset_;
+			const uint32_t endSpace = _head > tail ? _bufferSize - _head : (_head < tail ? tail - _head : 0);
+			const uint32_t wrapSpace = _head > tail ? tail : 0;
+			if (endSpace >= alignedSize) {
+				break;
+			}
+			if (wrapSpace >= alignedSize) {
+				// the bytes left at the end go to the newest readback, they free up together with it
+				_inFlight.back().size_ += _bufferSize - _head;
+				_head = 0;
+				break;
+			}
+			if (!_gx._imm->isReady(_inFlight.front().handle_)) {
+				_numStalls++;
+			}
+			_completeOldest();
+		}
+		const uint32_t offset = _head;
+		_head += alignedSize;
+		return offset;
+	}
+	void VulkanReadbackDevice::_ensureBufferSize(uint32_t sizeNeeded) {
+		if (!_readbackBuffer.empty() && sizeNeeded <= _bufferSize) {
+			return;
+		}
+		// everything in flight lives in the old buffer, hand it over before the buffer goes
+		while (!_inFlight.empty()) {
+			_completeOldest();
+		}
+		_readbackBuffer = nullptr;
+		_bufferSize = std::min(std::max({vkutil::GetAlignedSize(sizeNeeded, kReadbackAlignment), _bufferSize * 2, _minBufferSize}), _maxBufferSize);
+		_head = 0;
+		{
+			AllocatedBuffer obj = _gx.createBufferImpl(_bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			snprintf(obj._debugName, sizeof(obj._debugName) - 1, "readback buffer %u", _bufferCounter++);
+			vmaSetAllocationName(_gx._backend.getAllocator(), obj._vmaAllocation, obj._debugName);
+			InternalBufferHandle handle = _gx._bufferPool.create(std::move(obj));
+			_readbackBuffer = {&_gx, handle};
+		}
+		ASSERT(!_readbackBuffer.empty());
+	}
+	ReadbackToken VulkanReadbackDevice::_push(uint32_t offset, uint32_t alignedSize, uint32_t dataSize, SubmitHandle handle, ReadbackCallback&& callback) {
+		const uint64_t id = _nextId++;
+		_inFlight.push_back({
+				.id = id,
+				.offset_ = offset,
+				.size_ = alignedSize,
+				.dataSize_ = dataSize,
+				.handle_ = handle,
+				.callback = std::move(callback),
+		});
+		return { id };
+	}
+	void VulkanReadbackDevice::_completeOldest() {
+		ASSERT(!_inFlight.empty());
+		Request& request = _inFlight.front();
+		_gx._imm->wait(request.handle_);
+
+		AllocatedBuffer* readbackBuffer = _gx._bufferPool.get(_readbackBuffer);
+		if (!readbackBuffer->_isCoherentMemory) {
+			readbackBuffer->invalidateMappedMemory(_gx, request.offset_, request.dataSize_);
+		}
+		const uint8_t* data = readbackBuffer->getMappedPtr() + request.offset_;
+		_lastCompletedId = request.id;
+		// this can run from inside a request making room in the ring, so the callback is only queued here
+		if (request.callback) {
+			_finished.push_back({
+					.callback = std::move(request.callback),
+					.data = std::vector<uint8_t>(data, data + request.dataSize_),
+			});
+		} else {
+			_unclaimed.emplace(request.id, std::vector<uint8_t>(data, data + request.dataSize_));
+		}
+		_inFlight.pop_front();
+	}
+	void VulkanReadbackDevice::_runCallbacks() {
+		if (_isCompleting) {
+			return;
+		}
+		_isCompleting = true;
+		while (!_finished.empty()) {
+			// popped first, the callback may queue more behind it
+			const Finished finished = std::move(_finished.front());
+			_finished.pop_front();
+			finished.callback(std::span<const uint8_t>(finished.data));
+		}
+		_isCompleting = false;
+	}
+}
@@ -5,27 +5,147 @@
 
 #include "Slate/GX.h"
 #include "Slate/VK/vkutil.h"
+#include "Slate/Common/Logger.h"
 #include "Slate/Common/SmartObject.h"
 
+#include <algorithm>
+
 namespace Slate {
+	static void RecordBarriers(VkCommandBuffer cmd, std::span<const VkImageMemoryBarrier2> imageBarriers, std::span<const VkBufferMemoryBarrier2> bufferBarriers) {
+		if (imageBarriers.empty() && bufferBarriers.empty()) {
+			return;
+		}
+		const VkDependencyInfo di = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.pNext = nullptr,
+				.bufferMemoryBarrierCount = (uint32_t)bufferBarriers.size(),
+				.pBufferMemoryBarriers = bufferBarriers.data(),
+				.imageMemoryBarrierCount = (uint32_t)imageBarriers.size(),
+				.pImageMemoryBarriers = imageBarriers.data()
+		};
+		vkCmdPipelineBarrier2KHR(cmd, &di);
+	}
+	// turns barriers into the release half in place and returns the matching acquire half
+	// both halves need the same layouts and queue families, the release drops the destination scope and the acquire the source scope
+	template<typename Barrier>
+	static std::vector<Barrier> SplitOwnershipTransfer(std::span<Barrier> barriers, uint32_t srcQueueFamily, uint32_t dstQueueFamily) {
+		std::vector<Barrier> acquire(barriers.begin(), barriers.end());
+		for (size_t i = 0; i < barriers.size(); i++) {
+			barriers[i].srcQueueFamilyIndex = acquire[i].srcQueueFamilyIndex = srcQueueFamily;
+			barriers[i].dstQueueFamilyIndex = acquire[i].dstQueueFamilyIndex = dstQueueFamily;
+			barriers[i].dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+			barriers[i].dstAccessMask = VK_ACCESS_2_NONE;
+			acquire[i].srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+			acquire[i].srcAccessMask = VK_ACCESS_2_NONE;
+		}
+		return acquire;
+	}
+
+	static VkImageMemoryBarrier2 CreateUploadedImageBarrier(VkImage image, const VkImageSubresourceRange& range) {
+		return {
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.pNext = nullptr,
+				.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+				.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = image,
+				.subresourceRange = range
+		};
+	}
+
 	VulkanStagingDevice::VulkanStagingDevice(GX& ctx) : _gx(ctx) {
 		const VkPhysicalDeviceLimits& limits = _gx._backend.getPhysDeviceProperties().limits;
 		// use default value of 128Mb clamped to the max limits
 		_maxBufferSize = std::min(limits.maxStorageBufferRange, 128u * 1024u * 1024u);
 		ASSERT_MSG(_minBufferSize <= _maxBufferSize, "Min buffer size MUST BE smaller than or equal to max buffer size!");
+
+		if (_gx._backend.hasDedicatedTransferQueue()) {
+			_transferImm = CreateUniquePtr<VulkanImmediateCommands>(_gx._backend.getDevice(), _gx._backend.getTransferQueueFamilyIndex());
+			const VkSemaphoreTypeCreateInfo semaphore_type_ci = {
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+					.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+					.initialValue = 0,
+			};
+			const VkSemaphoreCreateInfo semaphore_ci = {
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+					.pNext = &semaphore_type_ci,
+			};
+			VK_CHECK(vkCreateSemaphore(_gx._backend.getDevice(), &semaphore_ci, nullptr, &_vkTransferSemaphore));
+			LOG_USER(LogType::Info, "Uploads use the dedicated transfer queue family {}", _gx._backend.getTransferQueueFamilyIndex());
+		}
+	}
+	VulkanStagingDevice::~VulkanStagingDevice() {
+		if (_transferImm) {
+			_transferImm->waitAll();
+			_transferImm.reset(nullptr);
+			vkDestroySemaphore(_gx._backend.getDevice(), _vkTransferSemaphore, nullptr);
+		}
+	}
+	VulkanImmediateCommands& VulkanStagingDevice::_copyCommands() const {
+		return _transferImm ? *_transferImm : *_gx._imm;
+	}
+	bool VulkanStagingDevice::isReady(UploadToken token) const {
+		return _copyCommands().isReady(token.handle);
+	}
+	void VulkanStagingDevice::wait(UploadToken token) {
+		// an empty handle would idle the whole device
+		if (token.empty()) {
+			return;
+		}
+		_copyCommands().wait(token.handle);
+	}
+	SubmitHandle VulkanStagingDevice::_submitCopy(const VulkanImmediateCommands::CommandBufferWrapper& wrapper,
+												  std::span<VkImageMemoryBarrier2> imageBarriers,
+												  std::span<VkBufferMemoryBarrier2> bufferBarriers) {
+		if (!_transferImm) {
+			RecordBarriers(wrapper._cmdBuf, imageBarriers, bufferBarriers);
+			return _gx._imm->submit(wrapper);
+		}
+		const uint32_t transferFamily = _gx._backend.getTransferQueueFamilyIndex();
+		const uint32_t graphicsFamily = _gx._backend.getGraphicsQueueFamilyIndex();
+		const std::vector<VkImageMemoryBarrier2> acquireImages = SplitOwnershipTransfer(imageBarriers, transferFamily, graphicsFamily);
+		const std::vector<VkBufferMemoryBarrier2> acquireBuffers = SplitOwnershipTransfer(bufferBarriers, transferFamily, graphicsFamily);
+
+		RecordBarriers(wrapper._cmdBuf, imageBarriers, bufferBarriers);
+		_waitForGraphics();
+		_transferImm->signalSemaphore(_vkTransferSemaphore, ++_transferSemaphoreValue);
+		const SubmitHandle handle = _transferImm->submit(wrapper);
+
+		// the acquire goes ahead of anything graphics records later, the gpu holds it until the copy signaled, the cpu never waits
+		const VulkanImmediateCommands::CommandBufferWrapper& acquireWrapper = _gx._imm->acquire();
+		RecordBarriers(acquireWrapper._cmdBuf, acquireImages, acquireBuffers);
+		_gx._imm->waitTimelineSemaphore(_vkTransferSemaphore, _transferSemaphoreValue);
+		_gx._imm->submit(acquireWrapper);
+		return handle;
+	}
+	void VulkanStagingDevice::orderAfterUploads(VulkanImmediateCommands& imm) const {
+		if (!_transferImm || _transferSemaphoreValue == 0) return;
+		imm.waitTimelineSemaphore(_vkTransferSemaphore, _transferSemaphoreValue);
 	}
-	void VulkanStagingDevice::bufferSubData(AllocatedBuffer& buffer, size_t dstOffset, size_t size, const void* data) {
+	void VulkanStagingDevice::_waitForGraphics() {
+		if (!_transferImm) return;
+		// graphics work already submitted may still read what we are about to overwrite, the copy starts after it
+		_transferImm->waitTimelineSemaphore(_gx._imm->getSubmitTimeline(), _gx._imm->getLastSubmitTimelineValue());
+	}
+	UploadToken VulkanStagingDevice::bufferSubData(AllocatedBuffer& buffer, size_t dstOffset, size_t size, const void* data) {
 		if (buffer.isMapped()) {
 			buffer.bufferSubData(_gx, dstOffset, size, data);
-			return;
+			return {};
 		}
-		AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
-		ASSERT(stagingBuffer);
-
+		UploadToken token = {};
 		while (size) {
 			// get next staging buffer free offset
-			MemoryRegionDesc desc = getNextFreeOffset((uint32_t)size);
-			const uint32_t chunkSize = std::min((uint32_t)size, desc.size_);
+			MemoryRegionDesc desc = getNextFreeOffset((uint32_t)std::min<size_t>(size, _maxBufferSize));
+			const uint32_t chunkSize = (uint32_t)std::min<size_t>(size, desc.size_);
+
+			// the staging buffer may have grown while we got the region
+			AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
+			ASSERT(stagingBuffer);
 
 			// copy data into staging buffer
 			stagingBuffer->bufferSubData(_gx, desc.offset_, chunkSize, data);
@@ -37,108 +157,62 @@ namespace Slate {
 					.size = chunkSize,
 			};
 
-			const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _gx._imm->acquire();
+			const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _copyCommands().acquire();
 			vkCmdCopyBuffer(wrapper._cmdBuf, stagingBuffer->_vkBuffer, buffer._vkBuffer, 1, &copy);
-			VkBufferMemoryBarrier barrier = {
-					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-					.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-					.dstAccessMask = 0,
+			// only the written range changes owner, graphics keeps reading the rest of the buffer meanwhile
+			VkBufferMemoryBarrier2 barrier = {
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+					.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+					.dstAccessMask = VK_ACCESS_2_NONE,
 					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 					.buffer = buffer._vkBuffer,
 					.offset = dstOffset,
 					.size = chunkSize,
 			};
-			VkPipelineStageFlags dstMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 			if (buffer._vkUsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
-				dstMask |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
-				barrier.dstAccessMask |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+				barrier.dstStageMask |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+				barrier.dstAccessMask |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
 			}
 			if (buffer._vkUsageFlags & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
-				dstMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-				barrier.dstAccessMask |= VK_ACCESS_INDEX_READ_BIT;
+				barrier.dstStageMask |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+				barrier.dstAccessMask |= VK_ACCESS_2_INDEX_READ_BIT;
 			}
 			if (buffer._vkUsageFlags & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
-				dstMask |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-				barrier.dstAccessMask |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+				barrier.dstStageMask |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+				barrier.dstAccessMask |= VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
 			}
 			if (buffer._vkUsageFlags & VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR) {
-				dstMask |= VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-				barrier.dstAccessMask |= VK_ACCESS_MEMORY_READ_BIT;
+				barrier.dstStageMask |= VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+				barrier.dstAccessMask |= VK_ACCESS_2_MEMORY_READ_BIT;
 			}
-			vkCmdPipelineBarrier(wrapper._cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, dstMask, VkDependencyFlags{}, 0, nullptr, 1, &barrier, 0, nullptr);
-			desc.handle_ = _gx._imm->submit(wrapper);
-			_regions.push_back(desc);
+			desc.handle_ = _submitCopy(wrapper, {}, std::span<VkBufferMemoryBarrier2>(&barrier, 1));
+			_releaseRegion(desc, chunkSize);
+			// chunks go out in order on one queue, the last one finishing covers the rest
+			token.handle = desc.handle_;
 
 			size -= chunkSize;
 			data = (uint8_t*)data + chunkSize;
 			dstOffset += chunkSize;
 		}
+		return token;
 	}
-	void VulkanStagingDevice::imageData3D(AllocatedImage& image, const VkOffset3D& offset, const VkExtent3D& extent, VkFormat format, const void* data) {
+	UploadToken VulkanStagingDevice::imageData3D(AllocatedImage& image, const VkOffset3D& offset, const VkExtent3D& extent, VkFormat format, const void* data) {
 		ASSERT_MSG(image._numLevels == 1, "Can handle only 3D images with exactly 1 mip-level");
 		ASSERT_MSG((offset.x == 0) && (offset.y == 0) && (offset.z == 0), "Can upload only full-size 3D images");
-		const uint32_t storageSize = extent.width * extent.height * extent.depth * vkutil::GetBytesPerPixel(format);
-
-		ensureStagingBufferSize(storageSize);
-
-		ASSERT_MSG(storageSize <= _stagingBufferSize, "No support for copying image in multiple smaller chunk sizes");
-
-		// get next staging buffer free offset
-		MemoryRegionDesc desc = getNextFreeOffset(storageSize);
-
-		// No support for copying image in multiple smaller chunk sizes.
-		// If we get smaller buffer size than storageSize, we will wait for GPU idle and get a bigger chunk.
-		if (desc.size_ < storageSize) {
-			waitAndReset();
-			desc = getNextFreeOffset(storageSize);
-		}
-
-		ASSERT(desc.size_ >= storageSize);
 
-		AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
-
-		// 1. Copy the pixel data into the host visible staging buffer
-		stagingBuffer->bufferSubData(_gx, desc.offset_, storageSize, data);
-
-		const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _gx._imm->acquire();
-
-		// 1. Transition initial image layout into TRANSFER_DST_OPTIMAL
-		vkutil::ImageMemoryBarrier2(wrapper._cmdBuf,
-								 image._vkImage,
-								 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, .access = VK_ACCESS_2_NONE},
-								 vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT},
-								 VK_IMAGE_LAYOUT_UNDEFINED,
-								 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-								 VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
-
-		// 2. Copy the pixel data from the staging buffer into the image
-		const VkBufferImageCopy copy = {
-				.bufferOffset = desc.offset_,
-				.bufferRowLength = 0,
-				.bufferImageHeight = 0,
-				.imageSubresource = VkImageSubresourceLayers{VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-				.imageOffset = offset,
-				.imageExtent = extent,
+		const ImageCopyRegion copy = {
+				.mipLevel = 0,
+				.layer = 0,
+				.offset = offset,
+				.extent = extent,
+				.dataOffset = 0,
 		};
-		vkCmdCopyBufferToImage(wrapper._cmdBuf, stagingBuffer->_vkBuffer, image._vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
-
-		// 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL
-		vkutil::ImageMemoryBarrier2(
-				wrapper._cmdBuf,
-				image._vkImage,
-				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT},
-				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT},
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
-
-		image._vkCurrentImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-		desc.handle_ = _gx._imm->submit(wrapper);
-		_regions.push_back(desc);
+		return _uploadImageBands(image, VK_IMAGE_ASPECT_COLOR_BIT, format, std::span<const ImageCopyRegion>(&copy, 1), data);
 	}
-	void VulkanStagingDevice::imageData2D(AllocatedImage& image,
+	UploadToken VulkanStagingDevice::imageData2D(AllocatedImage& image,
 										  const VkRect2D& imageRegion,
 										  uint32_t baseMipLevel,
 										  uint32_t numMipLevels,
@@ -156,6 +230,29 @@ namespace Slate {
 		ASSERT_MSG(!imageRegion.offset.x && !imageRegion.offset.y && imageRegion.extent.width == width && imageRegion.extent.height == height,
 				   "Uploading mip-levels with an image region that is smaller than the base mip level is not supported!");
 
+		if (vkutil::GetNumImagePlanes(image._vkFormat) == 1) {
+			// data is ordered mip by mip, every layer of a mip before the next one
+			std::vector<ImageCopyRegion> copies;
+			copies.reserve(numMipLevels * numLayers);
+			size_t dataOffset = 0;
+			for (uint32_t mipLevel = 0; mipLevel < numMipLevels; mipLevel++) {
+				const uint32_t currentMipLevel = baseMipLevel + mipLevel;
+				const uint32_t levelBytes = vkutil::GetTextureBytesPerLayer(imageRegion.extent.width, imageRegion.extent.height, format, currentMipLevel);
+				for (uint32_t layer = 0; layer != numLayers; layer++) {
+					copies.push_back({
+							.mipLevel = currentMipLevel,
+							.layer = layer,
+							.offset = {.x = imageRegion.offset.x >> mipLevel, .y = imageRegion.offset.y >> mipLevel, .z = 0},
+							.extent = {.width = std::max(1u, imageRegion.extent.width >> mipLevel), .height = std::max(1u, imageRegion.extent.height >> mipLevel), .depth = 1u},
+							.dataOffset = dataOffset,
+					});
+					dataOffset += levelBytes;
+				}
+			}
+			return _uploadImageBands(image, VK_IMAGE_ASPECT_COLOR_BIT, format, copies, data);
+		}
+		// multi-planar images are single video frames, they still go through in one piece
+
 		// find the storage size for all mip-levels being uploaded
 		uint32_t layerStorageSize = 0;
 		for (uint32_t i = 0; i < numMipLevels; ++i) {
@@ -166,22 +263,14 @@ namespace Slate {
 //			height = height <= 1 ? 1 : height >> 1;
 		}
 		const uint32_t storageSize = layerStorageSize * numLayers;
+		MemoryRegionDesc desc = _getContiguousRegion(storageSize);
 
-		ensureStagingBufferSize(storageSize);
-		ASSERT(storageSize <= _stagingBufferSize);
-		MemoryRegionDesc desc = getNextFreeOffset(storageSize);
-		// No support for copying image in multiple smaller chunk sizes. If we get smaller buffer size than storageSize, we will wait for GPU idle
-		// and get bigger chunk.
-		if (desc.size_ < storageSize) {
-			waitAndReset();
-			desc = getNextFreeOffset(storageSize);
-		}
-		ASSERT(desc.size_ >= storageSize);
-
-		const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _gx._imm->acquire();
+		const VulkanImmediateCommands::CommandBufferWrapper& wrapper = _copyCommands().acquire();
 
 		AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
 		stagingBuffer->bufferSubData(_gx, desc.offset_, storageSize, data);
+		std::vector<VkImageMemoryBarrier2> barriers;
+		barriers.reserve(numMipLevels * numLayers);
 
 		uint32_t offset = 0;
 		const uint32_t numPlanes = vkutil::GetNumImagePlanes(image._vkFormat);
@@ -245,102 +334,191 @@ namespace Slate {
 					planeOffset += vkutil::GetTextureBytesPerPlane(imageRegion.extent.width, imageRegion.extent.height, format, plane);
 				}
 
-				// 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL
-				vkutil::ImageMemoryBarrier2(
-						wrapper._cmdBuf,
-						image._vkImage,
-						vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_WRITE_BIT},
-						vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT},
-						VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-						VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-						VkImageSubresourceRange{imageAspect, currentMipLevel, 1, layer, 1});
+				// 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL, all of them go out together after the copies
+				barriers.push_back(CreateUploadedImageBarrier(image._vkImage, VkImageSubresourceRange{imageAspect, currentMipLevel, 1, layer, 1}));
 
 				offset += vkutil::GetTextureBytesPerLayer(imageRegion.extent.width, imageRegion.extent.height, format, currentMipLevel);
 			}
 		}
-		image._vkCurrentImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		image._setLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-		desc.handle_ = _gx._imm->submit(wrapper);
-		_regions.push_back(desc);
+		desc.handle_ = _submitCopy(wrapper, barriers, {});
+		_releaseRegion(desc, storageSize);
+		return { desc.handle_ };
 	}
 	void VulkanStagingDevice::getImageData(AllocatedImage& image, const VkOffset3D& offset, const VkExtent3D& extent, VkImageSubresourceRange range, VkFormat format, void* outData) {
 		ASSERT(image.getLayout() != VK_IMAGE_LAYOUT_UNDEFINED);
 		ASSERT(range.layerCount == 1);
 
-		const uint32_t storageSize = extent.width * extent.height * extent.depth * vkutil::GetBytesPerPixel(format);
-
-		ensureStagingBufferSize(storageSize);
-
-		ASSERT(storageSize <= _stagingBufferSize);
-
-		// get next staging buffer free offset
-		MemoryRegionDesc desc = getNextFreeOffset(storageSize);
-
-		// No support for copying image in multiple smaller chunk sizes.
-		// If we get smaller buffer size than storageSize, we will wait for GPU idle and get a bigger chunk.
-		if (desc.size_ < storageSize) {
-			waitAndReset();
-			desc = getNextFreeOffset(storageSize);
-		}
+		const uint32_t rowSize = extent.width * vkutil::GetBytesPerPixel(format);
+		size_t remaining = (size_t)rowSize * extent.height * extent.depth;
+		const VkImageLayout initialLayout = image.getLayout();
 
-		ASSERT(desc.size_ >= storageSize);
-
-		AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
-
-		const VulkanImmediateCommands::CommandBufferWrapper& wrapper1 = _gx._imm->acquire();
+		// readbacks stay on graphics which owns the image, every band is waited on and copied out before the next one
+		const VulkanImmediateCommands::CommandBufferWrapper* wrapper = &_gx._imm->acquire();
 
 		// 1. Transition to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
 		vkutil::ImageMemoryBarrier2(
-				wrapper1._cmdBuf,
+				wrapper->_cmdBuf,
 				image._vkImage,
 				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, .access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT},
 				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT},
-				image.getLayout(),
+				initialLayout,
 				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 				range);
 
-		// 2.  Copy the pixel data from the image into the staging buffer
-		const VkBufferImageCopy copy = {
-				.bufferOffset = desc.offset_,
-				.bufferRowLength = 0,
-				.bufferImageHeight = extent.height,
-				.imageSubresource =
-						VkImageSubresourceLayers{
-								.aspectMask = range.aspectMask,
-								.mipLevel = range.baseMipLevel,
-								.baseArrayLayer = range.baseArrayLayer,
-								.layerCount = range.layerCount,
-						},
-				.imageOffset = offset,
-				.imageExtent = extent,
-		};
-		vkCmdCopyImageToBuffer(wrapper1._cmdBuf, image._vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer->_vkBuffer, 1, &copy);
-
-		desc.handle_ = _gx._imm->submit(wrapper1);
-		_regions.push_back(desc);
-
-		waitAndReset();
+		uint8_t* dst = (uint8_t*)outData;
+		for (uint32_t slice = 0; slice < extent.depth; slice++) {
+			uint32_t row = 0;
+			while (row < extent.height) {
+				const MemoryRegionDesc desc = _getBandRegion(remaining, rowSize);
+				const uint32_t numBandRows = std::min(extent.height - row, desc.size_ / rowSize);
+				const uint32_t bandSize = numBandRows * rowSize;
+
+				// 2. Copy the pixel data from the image into the staging buffer
+				AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
+				const VkBufferImageCopy copy = {
+						.bufferOffset = desc.offset_,
+						.bufferRowLength = 0,
+						.bufferImageHeight = 0,
+						.imageSubresource =
+								VkImageSubresourceLayers{
+										.aspectMask = range.aspectMask,
+										.mipLevel = range.baseMipLevel,
+										.baseArrayLayer = range.baseArrayLayer,
+										.layerCount = range.layerCount,
+								},
+						.imageOffset = {.x = offset.x, .y = offset.y + (int32_t)row, .z = offset.z + (int32_t)slice},
+						.imageExtent = {.width = extent.width, .height = numBandRows, .depth = 1u},
+				};
+				vkCmdCopyImageToBuffer(wrapper->_cmdBuf, image._vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer->_vkBuffer, 1, &copy);
+				_gx._imm->wait(_gx._imm->submit(*wrapper));
+
+				// 3. Copy data from staging buffer into data
+				if (!stagingBuffer->_isCoherentMemory) {
+					stagingBuffer->invalidateMappedMemory(_gx, desc.offset_, bandSize);
+				}
+				memcpy(dst, stagingBuffer->getMappedPtr() + desc.offset_, bandSize);
+				_releaseRegion(desc, 0);
 
-		if (!stagingBuffer->_isCoherentMemory) {
-			stagingBuffer->invalidateMappedMemory(_gx, desc.offset_, desc.size_);
+				dst += bandSize;
+				remaining -= bandSize;
+				row += numBandRows;
+				wrapper = &_gx._imm->acquire();
+			}
 		}
 
-		// 3. Copy data from staging buffer into data
-		memcpy(outData, stagingBuffer->getMappedPtr() + desc.offset_, storageSize);
-
 		// 4. Transition back to the initial image layout
-		const VulkanImmediateCommands::CommandBufferWrapper& wrapper2 = _gx._imm->acquire();
-
 		vkutil::ImageMemoryBarrier2(
-				wrapper2._cmdBuf,
+				wrapper->_cmdBuf,
 				image._vkImage,
 				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .access = VK_ACCESS_2_TRANSFER_READ_BIT},
 				vkutil::StageAccess{.stage = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, .access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT},
 				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				image.getLayout(),
+				initialLayout,
 				range);
 
-		_gx._imm->wait(_gx._imm->submit(wrapper2));
+		_gx._imm->wait(_gx._imm->submit(*wrapper));
+	}
+
+	UploadToken VulkanStagingDevice::_uploadImageBands(AllocatedImage& image, VkImageAspectFlags aspect, VkFormat format, std::span<const ImageCopyRegion> copies, const void* data) {
+		const VkExtent2D block = vkutil::GetFormatBlockExtent(format);
+		size_t remaining = 0;
+		for (const ImageCopyRegion& copy : copies) {
+			remaining += (size_t)vkutil::GetTextureBytesPerLayer(copy.extent.width, copy.extent.height, format, 0) * copy.extent.depth;
+		}
+
+		const VulkanImmediateCommands::CommandBufferWrapper* wrapper = &_copyCommands().acquire();
+
+		// 1. Transition every subresource into TRANSFER_DST_OPTIMAL up front, they stay there across all the submits
+		std::vector<VkImageMemoryBarrier2> initialBarriers;
+		std::vector<VkImageMemoryBarrier2> finalBarriers;
+		initialBarriers.reserve(copies.size());
+		finalBarriers.reserve(copies.size());
+		for (const ImageCopyRegion& copy : copies) {
+			const VkImageSubresourceRange range = {aspect, copy.mipLevel, 1, copy.layer, 1};
+			initialBarriers.push_back({
+					.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+					.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+					.srcAccessMask = VK_ACCESS_2_NONE,
+					.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+					.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+					.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.image = image._vkImage,
+					.subresourceRange = range
+			});
+			finalBarriers.push_back(CreateUploadedImageBarrier(image._vkImage, range));
+		}
+		RecordBarriers(wrapper->_cmdBuf, initialBarriers, {});
+
+		// 2. Copy band after band, a full region is submitted and the next band starts in a fresh one
+		MemoryRegionDesc desc = {};
+		uint32_t usedSize = 0;
+		bool hasRegion = false;
+		for (const ImageCopyRegion& copy : copies) {
+			const uint32_t rowSize = vkutil::GetTextureBytesPerLayer(copy.extent.width, block.height, format, 0);
+			const uint32_t numRows = (copy.extent.height + block.height - 1) / block.height;
+			const uint8_t* src = (const uint8_t*)data + copy.dataOffset;
+			for (uint32_t slice = 0; slice < copy.extent.depth; slice++) {
+				uint32_t row = 0;
+				while (row < numRows) {
+					if (!hasRegion || desc.size_ - usedSize < rowSize) {
+						if (hasRegion) {
+							// the first band already overwrites the image, it has to start after graphics stopped reading it
+							_waitForGraphics();
+							desc.handle_ = _copyCommands().submit(*wrapper);
+							_releaseRegion(desc, usedSize);
+							wrapper = &_copyCommands().acquire();
+						}
+						desc = _getBandRegion(remaining, rowSize);
+						usedSize = 0;
+						hasRegion = true;
+					}
+					const uint32_t numBandRows = std::min(numRows - row, (desc.size_ - usedSize) / rowSize);
+					const uint32_t bandSize = numBandRows * rowSize;
+					const uint32_t y = row * block.height;
+
+					AllocatedBuffer* stagingBuffer = _gx._bufferPool.get(_stagingBuffer);
+					stagingBuffer->bufferSubData(_gx, desc.offset_ + usedSize, bandSize, src);
+					const VkBufferImageCopy region = {
+							.bufferOffset = desc.offset_ + usedSize,
+							.bufferRowLength = 0,
+							.bufferImageHeight = 0,
+							.imageSubresource = VkImageSubresourceLayers{aspect, copy.mipLevel, copy.layer, 1},
+							.imageOffset = {.x = copy.offset.x, .y = copy.offset.y + (int32_t)y, .z = copy.offset.z + (int32_t)slice},
+							// the last band of a compressed image ends on the image edge rather than a block edge
+							.imageExtent = {.width = copy.extent.width, .height = std::min(numBandRows * block.height, copy.extent.height - y), .depth = 1u},
+					};
+					vkCmdCopyBufferToImage(wrapper->_cmdBuf, stagingBuffer->_vkBuffer, image._vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+					// transfer-only queues want buffer offsets aligned to 4, keep every band on the staging alignment
+					usedSize = std::min(vkutil::GetAlignedSize(usedSize + bandSize, kStagingBufferAlignment), desc.size_);
+					src += bandSize;
+					remaining -= bandSize;
+					row += numBandRows;
+				}
+			}
+		}
+
+		// 3. Transition TRANSFER_DST_OPTIMAL into SHADER_READ_ONLY_OPTIMAL, once every band landed
+		image._setLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		desc.handle_ = _submitCopy(*wrapper, finalBarriers, {});
+		if (hasRegion) {
+			_releaseRegion(desc, usedSize);
+		}
+		return { desc.handle_ };
+	}
+	VulkanStagingDevice::MemoryRegionDesc VulkanStagingDevice::_getBandRegion(size_t remaining, uint32_t minSize) {
+		MemoryRegionDesc desc = getNextFreeOffset((uint32_t)std::min<size_t>(remaining, _maxBufferSize));
+		if (desc.size_ < minSize) {
+			_releaseRegion(desc, 0);
+			desc = _getContiguousRegion(minSize);
+		}
+		return desc;
 	}
 
 	void VulkanStagingDevice::ensureStagingBufferSize(uint32_t sizeNeeded) {
@@ -375,79 +553,85 @@ namespace Slate {
 
 		ASSERT(!_stagingBuffer.empty());
 
-		_regions.clear();
-		_regions.push_back({0, _stagingBufferSize, SubmitHandle()});
+		_inFlight.clear();
+		_head = 0;
 	}
 	VulkanStagingDevice::MemoryRegionDesc VulkanStagingDevice::getNextFreeOffset(uint32_t size) {
 		const uint32_t requestedAlignedSize = vkutil::GetAlignedSize(size, kStagingBufferAlignment);
 		ensureStagingBufferSize(requestedAlignedSize);
-
-		ASSERT(!_regions.empty());
-
-		// if we can't find an available region that is big enough to store requestedAlignedSize, return whatever we could find, which will be
-		// stored in bestNextIt
-		auto bestNextIt = _regions.begin();
-
-		for (auto it = _regions.begin(); it != _regions.end(); ++it) {
-			if (_gx._imm->isReady(it->handle_)) {
-				// This region is free, but is it big enough?
-				if (it->size_ >= requestedAlignedSize) {
-					// It is big enough!
-					const uint32_t unusedSize = it->size_ - requestedAlignedSize;
-					const uint32_t unusedOffset = it->offset_ + requestedAlignedSize;
-
-					// Prepare return value
-					const auto result = MemoryRegionDesc{it->offset_, requestedAlignedSize, SubmitHandle()};
-
-					// Perform the cleanup that was in SCOPE_EXIT
-					_regions.erase(it);
-					if (unusedSize > 0) {
-						_regions.insert(_regions.begin(), {unusedOffset, unusedSize, SubmitHandle()});
-					}
-
-					return result;
-				}
-
-				// Cache the largest available region that isn't as big as the one we're looking for
-				if (it->size_ > bestNextIt->size_) {
-					bestNextIt = it;
-				}
+		return _allocateRegion(std::min(requestedAlignedSize, _stagingBufferSize), true);
+	}
+	VulkanStagingDevice::MemoryRegionDesc VulkanStagingDevice::_getContiguousRegion(uint32_t size) {
+		const uint32_t requestedAlignedSize = vkutil::GetAlignedSize(size, kStagingBufferAlignment);
+		ensureStagingBufferSize(requestedAlignedSize);
+		ASSERT_MSG(requestedAlignedSize <= _stagingBufferSize, "Upload of {} bytes does not fit the {} byte staging buffer!", requestedAlignedSize, _stagingBufferSize);
+		return _allocateRegion(requestedAlignedSize, false);
+	}
+	VulkanStagingDevice::MemoryRegionDesc VulkanStagingDevice::_allocateRegion(uint32_t alignedSize, bool allowSmaller) {
+		ASSERT_MSG(!_hasOpenRegion, "Release the last staging region before taking the next one!");
+		while (true) {
+			_retireRegions();
+			if (_inFlight.empty()) {
+				// nothing in flight, start over from the front so the whole buffer is contiguous again
+				_head = 0;
+				return _takeRegion(alignedSize);
+			}
+			// the ring runs from the oldest region in flight up to the head, free space is whatever is outside of that
+			const uint32_t tail = _inFlight.front().offset_;
+			const uint32_t endSpace = _head > tail ? _stagingBufferSize - _head : (_head < tail ? tail - _head : 0);
+			const uint32_t wrapSpace = _head > tail ? tail : 0;
+			if (endSpace >= alignedSize) {
+				return _takeRegion(alignedSize);
+			}
+			if (wrapSpace >= alignedSize || (allowSmaller && wrapSpace > endSpace)) {
+				// the bytes left at the end go to the newest region, they free up together with it
+				_inFlight.back().size_ += _stagingBufferSize - _head;
+				_head = 0;
+				return _takeRegion(std::min(alignedSize, wrapSpace));
 			}
+			if (allowSmaller && endSpace > 0) {
+				return _takeRegion(endSpace);
+			}
+			// the ring really is full, wait for the oldest region and try again
+			_numStalls++;
+			_copyCommands().wait(_inFlight.front().handle_);
 		}
-		// we found a region that is available that is smaller than the requested size. It's the best we can do
-		// we found a region that is available that is smaller than the requested size. It's the best we can do
-		if (bestNextIt != _regions.end() && _gx._imm->isReady(bestNextIt->handle_)) {
-			const auto result = MemoryRegionDesc{bestNextIt->offset_, bestNextIt->size_, SubmitHandle()};
-			// Perform the cleanup that was in SCOPE_EXIT
-			_regions.erase(bestNextIt);
-			return result;
+	}
+	VulkanStagingDevice::MemoryRegionDesc VulkanStagingDevice::_takeRegion(uint32_t size) {
+		ASSERT(_head + size <= _stagingBufferSize);
+		const MemoryRegionDesc desc = {_head, size, SubmitHandle()};
+		_head += size;
+		_hasOpenRegion = true;
+		return desc;
+	}
+	void VulkanStagingDevice::_releaseRegion(const MemoryRegionDesc& desc, uint32_t usedSize) {
+		// only the region taken last is open, so its unused back is always right in front of the head
+		ASSERT(_hasOpenRegion && desc.offset_ + desc.size_ == _head);
+		_hasOpenRegion = false;
+		usedSize = std::min(vkutil::GetAlignedSize(usedSize, kStagingBufferAlignment), desc.size_);
+		_head = desc.offset_ + usedSize;
+		if (usedSize > 0) {
+			_inFlight.push_back({desc.offset_, usedSize, desc.handle_});
 		}
-		// nothing was available. Let's wait for the entire staging buffer to become free
-		waitAndReset();
-
-		// waitAndReset() adds a region that spans the entire buffer. Since we'll be using part of it, we need to replace it with a used block and
-		// an unused portion
-		_regions.clear();
-		// store the unused size in the deque first...
-		const uint32_t unusedSize = _stagingBufferSize > requestedAlignedSize ? _stagingBufferSize - requestedAlignedSize : 0;
-
-		if (unusedSize) {
-			const uint32_t unusedOffset = _stagingBufferSize - unusedSize;
-			_regions.insert(_regions.begin(), {unusedOffset, unusedSize, SubmitHandle()});
+	}
+	void VulkanStagingDevice::_retireRegions() {
+		// regions are in submission order on one queue, the first one still running means everything after it is too
+		while (!_inFlight.empty() && _copyCommands().isReady(_inFlight.front().handle_)) {
+			_inFlight.pop_front();
 		}
-		// ...and then return the smallest free region that can hold the requested size
-		return {
-				.offset_ = 0,
-				.size_ = _stagingBufferSize - unusedSize,
-				.handle_ = SubmitHandle(),
-		};
 	}
 	void VulkanStagingDevice::waitAndReset() {
-		for (const MemoryRegionDesc& r : _regions) {
-			_gx._imm->wait(r.handle_);
+		ASSERT(!_hasOpenRegion);
+		// submits on one queue retire in order, the newest one finishing covers the rest
+		for (auto it = _inFlight.rbegin(); it != _inFlight.rend(); ++it) {
+			// waiting on an empty handle would idle the whole device
+			if (!it->handle_.empty()) {
+				_copyCommands().wait(it->handle_);
+				break;
+			}
 		}
-		_regions.clear();
-		_regions.push_back({0, _stagingBufferSize, SubmitHandle()});
+		_inFlight.clear();
+		_head = 0;
 	}
 
 }
\ No newline at end of file
@@ -24,7 +24,10 @@ namespace Slate {
 	}
 
 	VulkanSwapchain::VulkanSwapchain(GX& gx, uint16_t width, uint16_t height) : _gxCtx(gx) {
-		ASSERT(_gxCtx._backend.getSurface());
+		if (_gxCtx._backend.getSurface() == VK_NULL_HANDLE) {
+			_createHeadless(width, height);
+			return;
+		}
 		// PRIMARY SWAPCHAIN DATA CREATION //
 		{
 			vkb::SwapchainBuilder swapchainBuilder{gx._backend.getPhysicalDevice(), gx._backend.getDevice(), gx._backend.getSurface()};
@@ -80,6 +83,7 @@ namespace Slate {
 				image._vkFormat = _vkImageFormat;
 				snprintf(image._debugName, sizeof(image._debugName), "Swapchain Image %d", i);
 				this->_swapchainTextures[i] = _gxCtx._texturePool.create(std::move(image));
+				_gxCtx._textureSlots.markDirty(_swapchainTextures[i].index());
 			}
 		}
 		// SECONDARY DATA CREATION //
@@ -91,6 +95,28 @@ namespace Slate {
 		}
 	}
 
+	void VulkanSwapchain::_createHeadless(uint16_t width, uint16_t height) {
+		ASSERT_MSG(width > 0 && height > 0, "Headless swapchain needs an extent!");
+		_isHeadless = true;
+		_vkExtent2D = { width, height };
+		_vkImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+		_numSwapchainImages = kNUM_HEADLESS_IMAGES;
+		for (uint32_t i = 0; i < _numSwapchainImages; i++) {
+			char debugName[32];
+			snprintf(debugName, sizeof(debugName), "Headless Swapchain Image %u", i);
+			_swapchainTextures[i] = _gxCtx.createTexture({
+					.dimension = _vkExtent2D,
+					.usage = TextureUsageBits::TextureUsageBits_Attachment | TextureUsageBits::TextureUsageBits_Sampled,
+					.storage = StorageType::Device,
+					.format = _vkImageFormat,
+					.debugName = debugName
+			});
+			// owned by us unlike real swapchain images, but everything else has to treat them the same
+			_gxCtx._texturePool.get(_swapchainTextures[i])->_isSwapchainImage = true;
+		}
+		// nothing to acquire, images are only reused once the timeline says the frame that drew into them finished
+	}
+
 	VulkanSwapchain::~VulkanSwapchain() {
 		// DESTROY MAIN SWAPCHAIN DATA //
 		{
@@ -98,7 +124,9 @@ namespace Slate {
 				_gxCtx.destroy(_swapchainTextures[i]);
 			}
 			// images are destroyed alongside swapchain destruction
-			vkDestroySwapchainKHR(_gxCtx._backend.getDevice(), _vkSwapchain, nullptr);
+			if (!_isHeadless) {
+				vkDestroySwapchainKHR(_gxCtx._backend.getDevice(), _vkSwapchain, nullptr);
+			}
 		}
 		// DESTROY SECONDARY DATA //
 		{
@@ -118,13 +146,16 @@ namespace Slate {
 			};
 			ASSERT_MSG(_currentImageIndex < (sizeof(_timelineWaitValues)/sizeof(_timelineWaitValues[0])), "Image index out of range");
 			VK_CHECK(vkWaitSemaphores(_gxCtx._backend.getDevice(), &waitInfo, UINT64_MAX));
-			VkSemaphore acquireSemaphore = _vkAcquireSemaphores[_currentImageIndex];
-			VkResult r = vkAcquireNextImageKHR(_gxCtx._backend.getDevice(), _vkSwapchain, UINT64_MAX, acquireSemaphore, nullptr, &_currentImageIndex);
-			if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
-				ASSERT(r);
+			// headless images are handed out in order, present already moved on to the next one
+			if (!_isHeadless) {
+				VkSemaphore acquireSemaphore = _vkAcquireSemaphores[_currentImageIndex];
+				VkResult r = vkAcquireNextImageKHR(_gxCtx._backend.getDevice(), _vkSwapchain, UINT64_MAX, acquireSemaphore, nullptr, &_currentImageIndex);
+				if (r != VK_SUCCESS && r != VK_SUBOPTIMAL_KHR && r != VK_ERROR_OUT_OF_DATE_KHR) {
+					ASSERT(r);
+				}
+				_gxCtx._imm->waitSemaphore(acquireSemaphore);
 			}
 			_getNextImage = false;
-			_gxCtx._imm->waitSemaphore(acquireSemaphore);
 		}
 
 		if (_currentImageIndex < _numSwapchainImages) {
@@ -134,6 +165,13 @@ namespace Slate {
 	}
 
 	void VulkanSwapchain::present() {
+		if (_isHeadless) {
+			ASSERT_MSG(_vkCurrentImageLayout == getPresentLayout(), "Headless swapchain image layout is not VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL!");
+			_currentImageIndex = (_currentImageIndex + 1) % _numSwapchainImages;
+			_getNextImage = true;
+			_currentFrameNum++;
+			return;
+		}
 		ASSERT_MSG(_vkCurrentImageLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, "Swapchain image layout is not VK_IMAGE_LAYOUT_PRESENT_SRC_KHR!");
 		VkSemaphore semaphore = _gxCtx._imm->acquireLastSubmitSemaphore();
 
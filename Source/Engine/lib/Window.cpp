@@ -39,7 +39,10 @@ namespace Slate {
 	}
 	void Window::destroy() {
 		this->spec = {};
+		// never created when the app runs headless, glfw is not even initialized then
+		if (!this->glfwWindow) return;
 		glfwDestroyWindow(this->glfwWindow);
+		this->glfwWindow = nullptr;
 	}
 
 	void Window::setWindowMode(VideoMode new_videomode) {
@@ -81,6 +81,11 @@ namespace Slate::vkutil {
 		uint32_t heightInBlocks = (levelHeight + blockHeight - 1) / blockHeight;
 		return widthInBlocks * heightInBlocks * props->bytesPerBlock;
 	}
+	VkExtent2D GetFormatBlockExtent(VkFormat format) {
+		const TextureFormatProperties* props = GetFormatProperties(format);
+		ASSERT_MSG(props, "Unknown texture format!");
+		return { std::max<uint32_t>(props->blockWidth, 1), std::max<uint32_t>(props->blockHeight, 1) };
+	}
 	uint32_t GetTextureBytesPerPlane(uint32_t width, uint32_t height, VkFormat format, uint32_t plane) {
 		const TextureFormatProperties* props = GetFormatProperties(format);
 		ASSERT(plane < props->numPlanes);
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "Slate/ECS/Entity.h"
+#include "Slate/ECS/Scene.h"
+
+#include <algorithm>
+
+namespace Slate {
+	static bool ContainsEntity(const std::vector<GameEntity>& entities, GameEntity entity) {
+		return std::find(entities.begin(), entities.end(), entity) != entities.end();
+	}
+
+	TEST(GameEntity, AddChildParentsTheChild) {
+		Scene scene;
+		GameEntity parent = scene.createEntity("Parent");
+		GameEntity child = scene.createEntity("Child");
+		parent.addChild(child);
+
+		EXPECT_TRUE(child.hasParent());
+		EXPECT_EQ(child.getParent(), parent);
+		EXPECT_FALSE(parent.hasParent());
+		ASSERT_EQ(parent.getChildren().size(), 1u);
+		EXPECT_EQ(parent.getChildren()[0], child);
+	}
+	TEST(GameEntity, GetRootWalksUpTheHierarchy) {
+		Scene scene;
+		GameEntity root = scene.createEntity("Root");
+		GameEntity middle = scene.createEntity("Middle");
+		GameEntity leaf = scene.createEntity("Leaf");
+		root.addChild(middle);
+		middle.addChild(leaf);
+
+		EXPECT_EQ(leaf.getRoot(), root);
+		EXPECT_EQ(middle.getRoot(), root);
+		EXPECT_EQ(root.getRoot(), root);
+	}
+	TEST(GameEntity, RemoveChildUnparentsTheChild) {
+		Scene scene;
+		GameEntity root = scene.createEntity("Root");
+		GameEntity parent = scene.createEntity("Parent");
+		GameEntity child = scene.createEntity("Child");
+		root.addChild(parent);
+		parent.addChild(child);
+		parent.removeChild(child);
+
+		EXPECT_FALSE(child.hasParent());
+		EXPECT_FALSE(parent.hasChildren());
+		// the parent keeps its own place in the hierarchy
+		EXPECT_EQ(parent.getParent(), root);
+	}
+	TEST(Scene, RootEntitiesIncludeParents) {
+		Scene scene;
+		GameEntity parent = scene.createEntity("Parent");
+		GameEntity child = scene.createEntity("Child");
+		GameEntity loner = scene.createEntity("Loner");
+		parent.addChild(child);
+
+		const std::vector<GameEntity> roots = scene.GetRootEntities();
+		EXPECT_TRUE(ContainsEntity(roots, parent));
+		EXPECT_TRUE(ContainsEntity(roots, loner));
+		EXPECT_FALSE(ContainsEntity(roots, child));
+	}
+}
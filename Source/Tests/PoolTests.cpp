@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "Slate/Common/FastSTD.h"
+#include "Slate/ResourcePool.h"
+#include "Slate/Resources/IResource.h"
+
+#include <fstream>
+
+namespace Slate {
+	struct TestObject {
+		uint32_t value = 0;
+	};
+	// resources normally load a file, this one only needs the path to exist
+	struct TestResource : public IResource {
+		uint32_t value = 0;
+	private:
+		Result _loadResourceImpl(const std::filesystem::path& path) override { return Result::SUCCESS; }
+	};
+	static const std::filesystem::path& TestResourcePath() {
+		static const std::filesystem::path path = [] {
+			std::filesystem::path temp = std::filesystem::temp_directory_path() / "slate_test_resource";
+			std::ofstream(temp) << "slate";
+			return temp;
+		}();
+		return path;
+	}
+
+	TEST(FastHandlePool, DestroyInvalidatesTheHandle) {
+		FastHandlePool<TestObject, 16> pool;
+		auto handle = pool.create({ .value = 7 });
+		ASSERT_NE(pool.get(handle), nullptr);
+		EXPECT_EQ(pool.get(handle)->value, 7u);
+
+		pool.destroy(handle);
+		EXPECT_EQ(pool.get(handle), nullptr);
+		EXPECT_EQ(pool.getNumActiveSlots(), 0u);
+	}
+	TEST(FastHandlePool, CreateReusesDestroyedSlots) {
+		FastHandlePool<TestObject, 16> pool;
+		auto first = pool.create({ .value = 1 });
+		auto second = pool.create({ .value = 2 });
+		pool.destroy(first);
+		pool.destroy(second);
+
+		// freed slots come back most recent first, with a new generation
+		auto third = pool.create({ .value = 3 });
+		auto fourth = pool.create({ .value = 4 });
+		EXPECT_EQ(third.index(), second.index());
+		EXPECT_EQ(fourth.index(), first.index());
+		EXPECT_NE(third.gen(), second.gen());
+		EXPECT_EQ(pool.get(second), nullptr);
+		EXPECT_EQ(pool.get(third)->value, 3u);
+		EXPECT_EQ(pool.get(fourth)->value, 4u);
+		EXPECT_EQ(pool.getNumAllocatedSlots(), 2u);
+		EXPECT_EQ(pool.getNumActiveSlots(), 2u);
+	}
+
+	TEST(ResourcePool, DestroyInvalidatesTheHandle) {
+		ResourcePool<TestResource> pool;
+		ResourceHandle<TestResource> handle = pool.create(TestResourcePath());
+		ASSERT_NE(pool.get(handle), nullptr);
+
+		pool.destroy(handle);
+		EXPECT_EQ(pool.get(handle), nullptr);
+		EXPECT_EQ(pool.getNumActiveSlots(), 0u);
+	}
+	TEST(ResourcePool, CreateReusesDestroyedSlots) {
+		ResourcePool<TestResource> pool;
+		ResourceHandle<TestResource> first = pool.create(TestResourcePath());
+		ResourceHandle<TestResource> second = pool.create(TestResourcePath());
+		pool.destroy(first);
+		pool.destroy(second);
+
+		ResourceHandle<TestResource> third = pool.create(TestResourcePath());
+		ResourceHandle<TestResource> fourth = pool.create(TestResourcePath());
+		EXPECT_EQ(third.index(), second.index());
+		EXPECT_EQ(fourth.index(), first.index());
+		EXPECT_NE(third.gen(), second.gen());
+		EXPECT_EQ(pool.get(second), nullptr);
+		EXPECT_NE(pool.get(fourth), nullptr);
+		EXPECT_EQ(pool.getNumAllocatedSlots(), 2u);
+		EXPECT_EQ(pool.getNumActiveSlots(), 2u);
+	}
+}